@@ -0,0 +1,148 @@
+/* embeddable binding generator interface
+ *
+ * This file is part of nsgenbind.
+ * Licensed under the MIT License,
+ *                http://www.opensource.org/licenses/mit-license.php
+ * Copyright 2026 agent <agent@local>
+ */
+
+#ifndef nsgenbind_nsgenbind_h
+#define nsgenbind_nsgenbind_h
+
+#include <stdbool.h>
+
+/**
+ * warnings which may be enabled in the configuration
+ */
+enum nsgenbind_warning {
+        NSGENBIND_WARNING_UNIMPLEMENTED = 1,
+        NSGENBIND_WARNING_DUPLICATED = 2,
+        NSGENBIND_WARNING_WEBIDL = 4,
+        NSGENBIND_WARNING_GENERATED = 8,
+};
+
+/** warnings enabled by default when warnings are requested */
+#define NSGENBIND_WARNING_ALL (NSGENBIND_WARNING_UNIMPLEMENTED | \
+                               NSGENBIND_WARNING_DUPLICATED |    \
+                               NSGENBIND_WARNING_WEBIDL)
+
+/**
+ * kind of file read while generating bindings
+ */
+enum nsgenbind_input_type {
+        NSGENBIND_INPUT_BINDING, /**< binding source or included file */
+        NSGENBIND_INPUT_IDL, /**< Web IDL file */
+};
+
+/**
+ * generator configuration
+ *
+ * Strings are copied when the context is created.
+ */
+struct nsgenbind_config {
+        const char *idlpath; /**< path to IDL files or NULL */
+        const char *depfilename; /**< dependency file to write or NULL */
+        const char *cachedir; /**< parsed IDL cache directory or NULL */
+        const char *statsfilename; /**< statistics file or NULL for stderr */
+
+        bool verbose; /**< verbose processing */
+        bool debug; /**< debug enabled */
+        bool dbglog; /**< embed debug logging in output */
+        bool dryrun; /**< output is not generated */
+        bool stats; /**< report processing statistics */
+        bool watch; /**< inputs are recorded for watching */
+        bool write_ir; /**< intermediate representation is saved with output */
+        bool read_ir; /**< inputs are saved intermediate representations */
+        bool prototype_tables; /**< prototypes are populated from tables */
+        bool lazy_prototypes; /**< prototypes are created on first use */
+        bool private_literal; /**< private pointers use a literal key */
+        bool prototype_handles; /**< prototypes are cached as heap pointers */
+        bool class_ids; /**< instances are identified by class identifier */
+
+        unsigned int jobs; /**< concurrent parse and output jobs, 0 for serial */
+
+        unsigned int warnings; /**< enabled nsgenbind_warning flags */
+};
+
+/**
+ * binding source and the directory its output is generated in
+ */
+struct nsgenbind_binding {
+        const char *infilename; /**< binding source */
+        const char *outdirname; /**< output directory */
+};
+
+/**
+ * opaque generator context
+ */
+struct nsgenbind_ctx;
+
+/**
+ * create a generator context
+ *
+ * Each context holds its own syntax trees, interned strings and
+ * recorded inputs so several contexts may be used at once, each from
+ * one thread at a time.
+ *
+ * \param config The configuration to use.
+ * \param ctx_out Updated with the new context.
+ * \return 0 on success else -1 and an error message is printed.
+ */
+int nsgenbind_create(const struct nsgenbind_config *config,
+                     struct nsgenbind_ctx **ctx_out);
+
+/**
+ * generate bindings
+ *
+ * Each distinct binding source is parsed once, the Web IDL it requires
+ * loaded and an intermediate representation built and output for every
+ * directory it is paired with.
+ *
+ * Web IDL loaded by a previous call is reused unless the context has
+ * been reset. The context is reset first if the strings interned for
+ * bindings since the Web IDL was loaded have grown by more than half.
+ *
+ * \param ctx The generator context.
+ * \param bindingc The number of bindings.
+ * \param bindingv The bindings to generate.
+ * \return 0 on success else the exit code nsgenbind would return.
+ */
+int nsgenbind_generate(struct nsgenbind_ctx *ctx,
+                       unsigned int bindingc,
+                       const struct nsgenbind_binding *bindingv);
+
+/**
+ * call a function for every file read by the last generation
+ *
+ * Inputs are only recorded when the configuration requests a dependency
+ * file or watching.
+ *
+ * \param ctx The generator context.
+ * \param cb The function to call with each file name and type.
+ * \param pw Private data passed to the function.
+ * \return 0 on success else the first non zero value from the function.
+ */
+int nsgenbind_foreach_input(struct nsgenbind_ctx *ctx,
+                            int (*cb)(const char *fname,
+                                      enum nsgenbind_input_type type,
+                                      void *pw),
+                            void *pw);
+
+/**
+ * release everything loaded by previous generation
+ *
+ * The next generation loads all its inputs again which is required when
+ * a Web IDL file has changed.
+ *
+ * \param ctx The generator context.
+ */
+void nsgenbind_reset(struct nsgenbind_ctx *ctx);
+
+/**
+ * destroy a generator context
+ *
+ * \param ctx The generator context.
+ */
+void nsgenbind_destroy(struct nsgenbind_ctx *ctx);
+
+#endif
@@ -0,0 +1,208 @@
+/* arena memory allocator implementation
+ *
+ * This file is part of nsgenbind.
+ * Licensed under the MIT License,
+ *                http://www.opensource.org/licenses/mit-license.php
+ * Copyright 2026 agent <agent@local>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "arena.h"
+
+/** default size of arena blocks */
+#define ARENA_BLOCK_SIZE (64 * 1024)
+
+/** alignment of allocations */
+#define ARENA_ALIGN (2 * sizeof(void *))
+
+/**
+ * block of memory allocations are made from
+ */
+struct arena_block {
+        struct arena_block *next; /**< previously allocated block */
+        size_t size; /**< size of data area */
+        size_t used; /**< amount of data area used */
+        /** data area */
+        union {
+                void *p;
+                double d;
+                long l;
+        } data[];
+};
+
+struct arena {
+        struct arena_block *blocks; /**< current block followed by older ones */
+        size_t blocksize; /**< size of new blocks */
+        struct arena_stats stats; /**< usage statistics */
+};
+
+/**
+ * add a new block to an arena
+ *
+ * \param arena The arena to extend.
+ * \param size The minimum data area size required.
+ * \return The new block or NULL on allocation failure.
+ */
+static struct arena_block *arena_add_block(struct arena *arena, size_t size)
+{
+        struct arena_block *block;
+
+        if (size < arena->blocksize) {
+                size = arena->blocksize;
+        }
+
+        block = malloc(sizeof(struct arena_block) + size);
+        if (block == NULL) {
+                return NULL;
+        }
+        block->size = size;
+        block->used = 0;
+
+        if ((arena->blocks != NULL) &&
+            (size > arena->blocksize)) {
+                /* oversize block, keep allocating from the current one */
+                block->next = arena->blocks->next;
+                arena->blocks->next = block;
+        } else {
+                block->next = arena->blocks;
+                arena->blocks = block;
+        }
+
+        arena->stats.blockc++;
+        arena->stats.allocated += size;
+
+        return block;
+}
+
+/* exported interface documented in arena.h */
+struct arena *arena_new(size_t blocksize)
+{
+        struct arena *arena;
+
+        arena = calloc(1, sizeof(struct arena));
+        if (arena == NULL) {
+                return NULL;
+        }
+
+        if (blocksize == 0) {
+                blocksize = ARENA_BLOCK_SIZE;
+        }
+        arena->blocksize = blocksize;
+
+        return arena;
+}
+
+/* exported interface documented in arena.h */
+void arena_free(struct arena *arena)
+{
+        struct arena_block *block;
+        struct arena_block *next;
+
+        if (arena == NULL) {
+                return;
+        }
+
+        for (block = arena->blocks; block != NULL; block = next) {
+                next = block->next;
+                free(block);
+        }
+        free(arena);
+}
+
+/* exported interface documented in arena.h */
+void *arena_alloc(struct arena *arena, size_t size)
+{
+        struct arena_block *block;
+        void *res;
+
+        /* round up to keep following allocations aligned */
+        size = (size + (ARENA_ALIGN - 1)) & ~(ARENA_ALIGN - 1);
+
+        block = arena->blocks;
+        if ((block == NULL) || ((block->size - block->used) < size)) {
+                block = arena_add_block(arena, size);
+                if (block == NULL) {
+                        return NULL;
+                }
+        }
+
+        res = ((char *)block->data) + block->used;
+        block->used += size;
+        arena->stats.used += size;
+
+        memset(res, 0, size);
+
+        return res;
+}
+
+/* exported interface documented in arena.h */
+char *arena_strndup(struct arena *arena, const char *s, size_t n)
+{
+        size_t len;
+        char *res;
+
+        for (len = 0; (len < n) && (s[len] != 0); len++) {
+                continue;
+        }
+
+        res = arena_alloc(arena, len + 1);
+        if (res != NULL) {
+                memcpy(res, s, len);
+        }
+        return res;
+}
+
+/* exported interface documented in arena.h */
+char *arena_strdup(struct arena *arena, const char *s)
+{
+        size_t len;
+        char *res;
+
+        len = strlen(s) + 1;
+        res = arena_alloc(arena, len);
+        if (res != NULL) {
+                memcpy(res, s, len);
+        }
+        return res;
+}
+
+/* exported interface documented in arena.h */
+void arena_merge(struct arena *arena, struct arena *src)
+{
+        struct arena_block *last;
+
+        if (src == NULL) {
+                return;
+        }
+
+        if (src->blocks != NULL) {
+                if (arena->blocks == NULL) {
+                        arena->blocks = src->blocks;
+                } else {
+                        /* keep allocating from the current block */
+                        for (last = src->blocks;
+                             last->next != NULL;
+                             last = last->next) {
+                                continue;
+                        }
+                        last->next = arena->blocks->next;
+                        arena->blocks->next = src->blocks;
+                }
+        }
+
+        arena->stats.blockc += src->stats.blockc;
+        arena->stats.allocated += src->stats.allocated;
+        arena->stats.used += src->stats.used;
+
+        free(src);
+}
+
+/* exported interface documented in arena.h */
+void arena_get_stats(struct arena *arena, struct arena_stats *stats)
+{
+        *stats = arena->stats;
+}
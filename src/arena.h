@@ -0,0 +1,77 @@
+/* arena memory allocator
+ *
+ * This file is part of nsgenbind.
+ * Licensed under the MIT License,
+ *                http://www.opensource.org/licenses/mit-license.php
+ * Copyright 2026 agent <agent@local>
+ */
+
+#ifndef nsgenbind_arena_h
+#define nsgenbind_arena_h
+
+/**
+ * arena allocator
+ *
+ * Memory is handed out from large blocks by advancing a pointer. Individual
+ * allocations cannot be released, the whole arena is freed at once.
+ */
+struct arena;
+
+/**
+ * arena usage statistics
+ */
+struct arena_stats {
+        unsigned int blockc; /**< number of blocks allocated */
+        size_t allocated; /**< total size of all blocks */
+        size_t used; /**< bytes handed out from the blocks */
+};
+
+/**
+ * create a new arena
+ *
+ * \param blocksize The size of each block or 0 for the default.
+ * \return The new arena or NULL on allocation failure.
+ */
+struct arena *arena_new(size_t blocksize);
+
+/**
+ * free an arena and all memory allocated from it
+ */
+void arena_free(struct arena *arena);
+
+/**
+ * allocate zeroed memory from an arena
+ *
+ * \param arena The arena to allocate from.
+ * \param size The size of the allocation.
+ * \return The allocated memory or NULL on allocation failure.
+ */
+void *arena_alloc(struct arena *arena, size_t size);
+
+/**
+ * duplicate a string into an arena
+ */
+char *arena_strdup(struct arena *arena, const char *s);
+
+/**
+ * duplicate at most n characters of a string into an arena
+ */
+char *arena_strndup(struct arena *arena, const char *s, size_t n);
+
+/**
+ * move every allocation of one arena into another
+ *
+ * The allocations remain valid until the destination arena is freed
+ * and the source arena is released.
+ *
+ * \param arena The arena to move the allocations into.
+ * \param src The arena to move the allocations from.
+ */
+void arena_merge(struct arena *arena, struct arena *src);
+
+/**
+ * get the usage statistics of an arena
+ */
+void arena_get_stats(struct arena *arena, struct arena_stats *stats);
+
+#endif
@@ -0,0 +1,75 @@
+/* generator context implementation
+ *
+ * This file is part of nsgenbind.
+ * Licensed under the MIT License,
+ *                http://www.opensource.org/licenses/mit-license.php
+ * Copyright 2026 agent <agent@local>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "context.h"
+
+__thread struct genb_context *genb_context;
+
+__thread struct options *options;
+
+/* exported interface documented in context.h */
+int genb_context_init(struct genb_context *ctx)
+{
+        memset(ctx, 0, sizeof(struct genb_context));
+
+        if (intern_init(&ctx->intern) != 0) {
+                return -1;
+        }
+        if (depfile_init(&ctx->depfile) != 0) {
+                intern_fini(&ctx->intern);
+                return -1;
+        }
+        if (stats_init(&ctx->stats) != 0) {
+                depfile_fini(&ctx->depfile);
+                intern_fini(&ctx->intern);
+                return -1;
+        }
+
+        return 0;
+}
+
+/* exported interface documented in context.h */
+void genb_context_fini(struct genb_context *ctx)
+{
+        struct genb_context *prev = genb_context;
+
+        /* the syntax trees are released through the current context */
+        genb_context_set(ctx);
+        genbind_ast_free();
+        webidl_ast_free();
+        genb_context_set((prev == ctx) ? NULL : prev);
+
+        stats_fini(&ctx->stats);
+        depfile_fini(&ctx->depfile);
+        intern_fini(&ctx->intern);
+}
+
+/* exported interface documented in context.h */
+void genb_context_set(struct genb_context *ctx)
+{
+        genb_context = ctx;
+        options = (ctx == NULL) ? NULL : &ctx->options;
+}
+
+/* exported interface documented in context.h */
+void genb_context_nomem(void)
+{
+        /* failures may be recorded concurrently by parse and output jobs */
+        __atomic_store_n(&genb_context->failed, true, __ATOMIC_RELAXED);
+}
+
+/* exported interface documented in context.h */
+bool genb_context_failed(void)
+{
+        return __atomic_load_n(&genb_context->failed, __ATOMIC_RELAXED);
+}
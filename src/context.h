@@ -0,0 +1,84 @@
+/* generator context
+ *
+ * This file is part of nsgenbind.
+ * Licensed under the MIT License,
+ *                http://www.opensource.org/licenses/mit-license.php
+ * Copyright 2026 agent <agent@local>
+ */
+
+#ifndef nsgenbind_context_h
+#define nsgenbind_context_h
+
+#include <stdbool.h>
+
+#include "options.h"
+#include "intern.h"
+#include "depfile.h"
+#include "stats.h"
+#include "nsgenbind-ast.h"
+#include "webidl-ast.h"
+
+/**
+ * state of a generator context
+ *
+ * Everything built while generating bindings belongs to a context so
+ * several contexts may be used independently. Each thread operates on
+ * the context it has selected with genb_context_set().
+ */
+struct genb_context {
+        struct options options; /**< options the pipeline runs with */
+        struct intern_table intern; /**< interned strings */
+        struct genbind_ast_state genbind; /**< binding AST */
+        struct webidl_ast_state webidl; /**< Web IDL AST */
+        struct depfile_state depfile; /**< recorded dependencies */
+        struct stats_state stats; /**< recorded statistics */
+        bool failed; /**< an allocation failed */
+};
+
+/**
+ * context of the calling thread
+ */
+extern __thread struct genb_context *genb_context;
+
+/**
+ * initialise a context
+ *
+ * \param ctx The context to initialise.
+ * \return 0 on success else -1.
+ */
+int genb_context_init(struct genb_context *ctx);
+
+/**
+ * release everything held by a context
+ *
+ * \param ctx The context to finalise.
+ */
+void genb_context_fini(struct genb_context *ctx);
+
+/**
+ * select the context the calling thread operates on
+ *
+ * Output and parse jobs select the context of the thread which started
+ * them.
+ *
+ * \param ctx The context to use or NULL for none.
+ */
+void genb_context_set(struct genb_context *ctx);
+
+/**
+ * record an allocation failure in the context of the calling thread
+ *
+ * Allocations made while parsing and building syntax trees cannot
+ * return their failure directly. The error is printed where it occurs
+ * and the phase fails once it completes.
+ */
+void genb_context_nomem(void);
+
+/**
+ * check if an allocation has failed in the context of the calling thread
+ *
+ * \return true if an allocation failure has been recorded.
+ */
+bool genb_context_failed(void);
+
+#endif
@@ -0,0 +1,253 @@
+/* make compatible dependency file generation implementation
+ *
+ * This file is part of nsgenbind.
+ * Licensed under the MIT License,
+ *                http://www.opensource.org/licenses/mit-license.php
+ * Copyright 2026 agent <agent@local>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+
+#include "options.h"
+#include "context.h"
+#include "depfile.h"
+
+/**
+ * add a path to a list
+ *
+ * \param list The list to add to.
+ * \param fname The path to add.
+ * \param unique Only add the path if it is not already present.
+ */
+static int
+depfile_list_add(struct depfile_list *list, const char *fname, bool unique)
+{
+        unsigned int idx;
+        char **newv;
+
+        if (unique) {
+                for (idx = 0; idx < list->pathc; idx++) {
+                        if (strcmp(list->pathv[idx], fname) == 0) {
+                                return 0;
+                        }
+                }
+        }
+
+        if (list->pathc == list->alloc) {
+                newv = realloc(list->pathv,
+                               (list->alloc + 64) * sizeof(char *));
+                if (newv == NULL) {
+                        return -1;
+                }
+                list->pathv = newv;
+                list->alloc += 64;
+        }
+
+        list->pathv[list->pathc] = strdup(fname);
+        if (list->pathv[list->pathc] == NULL) {
+                return -1;
+        }
+        list->pathc++;
+
+        return 0;
+}
+
+static void depfile_list_free(struct depfile_list *list)
+{
+        unsigned int idx;
+
+        for (idx = 0; idx < list->pathc; idx++) {
+                free(list->pathv[idx]);
+        }
+        free(list->pathv);
+        memset(list, 0, sizeof(*list));
+}
+
+static int depfile_cmp(const void *a, const void *b)
+{
+        return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+/**
+ * write a path escaped for make and ninja
+ */
+static void depfile_write_path(FILE *depf, const char *path)
+{
+        for (; *path != 0; path++) {
+                switch (*path) {
+                case ' ':
+                case '#':
+                        fputc('\\', depf);
+                        break;
+
+                case '$':
+                        fputc('$', depf);
+                        break;
+                }
+                fputc(*path, depf);
+        }
+}
+
+/* exported interface documented in depfile.h */
+int depfile_init(struct depfile_state *depfile)
+{
+        memset(depfile, 0, sizeof(struct depfile_state));
+
+        if (pthread_mutex_init(&depfile->lock, NULL) != 0) {
+                return -1;
+        }
+        return 0;
+}
+
+/* exported interface documented in depfile.h */
+void depfile_fini(struct depfile_state *depfile)
+{
+        depfile_list_free(&depfile->binding_inputs);
+        depfile_list_free(&depfile->idl_inputs);
+        depfile_list_free(&depfile->outputs);
+        pthread_mutex_destroy(&depfile->lock);
+}
+
+/* exported interface documented in depfile.h */
+int depfile_add_input(const char *fname, enum depfile_input type)
+{
+        struct depfile_state *depfile = &genb_context->depfile;
+        int res;
+
+        if ((options->depfilename == NULL) && !options->watch) {
+                return 0;
+        }
+
+        pthread_mutex_lock(&depfile->lock);
+        /* binding files may be included more than once */
+        if (type == DEPFILE_INPUT_IDL) {
+                res = depfile_list_add(&depfile->idl_inputs, fname, true);
+        } else {
+                res = depfile_list_add(&depfile->binding_inputs, fname, true);
+        }
+        pthread_mutex_unlock(&depfile->lock);
+
+        return res;
+}
+
+/* exported interface documented in depfile.h */
+int depfile_add_output(const char *fname)
+{
+        struct depfile_state *depfile = &genb_context->depfile;
+        int res;
+
+        if ((options->depfilename == NULL) && !options->watch) {
+                return 0;
+        }
+
+        pthread_mutex_lock(&depfile->lock);
+        /* each output is only generated once */
+        res = depfile_list_add(&depfile->outputs, fname, false);
+        pthread_mutex_unlock(&depfile->lock);
+
+        return res;
+}
+
+/* exported interface documented in depfile.h */
+int depfile_write(const char *fname)
+{
+        struct depfile_state *depfile = &genb_context->depfile;
+        struct depfile_list *outputs = &depfile->outputs;
+        struct depfile_list *binding_inputs = &depfile->binding_inputs;
+        struct depfile_list *idl_inputs = &depfile->idl_inputs;
+        FILE *depf;
+        unsigned int idx;
+
+        if (outputs->pathc == 0) {
+                /* nothing was generated so there is no rule to write */
+                return 0;
+        }
+
+        /* outputs are recorded by concurrent jobs so order them */
+        qsort(outputs->pathv, outputs->pathc, sizeof(char *), depfile_cmp);
+
+        depf = fopen(fname, "w");
+        if (depf == NULL) {
+                fprintf(stderr, "Error: unable to open dependency file %s (%s)\n",
+                        fname, strerror(errno));
+                return -1;
+        }
+
+        for (idx = 0; idx < outputs->pathc; idx++) {
+                if (idx != 0) {
+                        fprintf(depf, " \\\n");
+                }
+                depfile_write_path(depf, outputs->pathv[idx]);
+        }
+        fprintf(depf, ":");
+
+        for (idx = 0; idx < binding_inputs->pathc; idx++) {
+                fprintf(depf, " \\\n\t");
+                depfile_write_path(depf, binding_inputs->pathv[idx]);
+        }
+        for (idx = 0; idx < idl_inputs->pathc; idx++) {
+                fprintf(depf, " \\\n\t");
+                depfile_write_path(depf, idl_inputs->pathv[idx]);
+        }
+        fprintf(depf, "\n");
+
+        if (fclose(depf) != 0) {
+                fprintf(stderr, "Error: unable to write dependency file %s (%s)\n",
+                        fname, strerror(errno));
+                return -1;
+        }
+
+        return 0;
+}
+
+/* exported interface documented in depfile.h */
+int
+depfile_foreach_input(int (*cb)(const char *fname,
+                                enum depfile_input type,
+                                void *ctx),
+                      void *ctx)
+{
+        struct depfile_state *depfile = &genb_context->depfile;
+        unsigned int idx;
+        int res;
+
+        for (idx = 0; idx < depfile->binding_inputs.pathc; idx++) {
+                res = cb(depfile->binding_inputs.pathv[idx],
+                         DEPFILE_INPUT_BINDING,
+                         ctx);
+                if (res != 0) {
+                        return res;
+                }
+        }
+        for (idx = 0; idx < depfile->idl_inputs.pathc; idx++) {
+                res = cb(depfile->idl_inputs.pathv[idx], DEPFILE_INPUT_IDL, ctx);
+                if (res != 0) {
+                        return res;
+                }
+        }
+
+        return 0;
+}
+
+/* exported interface documented in depfile.h */
+void depfile_reset(bool idl)
+{
+        struct depfile_state *depfile = &genb_context->depfile;
+
+        depfile_list_free(&depfile->binding_inputs);
+        if (idl) {
+                depfile_list_free(&depfile->idl_inputs);
+        }
+        depfile_list_free(&depfile->outputs);
+}
+
+/* exported interface documented in depfile.h */
+void depfile_free(void)
+{
+        depfile_reset(true);
+}
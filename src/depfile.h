@@ -0,0 +1,119 @@
+/* make compatible dependency file generation
+ *
+ * This file is part of nsgenbind.
+ * Licensed under the MIT License,
+ *                http://www.opensource.org/licenses/mit-license.php
+ * Copyright 2026 agent <agent@local>
+ */
+
+#ifndef nsgenbind_depfile_h
+#define nsgenbind_depfile_h
+
+#include <stdbool.h>
+#include <pthread.h>
+
+/**
+ * kind of input file
+ */
+enum depfile_input {
+        DEPFILE_INPUT_BINDING, /**< binding file or binding include */
+        DEPFILE_INPUT_IDL, /**< Web IDL file */
+};
+
+/**
+ * list of recorded file paths
+ */
+struct depfile_list {
+        char **pathv; /**< recorded paths in the order they were added */
+        unsigned int pathc; /**< number of recorded paths */
+        unsigned int alloc; /**< allocated size of pathv */
+};
+
+/**
+ * dependencies recorded by a generator context
+ */
+struct depfile_state {
+        struct depfile_list binding_inputs; /**< binding files read */
+        struct depfile_list idl_inputs; /**< Web IDL files read */
+        struct depfile_list outputs; /**< files generated */
+        pthread_mutex_t lock; /**< serialises recording from concurrent output jobs */
+};
+
+/**
+ * initialise an empty dependency record
+ *
+ * \param depfile The record to initialise.
+ * \return 0 on success else -1.
+ */
+int depfile_init(struct depfile_state *depfile);
+
+/**
+ * release a dependency record
+ *
+ * \param depfile The record to finalise.
+ */
+void depfile_fini(struct depfile_state *depfile);
+
+/**
+ * record a file read to produce the output
+ *
+ * Nothing is recorded unless a dependency file has been requested or
+ * the inputs are being watched.
+ *
+ * \param fname The path of the file as opened.
+ * \param type The kind of input file.
+ * \return 0 on success else -1 on allocation failure.
+ */
+int depfile_add_input(const char *fname, enum depfile_input type);
+
+/**
+ * iterate the recorded input files
+ *
+ * Binding inputs are visited before Web IDL inputs.
+ *
+ * \param cb The callback made for each input, iteration stops if it
+ *           returns non zero.
+ * \param ctx The context passed to the callback.
+ * \return 0 on success else the non zero value returned by the callback.
+ */
+int depfile_foreach_input(int (*cb)(const char *fname,
+                                    enum depfile_input type,
+                                    void *ctx),
+                          void *ctx);
+
+/**
+ * record a generated output file
+ *
+ * May be called concurrently from output generation jobs.
+ *
+ * \param fname The path of the generated file.
+ * \return 0 on success else -1 on allocation failure.
+ */
+int depfile_add_output(const char *fname);
+
+/**
+ * write the recorded dependencies
+ *
+ * A single rule is written with every output as a target and every input
+ * as a prerequisite in a form understood by make and ninja.
+ *
+ * \param fname The path of the dependency file.
+ * \return 0 on success else -1 and an error message is printed.
+ */
+int depfile_write(const char *fname);
+
+/**
+ * release the recorded outputs and binding inputs
+ *
+ * Used before the bindings are generated again.
+ *
+ * \param idl Also release the Web IDL inputs as they will be read again.
+ */
+void depfile_reset(bool idl);
+
+/**
+ * release the recorded dependencies
+ */
+void depfile_free(void);
+
+#endif
@@ -111,26 +111,26 @@ int output_tool_prologue(struct opctx *outc)
 int output_ctype(struct opctx *outc, struct genbind_node *node, bool identifier)
 {
         const char *type_cdata = NULL;
+        struct genbind_node_iter typename_it;
         struct genbind_node *typename_node;
 
-        typename_node = genbind_node_find_type(genbind_node_getnode(node),
-                                               NULL,
+        genbind_node_iter_init(&typename_it, genbind_node_getnode(node));
+        typename_node = genbind_node_iter_next(&typename_it,
                                                GENBIND_NODE_TYPE_NAME);
         while (typename_node != NULL) {
                 type_cdata = genbind_node_gettext(typename_node);
 
                 outputf(outc, "%s", type_cdata);
 
-                typename_node = genbind_node_find_type(
-                        genbind_node_getnode(node),
-                        typename_node,
-                        GENBIND_NODE_TYPE_NAME);
+                typename_node = genbind_node_iter_next(&typename_it,
+                                                       GENBIND_NODE_TYPE_NAME);
 
                 /* separate all but the last entry with spaces */
                 if (typename_node != NULL) {
                         outputc(outc, ' ');
                 }
         }
+        genbind_node_iter_fini(&typename_it);
 
         if (identifier) {
                 if ((type_cdata != NULL) &&
@@ -150,11 +150,11 @@ int output_method_cdata(struct opctx *outc,
                         struct genbind_node *node,
                         enum genbind_method_type sel_method_type)
 {
+        struct genbind_node_iter method_it;
         struct genbind_node *method;
 
-        method = genbind_node_find_type(genbind_node_getnode(node),
-                                        NULL,
-                                        GENBIND_NODE_TYPE_METHOD);
+        genbind_node_iter_init(&method_it, genbind_node_getnode(node));
+        method = genbind_node_iter_next(&method_it, GENBIND_NODE_TYPE_METHOD);
 
         while (method != NULL) {
                 enum genbind_method_type *method_type;
@@ -169,10 +169,10 @@ int output_method_cdata(struct opctx *outc,
                         output_ccode(outc, method);
                 }
 
-                method = genbind_node_find_type(genbind_node_getnode(node),
-                                                method,
+                method = genbind_node_iter_next(&method_it,
                                                 GENBIND_NODE_TYPE_METHOD);
         }
+        genbind_node_iter_fini(&method_it);
 
         return 0;
 }
@@ -235,3 +235,52 @@ char *gen_idl2c_name(const char *idlname)
         }
         return name;
 }
+
+
+/* exported interface documented in duk-libdom.h */
+int output_upper_prefix(struct opctx *outc)
+{
+        const char *cur;
+
+        for (cur = DLPFX; *cur != 0; cur++) {
+                outputc(outc, toupper(*cur));
+        }
+
+        return 0;
+}
+
+
+/**
+ * output a class identifier name
+ *
+ * \param outc The output context.
+ * \param kind The kind of identifier following the class prefix.
+ * \param interface_name The IDL name of the interface.
+ */
+static int
+output_class_name(struct opctx *outc, const char *kind, const char *interface_name)
+{
+        const char *cur;
+
+        output_upper_prefix(outc);
+        outputf(outc, "_%s_", kind);
+        for (cur = interface_name; *cur != 0; cur++) {
+                outputc(outc, toupper(*cur));
+        }
+
+        return 0;
+}
+
+
+/* exported interface documented in duk-libdom.h */
+int output_class_id(struct opctx *outc, const char *interface_name)
+{
+        return output_class_name(outc, "CLASS", interface_name);
+}
+
+
+/* exported interface documented in duk-libdom.h */
+int output_class_id_last(struct opctx *outc, const char *interface_name)
+{
+        return output_class_name(outc, "CLASSLAST", interface_name);
+}
@@ -23,9 +23,6 @@
 #include "output.h"
 #include "duk-libdom.h"
 
-/** prefix for all generated functions */
-#define DLPFX "dukky"
-
 #define MAGICPFX "\\xFF\\xFFNETSURF_DUKTAPE_"
 
 
@@ -59,7 +56,7 @@ get_member_default_str(struct ir_entry *dictionarye,
 
         case WEBIDL_NODE_TYPE_LITERAL_BOOL:
                 if (member_type != WEBIDL_TYPE_BOOL) {
-                        fprintf(stderr,
+                        genb_diagf(
                                 "Dictionary %s:%s literal boolean type mismatch\n",
                                 dictionarye->name,
                                 membere->name);
@@ -121,7 +118,7 @@ output_member_acessor(struct opctx *outc,
                 WEBIDL_NODE_TYPE_TYPE);
 
         if (type_node == NULL) {
-                fprintf(stderr, "%s:%s has no type\n",
+                genb_diagf("%s:%s has no type\n",
                         dictionarye->name,
                         membere->name);
                 return -1;
@@ -134,7 +131,7 @@ output_member_acessor(struct opctx *outc,
                         WEBIDL_NODE_TYPE_TYPE_BASE));
 
         if (argument_type == NULL) {
-                fprintf(stderr,
+                genb_diagf(
                         "%s:%s has no type base\n",
                         dictionarye->name,
                         membere->name);
@@ -378,7 +375,9 @@ int output_dictionary(struct ir *ir, struct ir_entry *dictionarye)
                             GENBIND_METHOD_TYPE_POSTFACE);
 
 op_error:
-        output_close(dyop);
+        if (output_close(dyop) != 0) {
+                res = -1;
+        }
 
         return res;
 }
@@ -400,7 +399,7 @@ output_member_declaration(struct opctx *outc,
                 WEBIDL_NODE_TYPE_TYPE);
 
         if (type_node == NULL) {
-                fprintf(stderr, "%s:%s has no type\n",
+                genb_diagf("%s:%s has no type\n",
                         dictionarye->name,
                         membere->name);
                 return -1;
@@ -413,7 +412,7 @@ output_member_declaration(struct opctx *outc,
                         WEBIDL_NODE_TYPE_TYPE_BASE));
 
         if (argument_type == NULL) {
-                fprintf(stderr,
+                genb_diagf(
                         "%s:%s has no type base\n",
                         dictionarye->name,
                         membere->name);
@@ -23,9 +23,6 @@
 #include "output.h"
 #include "duk-libdom.h"
 
-/** prefix for all generated functions */
-#define DLPFX "dukky"
-
 #define MAGICPFX "\\xFF\\xFFNETSURF_DUKTAPE_"
 
 
@@ -57,13 +54,16 @@ static char *get_prototype_name(const char *interface_name)
  */
 static bool compare_ctypes(struct genbind_node *a, struct genbind_node *b)
 {
+        struct genbind_node_iter ita;
+        struct genbind_node_iter itb;
         struct genbind_node *ta;
         struct genbind_node *tb;
 
-        ta = genbind_node_find_type(genbind_node_getnode(a),
-                                    NULL, GENBIND_NODE_TYPE_NAME);
-        tb = genbind_node_find_type(genbind_node_getnode(b),
-                                    NULL, GENBIND_NODE_TYPE_NAME);
+        genbind_node_iter_init(&ita, genbind_node_getnode(a));
+        genbind_node_iter_init(&itb, genbind_node_getnode(b));
+
+        ta = genbind_node_iter_next(&ita, GENBIND_NODE_TYPE_NAME);
+        tb = genbind_node_iter_next(&itb, GENBIND_NODE_TYPE_NAME);
 
         while ((ta != NULL) && (tb != NULL)) {
                 char *txt_a;
@@ -73,14 +73,17 @@ static bool compare_ctypes(struct genbind_node *a, struct genbind_node *b)
                 txt_b = genbind_node_gettext(tb);
 
                 if (strcmp(txt_a, txt_b) != 0) {
-                        return false; /* missmatch */
+                        break; /* missmatch */
                 }
 
-                ta = genbind_node_find_type(genbind_node_getnode(a),
-                                            ta, GENBIND_NODE_TYPE_NAME);
-                tb = genbind_node_find_type(genbind_node_getnode(b),
-                                            tb, GENBIND_NODE_TYPE_NAME);
+                ta = genbind_node_iter_next(&ita, GENBIND_NODE_TYPE_NAME);
+                tb = genbind_node_iter_next(&itb, GENBIND_NODE_TYPE_NAME);
         }
+
+        genbind_node_iter_fini(&ita);
+        genbind_node_iter_fini(&itb);
+
+        /* types match only if both lists were exhausted together */
         if (ta != tb) {
                 return false;
         }
@@ -89,6 +92,31 @@ static bool compare_ctypes(struct genbind_node *a, struct genbind_node *b)
 }
 
 
+/**
+ * generate a get or put of the private pointer property
+ *
+ * The property is keyed by a literal when requested so duktape can
+ * resolve the key from its literal cache instead of interning it on
+ * every access.
+ *
+ * \param outc Output context
+ * \param op The property operation, either "get" or "put".
+ * \param idx The stack index of the object.
+ */
+static void output_private_prop(struct opctx *outc, const char *op, int idx)
+{
+        if (options->private_literal) {
+                outputf(outc,
+                        "\tduk_%s_prop_literal(ctx, %d, PRIVATE_MAGIC);\n",
+                        op, idx);
+        } else {
+                outputf(outc,
+                        "\tduk_%s_prop_string(ctx, %d, %s_magic_string_private);\n",
+                        op, idx, DLPFX);
+        }
+}
+
+
 /**
  * Generate code to create a private structure
  *
@@ -107,9 +135,8 @@ output_create_private(struct opctx *outc, char *class_name)
                 "\tif (priv == NULL) return 0;\n");
         outputf(outc,
                 "\tduk_push_pointer(ctx, priv);\n");
-        outputf(outc,
-                "\tduk_put_prop_string(ctx, 0, %s_magic_string_private);\n\n",
-                DLPFX);
+        output_private_prop(outc, "put", 0);
+        outputf(outc, "\n");
 
         return 0;
 }
@@ -123,9 +150,7 @@ output_safe_get_private(struct opctx *outc, char *class_name, int idx)
 {
         outputf(outc,
                 "\t%s_private_t *priv;\n", class_name);
-        outputf(outc,
-                "\tduk_get_prop_string(ctx, %d, %s_magic_string_private);\n",
-                idx, DLPFX);
+        output_private_prop(outc, "get", idx);
         outputf(outc,
                 "\tpriv = duk_get_pointer(ctx, -1);\n");
         outputf(outc,
@@ -148,6 +173,27 @@ static int output_get_prototype(struct opctx *outc, const char *interface_name)
 
         outputf(outc,
                 "\t/* get prototype */\n");
+
+        if (options->lazy_prototypes) {
+                /* creates the prototype if it does not yet exist */
+                outputf(outc,
+                        "\t%s_get_prototype(ctx, \"%s\");\n",
+                        DLPFX, proto_name);
+                free(proto_name);
+                return 0;
+        }
+
+        if (options->prototype_handles) {
+                /* prototype creation passes the handles as user data */
+                outputf(outc,
+                        "\tduk_push_heapptr(ctx, ((void **)udata)[");
+                output_class_id(outc, interface_name);
+                outputf(outc,
+                        "]);\n");
+                free(proto_name);
+                return 0;
+        }
+
         outputf(outc,
                 "\tduk_get_global_string(ctx, %s_magic_string_prototypes);\n",
                 DLPFX);
@@ -374,9 +420,7 @@ output_get_method_private(struct opctx *outc, char *class_name, bool is_global)
                 outputf(outc,
                         "\tduk_push_this(ctx);\n");
         }
-        outputf(outc,
-                "\tduk_get_prop_string(ctx, -1, %s_magic_string_private);\n",
-                DLPFX);
+        output_private_prop(outc, "get", -1);
         outputf(outc,
                 "\tpriv = duk_get_pointer(ctx, -1);\n");
         outputf(outc,
@@ -400,8 +444,11 @@ output_get_method_private(struct opctx *outc, char *class_name, bool is_global)
  * generate the interface constructor
  */
 static int
-output_interface_constructor(struct opctx *outc, struct ir_entry *interfacee)
+output_interface_constructor(struct opctx *outc,
+                             struct ir *ir,
+                             struct ir_entry *interfacee)
 {
+        struct ir_entry *inherite;
         int init_argc;
 
         /* constructor definition */
@@ -413,6 +460,19 @@ output_interface_constructor(struct opctx *outc, struct ir_entry *interfacee)
 
         output_create_private(outc, interfacee->class_name);
 
+        if (options->class_ids) {
+                /* identify the class in the first member of the private data */
+                outputf(outc, "\tpriv->");
+                for (inherite = ir_inherit_entry(ir, interfacee);
+                     inherite != NULL;
+                     inherite = ir_inherit_entry(ir, inherite)) {
+                        outputf(outc, "parent.");
+                }
+                outputf(outc, "class_id = ");
+                output_class_id(outc, interfacee->name);
+                outputf(outc, ";\n\n");
+        }
+
         /* generate call to initialisor */
         outputf(outc,
                 "\t%s_%s___init(ctx, priv",
@@ -540,7 +600,7 @@ output_interface_inherit_init(struct opctx *outc,
                         GENBIND_NODE_TYPE_PARAMETER,
                         param_name);
                 if (param_node == NULL) {
-                        fprintf(stderr,
+                        genb_diagf(
                                 "class \"%s\" (interface %s) parent class \"%s\" (interface %s) initialisor requires a parameter \"%s\" with compatible identifier\n",
                                 interfacee->class_name,
                                 interfacee->name,
@@ -577,13 +637,14 @@ static enum ir_init_argtype
 guess_argtype_from(struct genbind_node *param_node)
 {
         const char *type_cdata = NULL;
+        struct genbind_node_iter typename_it;
         struct genbind_node *typename_node;
 	bool unsigned_ = false;
 	bool int_ = false;
 	bool bool_ = false;
 
-        typename_node = genbind_node_find_type(genbind_node_getnode(param_node),
-                                               NULL,
+        genbind_node_iter_init(&typename_it, genbind_node_getnode(param_node));
+        typename_node = genbind_node_iter_next(&typename_it,
                                                GENBIND_NODE_TYPE_NAME);
         while (typename_node != NULL) {
                 type_cdata = genbind_node_gettext(typename_node);
@@ -594,11 +655,10 @@ guess_argtype_from(struct genbind_node *param_node)
 		} else if (strcmp(type_cdata, "bool") == 0) {
 			bool_ = true;
 		}
-                typename_node = genbind_node_find_type(
-                        genbind_node_getnode(param_node),
-                        typename_node,
-                        GENBIND_NODE_TYPE_NAME);
+                typename_node = genbind_node_iter_next(&typename_it,
+                                                       GENBIND_NODE_TYPE_NAME);
 	}
+        genbind_node_iter_fini(&typename_it);
 
 	if (type_cdata[0] == '*') {
 		return IR_INIT_ARG_POINTER;
@@ -619,6 +679,7 @@ output_interface_init_declaration(struct opctx *outc,
                                   struct ir_entry *interfacee,
                                   struct genbind_node *init_node)
 {
+        struct genbind_node_iter param_it;
         struct genbind_node *param_node;
 
         if  (interfacee->refcount == 0) {
@@ -634,9 +695,9 @@ output_interface_init_declaration(struct opctx *outc,
 	interfacee->class_init_argt = NULL;
 
         /* output the paramters on the method (if any) */
-        param_node = genbind_node_find_type(
-                genbind_node_getnode(init_node),
-                NULL, GENBIND_NODE_TYPE_PARAMETER);
+        genbind_node_iter_init(&param_it, genbind_node_getnode(init_node));
+        param_node = genbind_node_iter_next(&param_it,
+                                            GENBIND_NODE_TYPE_PARAMETER);
         while (param_node != NULL) {
                 interfacee->class_init_argc++;
 		interfacee->class_init_argt = realloc(interfacee->class_init_argt,
@@ -647,10 +708,10 @@ output_interface_init_declaration(struct opctx *outc,
 
                 output_ctype(outc, param_node, true);
 
-                param_node = genbind_node_find_type(
-                        genbind_node_getnode(init_node),
-                        param_node, GENBIND_NODE_TYPE_PARAMETER);
+                param_node = genbind_node_iter_next(&param_it,
+                                                GENBIND_NODE_TYPE_PARAMETER);
         }
+        genbind_node_iter_fini(&param_it);
 
         outputc(outc, ')');
 
@@ -886,6 +947,15 @@ output_global_create_prototype(struct opctx *outc,
 {
         int idx;
 
+        if (options->lazy_prototypes) {
+                outputf(outc,
+                        "\t/* Define interface objects created on first use */\n");
+                outputf(outc,
+                        "\t%s_define_interface_objects(ctx, 0);\n",
+                        DLPFX);
+                return 0;
+        }
+
         outputf(outc,
                 "\t/* Create interface objects */\n");
         for (idx = 0; idx < ir->entryc; idx++) {
@@ -915,6 +985,183 @@ output_global_create_prototype(struct opctx *outc,
 }
 
 
+/**
+ * generate the method table of an interface prototype
+ *
+ * \return true if a table was generated else false if there are no
+ *         named operations.
+ */
+static bool
+output_prototype_method_table(struct opctx *outc, struct ir_entry *entry)
+{
+        struct ir_operation_entry *operatione;
+        int opc;
+        bool named = false;
+
+        for (opc = 0; opc < entry->u.interface.operationc; opc++) {
+                if (entry->u.interface.operationv[opc].name != NULL) {
+                        named = true;
+                        break;
+                }
+        }
+        if (!named) {
+                return false;
+        }
+
+        outputf(outc,
+                "static const %s_method_t %s_%s_methods[] = {\n",
+                DLPFX, DLPFX, entry->class_name);
+
+        for (opc = 0; opc < entry->u.interface.operationc; opc++) {
+                operatione = entry->u.interface.operationv + opc;
+                if (operatione->name == NULL) {
+                        outputf(outc,
+                                "\t/* Special method on prototype - UNIMPLEMENTED */\n");
+                        continue;
+                }
+                outputf(outc,
+                        "\t{ \"%s\", %s_%s_%s, DUK_VARARGS, DUKKY_VALUE_FLAGS },\n",
+                        operatione->name,
+                        DLPFX, entry->class_name, operatione->name);
+        }
+
+        outputf(outc,
+                "\t{ NULL, NULL, 0, 0 }\n"
+                "};\n\n");
+
+        return true;
+}
+
+
+/**
+ * generate the attribute accessor table of an interface prototype
+ *
+ * \return true if a table was generated else false if there are no
+ *         attributes.
+ */
+static bool
+output_prototype_accessor_table(struct opctx *outc, struct ir_entry *entry)
+{
+        struct ir_attribute_entry *attributee;
+        int attrc;
+
+        if (entry->u.interface.attributec == 0) {
+                return false;
+        }
+
+        outputf(outc,
+                "static const %s_accessor_t %s_%s_accessors[] = {\n",
+                DLPFX, DLPFX, entry->class_name);
+
+        for (attrc = 0; attrc < entry->u.interface.attributec; attrc++) {
+                attributee = entry->u.interface.attributev + attrc;
+
+                outputf(outc,
+                        "\t{ \"%s\", %s_%s_%s_getter, ",
+                        attributee->name,
+                        DLPFX, entry->class_name, attributee->name);
+
+                if ((attributee->putforwards == NULL) &&
+                    (attributee->modifier == WEBIDL_TYPE_MODIFIER_READONLY)) {
+                        outputf(outc, "NULL");
+                } else {
+                        outputf(outc,
+                                "%s_%s_%s_setter",
+                                DLPFX, entry->class_name, attributee->name);
+                }
+
+                outputf(outc, ", DUKKY_ACCESSOR_FLAGS },\n");
+        }
+
+        outputf(outc,
+                "\t{ NULL, NULL, NULL, 0 }\n"
+                "};\n\n");
+
+        return true;
+}
+
+
+/**
+ * generate the constant table of an interface prototype
+ *
+ * \todo This implementation assumes the constant is a literal int and should
+ * check the type node base value.
+ *
+ * \return true if a table was generated else false if there are no
+ *         constants.
+ */
+static bool
+output_prototype_constant_table(struct opctx *outc, struct ir_entry *entry)
+{
+        struct ir_constant_entry *constante;
+        int constc;
+        int *value;
+
+        if (entry->u.interface.constantc == 0) {
+                return false;
+        }
+
+        outputf(outc,
+                "static const %s_constant_t %s_%s_constants[] = {\n",
+                DLPFX, DLPFX, entry->class_name);
+
+        for (constc = 0; constc < entry->u.interface.constantc; constc++) {
+                constante = entry->u.interface.constantv + constc;
+
+                value = webidl_node_getint(
+                        webidl_node_find_type(
+                                webidl_node_getnode(constante->node),
+                                NULL,
+                                WEBIDL_NODE_TYPE_LITERAL_INT));
+
+                outputf(outc,
+                        "\t{ \"%s\", %d, DUKKY_VALUE_FLAGS },\n",
+                        constante->name, *value);
+        }
+
+        outputf(outc,
+                "\t{ NULL, 0, 0 }\n"
+                "};\n\n");
+
+        return true;
+}
+
+
+/**
+ * generate the call populating a prototype from its tables
+ */
+static void
+output_prototype_tables_populate(struct opctx *outc,
+                                 struct ir_entry *interfacee,
+                                 bool methods,
+                                 bool accessors,
+                                 bool constants)
+{
+        outputf(outc,
+                "\t/* Add methods, properties and constants */\n");
+        outputf(outc,
+                "\t%s_populate_prototype(ctx,\n", DLPFX);
+        if (methods) {
+                outputf(outc, "\t\t\t\t%s_%s_methods,\n",
+                        DLPFX, interfacee->class_name);
+        } else {
+                outputf(outc, "\t\t\t\tNULL,\n");
+        }
+        if (accessors) {
+                outputf(outc, "\t\t\t\t%s_%s_accessors,\n",
+                        DLPFX, interfacee->class_name);
+        } else {
+                outputf(outc, "\t\t\t\tNULL,\n");
+        }
+        if (constants) {
+                outputf(outc, "\t\t\t\t%s_%s_constants);\n\n",
+                        DLPFX, interfacee->class_name);
+        } else {
+                outputf(outc, "\t\t\t\tNULL);\n\n");
+        }
+}
+
+
 /**
  * generate the interface prototype creator
  */
@@ -925,12 +1172,22 @@ output_interface_prototype(struct opctx *outc,
                            struct ir_entry *inherite)
 {
         struct genbind_node *proto_node;
+        bool methods = false;
+        bool accessors = false;
+        bool constants = false;
 
         /* find the prototype method on the class */
         proto_node = genbind_node_find_method(interfacee->class,
                                               NULL,
                                               GENBIND_METHOD_TYPE_PROTOTYPE);
 
+        /* static tables the prototype is populated from */
+        if (options->prototype_tables) {
+                methods = output_prototype_method_table(outc, interfacee);
+                accessors = output_prototype_accessor_table(outc, interfacee);
+                constants = output_prototype_constant_table(outc, interfacee);
+        }
+
         /* prototype definition */
         outputf(outc,
                 "duk_ret_t %s_%s___proto(duk_context *ctx, void *udata)\n",
@@ -952,14 +1209,24 @@ output_interface_prototype(struct opctx *outc,
                         "\tduk_set_prototype(ctx, 0);\n\n");
         }
 
-        /* generate setting of methods */
-        output_prototype_methods(outc, interfacee);
+        if (options->prototype_tables) {
+                if (methods || accessors || constants) {
+                        output_prototype_tables_populate(outc,
+                                                         interfacee,
+                                                         methods,
+                                                         accessors,
+                                                         constants);
+                }
+        } else {
+                /* generate setting of methods */
+                output_prototype_methods(outc, interfacee);
 
-        /* generate setting of attributes */
-        output_prototype_attributes(outc, interfacee);
+                /* generate setting of attributes */
+                output_prototype_attributes(outc, interfacee);
 
-        /* generate setting of constants */
-        output_prototype_constants(outc, interfacee);
+                /* generate setting of constants */
+                output_prototype_constants(outc, interfacee);
+        }
 
         /* if this is the global object, output all interfaces which do not
          * prevent us from doing so
@@ -1167,9 +1434,74 @@ output_operation_optional_defaults(
 }
 
 
+/**
+ * generate a class identifier check of an interface typed argument
+ *
+ * Only interfaces with a binding class are checked as other interfaces,
+ * such as callback interfaces, may be implemented by plain javascript
+ * values.
+ *
+ * \return 0 if the check was generated else -1 if the type cannot be
+ *         checked.
+ */
+static int
+output_operation_argument_class_check(
+        struct opctx *outc,
+        struct ir *ir,
+        struct webidl_node *type_node,
+        struct ir_operation_argument_entry *argumente,
+        int argidx)
+{
+        const char *type_name;
+        struct ir_entry *typee;
+
+        type_name = webidl_node_gettext(
+                webidl_node_find_type(
+                        webidl_node_getnode(type_node),
+                        NULL,
+                        WEBIDL_NODE_TYPE_IDENT));
+        if (type_name == NULL) {
+                return -1;
+        }
+
+        typee = ir_find_entry(ir, IR_ENTRY_TYPE_INTERFACE, type_name);
+        if ((typee == NULL) ||
+            (typee->class == NULL) ||
+            (typee->class_id == -1)) {
+                return -1;
+        }
+
+        outputf(outc, "\t\tif (");
+        if (webidl_node_find_type(webidl_node_getnode(type_node),
+                                  NULL,
+                                  WEBIDL_NODE_TYPE_TYPE_NULLABLE) != NULL) {
+                outputf(outc, "!duk_is_null(ctx, %d) &&\n\t\t    ", argidx);
+        }
+        if (webidl_node_find_type(webidl_node_getnode(argumente->node),
+                                  NULL,
+                                  WEBIDL_NODE_TYPE_OPTIONAL) != NULL) {
+                outputf(outc,
+                        "!duk_is_undefined(ctx, %d) &&\n\t\t    ",
+                        argidx);
+        }
+        outputf(outc, "!%s_instanceof_class(ctx, %d, ", DLPFX, argidx);
+        output_class_id(outc, typee->name);
+        outputf(outc, ", ");
+        output_class_id_last(outc, typee->name);
+        outputf(outc,
+                ")) {\n"
+                "\t\t\treturn duk_error(ctx, DUK_ERR_TYPE_ERROR, %s_error_fmt_interface_type, %d, \"%s\", \"%s\");\n"
+                "\t\t}\n",
+                DLPFX, argidx, argumente->name, typee->name);
+
+        return 0;
+}
+
+
 static int
 output_operation_argument_type_check(
         struct opctx *outc,
+        struct ir *ir,
         struct ir_entry *interfacee,
         struct ir_operation_entry *operatione,
         struct ir_operation_overload_entry *overloade,
@@ -1187,7 +1519,7 @@ output_operation_argument_type_check(
                 WEBIDL_NODE_TYPE_TYPE);
 
         if (type_node == NULL) {
-                fprintf(stderr, "%s:%s %dth argument %s has no type\n",
+                genb_diagf("%s:%s %dth argument %s has no type\n",
                         interfacee->name,
                         operatione->name,
                         argidx,
@@ -1202,7 +1534,7 @@ output_operation_argument_type_check(
                         WEBIDL_NODE_TYPE_TYPE_BASE));
 
         if (argument_type == NULL) {
-                fprintf(stderr,
+                genb_diagf(
                         "%s:%s %dth argument %s has no type base\n",
                         interfacee->name,
                         operatione->name,
@@ -1252,6 +1584,19 @@ output_operation_argument_type_check(
                 break;
 
 
+        case WEBIDL_TYPE_USER:
+                if (options->class_ids &&
+                    (output_operation_argument_class_check(outc,
+                                                           ir,
+                                                           type_node,
+                                                           argumente,
+                                                           argidx) == 0)) {
+                        break;
+                }
+                outputf(outc,
+                        "\t\t/* unhandled type check */\n");
+                break;
+
         default:
                 outputf(outc,
                         "\t\t/* unhandled type check */\n");
@@ -1269,6 +1614,7 @@ output_operation_argument_type_check(
  */
 static int
 output_interface_operation(struct opctx *outc,
+                           struct ir *ir,
                            struct ir_entry *interfacee,
                            struct ir_operation_entry *operatione)
 {
@@ -1362,6 +1708,7 @@ output_interface_operation(struct opctx *outc,
 
         for (argidx = 0; argidx < overloade->argumentc; argidx++) {
                 output_operation_argument_type_check(outc,
+                                                     ir,
                                                      interfacee,
                                                      operatione,
                                                      overloade,
@@ -1397,7 +1744,9 @@ output_interface_operation(struct opctx *outc,
  * generate class methods for each interface operation
  */
 static int
-output_interface_operations(struct opctx *outc, struct ir_entry *ife)
+output_interface_operations(struct opctx *outc,
+                            struct ir *ir,
+                            struct ir_entry *ife)
 {
         int opc;
         int res = 0;
@@ -1405,6 +1754,7 @@ output_interface_operations(struct opctx *outc, struct ir_entry *ife)
         for (opc = 0; opc < ife->u.interface.operationc; opc++) {
                 res = output_interface_operation(
                         outc,
+                        ir,
                         ife,
                         ife->u.interface.operationv + opc);
                 if (res != 0) {
@@ -1694,13 +2044,13 @@ int output_interface(struct ir *ir, struct ir_entry *interfacee)
         output_interface_fini(ifop, interfacee, inherite);
 
         /* constructor */
-        output_interface_constructor(ifop, interfacee);
+        output_interface_constructor(ifop, ir, interfacee);
 
         /* destructor */
         output_interface_destructor(ifop, interfacee);
 
         /* operations */
-        output_interface_operations(ifop, interfacee);
+        output_interface_operations(ifop, ir, interfacee);
 
         /* attributes */
         output_interface_attributes(ifop, interfacee);
@@ -1731,7 +2081,9 @@ int output_interface(struct ir *ir, struct ir_entry *interfacee)
                             GENBIND_METHOD_TYPE_POSTFACE);
 
 op_error:
-        output_close(ifop);
+        if (output_close(ifop) != 0) {
+                res = -1;
+        }
 
         return res;
 }
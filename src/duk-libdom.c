@@ -14,18 +14,20 @@
 #include <getopt.h>
 #include <errno.h>
 #include <ctype.h>
+#include <pthread.h>
 
 #include "options.h"
+#include "context.h"
 #include "utils.h"
 #include "nsgenbind-ast.h"
 #include "webidl-ast.h"
 #include "ir.h"
 #include "output.h"
+#include "depfile.h"
+#include "manifest.h"
+#include "stats.h"
 #include "duk-libdom.h"
 
-/** prefix for all generated functions */
-#define DLPFX "dukky"
-
 #define MAGICPFX "\\xFF\\xFFNETSURF_DUKTAPE_"
 
 /**
@@ -109,9 +111,7 @@ static int close_header(struct ir *ir, struct opctx *hdrc)
                             ir->binding_node,
                             GENBIND_METHOD_TYPE_POSTFACE);
 
-        output_close(hdrc);
-
-        return 0;
+        return output_close(hdrc);
 }
 
 
@@ -130,6 +130,7 @@ output_private_header(struct ir *ir)
         for (idx = 0; idx < ir->entryc; idx++) {
                 struct ir_entry *interfacee;
                 struct ir_entry *inherite;
+                struct genbind_node_iter priv_it;
                 struct genbind_node *priv_node;
 
                 interfacee = ir->entries + idx;
@@ -165,13 +166,20 @@ output_private_header(struct ir *ir)
                         outputf(privc,
                                 "\t%s_private_t parent;\n",
                                 inherite->class_name);
+                } else if ((interfacee->type == IR_ENTRY_TYPE_INTERFACE) &&
+                           options->class_ids) {
+                        /* the class identifier is the first member of
+                         * every interface private structure
+                         */
+                        outputf(privc,
+                                "\tunsigned int class_id;\n");
                 }
 
                 /* for each private variable on the class output it here. */
-                priv_node = genbind_node_find_type(
-                        genbind_node_getnode(interfacee->class),
-                        NULL,
-                        GENBIND_NODE_TYPE_PRIVATE);
+                genbind_node_iter_init(&priv_it,
+                                       genbind_node_getnode(interfacee->class));
+                priv_node = genbind_node_iter_next(&priv_it,
+                                                   GENBIND_NODE_TYPE_PRIVATE);
                 while (priv_node != NULL) {
                         outputc(privc, '\t');
 
@@ -179,20 +187,17 @@ output_private_header(struct ir *ir)
 
                         outputf(privc, ";\n");
 
-                        priv_node = genbind_node_find_type(
-                                genbind_node_getnode(interfacee->class),
-                                priv_node,
-                                GENBIND_NODE_TYPE_PRIVATE);
+                        priv_node = genbind_node_iter_next(&priv_it,
+                                                GENBIND_NODE_TYPE_PRIVATE);
                 }
+                genbind_node_iter_fini(&priv_it);
 
                 outputf(privc,
                         "} __attribute__((aligned)) %s_private_t;\n\n",
                         interfacee->class_name);
         }
 
-        close_header(ir, privc);
-
-        return 0;
+        return close_header(ir, privc);
 }
 
 /**
@@ -223,9 +228,7 @@ output_prototype_header(struct ir *ir)
                 }
         }
 
-        close_header(ir, protoc);
-
-        return 0;
+        return close_header(ir, protoc);
 }
 
 /**
@@ -235,17 +238,18 @@ static int
 output_makefile(struct ir *ir)
 {
         int idx;
-        FILE *makef;
+        struct opctx *makec;
+        int res;
 
         /* open output file */
-        makef = genb_fopen_tmp("Makefile");
-        if (makef == NULL) {
+        res = output_open("Makefile", &makec);
+        if (res != 0) {
                 return -1;
         }
 
-        fprintf(makef, "# duk libdom makefile fragment\n\n");
+        outputf(makec, "# duk libdom makefile fragment\n\n");
 
-        fprintf(makef, "NSGENBIND_SOURCES:=binding.c ");
+        outputf(makec, "NSGENBIND_SOURCES:=binding.c ");
         for (idx = 0; idx < ir->entryc; idx++) {
                 struct ir_entry *interfacee;
 
@@ -257,11 +261,294 @@ output_makefile(struct ir *ir)
                         continue;
                 }
 
-                fprintf(makef, "%s ", interfacee->filename);
+                outputf(makec, "%s ", interfacee->filename);
+        }
+        outputf(makec, "\nNSGENBIND_PREFIX:=%s\n", options->outdirname);
+
+        return output_close(makec);
+}
+
+
+/**
+ * generate the declarations of the prototype table types
+ *
+ * Methods and constants are defined as values and accessors as
+ * getter/setter pairs with the same property attributes the unrolled
+ * prototype population uses.
+ */
+static void output_binding_table_declarations(struct opctx *bindc)
+{
+        outputf(bindc,
+                "\n"
+                "/* Prototype table property attributes */\n"
+                "#define DUKKY_VALUE_FLAGS (DUK_DEFPROP_HAVE_VALUE | \\\n"
+                "\t\t\t   DUK_DEFPROP_HAVE_WRITABLE | \\\n"
+                "\t\t\t   DUK_DEFPROP_HAVE_ENUMERABLE | \\\n"
+                "\t\t\t   DUK_DEFPROP_ENUMERABLE | \\\n"
+                "\t\t\t   DUK_DEFPROP_HAVE_CONFIGURABLE)\n"
+                "#define DUKKY_ACCESSOR_FLAGS (DUK_DEFPROP_HAVE_ENUMERABLE | \\\n"
+                "\t\t\t      DUK_DEFPROP_ENUMERABLE | \\\n"
+                "\t\t\t      DUK_DEFPROP_HAVE_CONFIGURABLE)\n"
+                "\n");
+
+        outputf(bindc,
+                "/* Prototype method table entry */\n"
+                "typedef struct {\n"
+                "\tconst char *name;\n"
+                "\tduk_c_function func;\n"
+                "\tduk_int_t nargs;\n"
+                "\tduk_uint_t flags;\n"
+                "} %s_method_t;\n"
+                "\n"
+                "/* Prototype accessor table entry, setter is NULL if readonly */\n"
+                "typedef struct {\n"
+                "\tconst char *name;\n"
+                "\tduk_c_function getter;\n"
+                "\tduk_c_function setter;\n"
+                "\tduk_uint_t flags;\n"
+                "} %s_accessor_t;\n"
+                "\n"
+                "/* Prototype constant table entry */\n"
+                "typedef struct {\n"
+                "\tconst char *name;\n"
+                "\tduk_int_t value;\n"
+                "\tduk_uint_t flags;\n"
+                "} %s_constant_t;\n"
+                "\n",
+                DLPFX, DLPFX, DLPFX);
+
+        outputf(bindc,
+                "void %s_populate_prototype(duk_context *ctx,\n"
+                "\t\t\t      const %s_method_t *methods,\n"
+                "\t\t\t      const %s_accessor_t *accessors,\n"
+                "\t\t\t      const %s_constant_t *constants);\n",
+                DLPFX, DLPFX, DLPFX, DLPFX);
+}
+
+/**
+ * generate the shared loop installing prototype tables
+ *
+ * Each table is terminated by an entry with a NULL name and the
+ * prototype being populated is at stack index 0.
+ */
+static void output_binding_table_populate(struct opctx *bindc)
+{
+        const char *dump = "";
+        const char *dump_nested = "";
+
+        if (options->dbglog) {
+                dump = "\t\tduk_push_context_dump(ctx);\n"
+                        "\t\tNSLOG(dukky, DEEPDEBUG, \"Stack: %s\", duk_to_string(ctx, -1));\n"
+                        "\t\tduk_pop(ctx);\n";
+                dump_nested = "\t\t\tduk_push_context_dump(ctx);\n"
+                        "\t\t\tNSLOG(dukky, DEEPDEBUG, \"Stack: %s\", duk_to_string(ctx, -1));\n"
+                        "\t\t\tduk_pop(ctx);\n";
+        }
+
+        outputf(bindc,
+                "void %s_populate_prototype(duk_context *ctx,\n"
+                "\t\t\t      const %s_method_t *methods,\n"
+                "\t\t\t      const %s_accessor_t *accessors,\n"
+                "\t\t\t      const %s_constant_t *constants)\n"
+                "{\n",
+                DLPFX, DLPFX, DLPFX, DLPFX);
+
+        outputf(bindc,
+                "\tfor (; (methods != NULL) && (methods->name != NULL); methods++) {\n"
+                "\t\tduk_dup(ctx, 0);\n"
+                "\t\tduk_push_string(ctx, methods->name);\n"
+                "\t\tduk_push_c_function(ctx, methods->func, methods->nargs);\n"
+                "%s"
+                "\t\tduk_def_prop(ctx, -3, methods->flags);\n"
+                "\t\tduk_pop(ctx);\n"
+                "\t}\n"
+                "\n",
+                dump);
+
+        outputf(bindc,
+                "\tfor (; (accessors != NULL) && (accessors->name != NULL); accessors++) {\n"
+                "\t\tduk_dup(ctx, 0);\n"
+                "\t\tduk_push_string(ctx, accessors->name);\n"
+                "\t\tduk_push_c_function(ctx, accessors->getter, 0);\n"
+                "\t\tif (accessors->setter != NULL) {\n"
+                "\t\t\tduk_push_c_function(ctx, accessors->setter, 1);\n"
+                "%s"
+                "\t\t\tduk_def_prop(ctx, -4, DUK_DEFPROP_HAVE_GETTER |\n"
+                "\t\t\t\t     DUK_DEFPROP_HAVE_SETTER |\n"
+                "\t\t\t\t     accessors->flags);\n"
+                "\t\t} else {\n"
+                "%s"
+                "\t\t\tduk_def_prop(ctx, -3, DUK_DEFPROP_HAVE_GETTER |\n"
+                "\t\t\t\t     accessors->flags);\n"
+                "\t\t}\n"
+                "\t\tduk_pop(ctx);\n"
+                "\t}\n"
+                "\n",
+                dump_nested, dump_nested);
+
+        outputf(bindc,
+                "\tfor (; (constants != NULL) && (constants->name != NULL); constants++) {\n"
+                "\t\tduk_dup(ctx, 0);\n"
+                "\t\tduk_push_string(ctx, constants->name);\n"
+                "\t\tduk_push_int(ctx, constants->value);\n"
+                "\t\tduk_def_prop(ctx, -3, constants->flags);\n"
+                "\t\tduk_pop(ctx);\n"
+                "\t}\n"
+                "}\n"
+                "\n");
+}
+
+/**
+ * assign class identifiers to an interface and those inheriting from it
+ *
+ * \param ir The intermediate representation.
+ * \param childv The first interface inheriting from each entry or -1.
+ * \param siblingv The next interface inheriting from the same entry or -1.
+ * \param idx The index of the entry to number.
+ * \param class_id The next class identifier to assign.
+ * \return The next class identifier after the entry and its descendants.
+ */
+static int
+assign_class_ids(struct ir *ir, int *childv, int *siblingv, int idx, int class_id)
+{
+        struct ir_entry *entry;
+        int child;
+
+        entry = ir->entries + idx;
+        entry->class_id = class_id++;
+
+        for (child = childv[idx]; child != -1; child = siblingv[child]) {
+                class_id = assign_class_ids(ir, childv, siblingv, child, class_id);
+        }
+
+        entry->class_id_last = class_id - 1;
+
+        return class_id;
+}
+
+
+/**
+ * compute the class identifiers of all interfaces
+ *
+ * Interfaces are numbered in pre-order of the inheritance forest so every
+ * interface inheriting from another has an identifier within the interval
+ * from the class identifier of that interface to its class_id_last.
+ *
+ * \param ir The intermediate representation.
+ * \return 0 on success else -1.
+ */
+static int compute_class_ids(struct ir *ir)
+{
+        int *childv;
+        int *siblingv;
+        int idx;
+        int class_id = 0;
+
+        childv = calloc((ir->entryc * 2) + 1, sizeof(int));
+        if (childv == NULL) {
+                return -1;
+        }
+        siblingv = childv + ir->entryc;
+
+        for (idx = 0; idx < ir->entryc; idx++) {
+                childv[idx] = -1;
+                siblingv[idx] = -1;
+                ir->entries[idx].class_id = -1;
+                ir->entries[idx].class_id_last = -1;
+        }
+
+        /* link children in reverse so they are numbered in map order */
+        for (idx = ir->entryc - 1; idx >= 0; idx--) {
+                struct ir_entry *inherite;
+
+                if (ir->entries[idx].type != IR_ENTRY_TYPE_INTERFACE) {
+                        continue;
+                }
+
+                inherite = ir_inherit_entry(ir, ir->entries + idx);
+                if ((inherite != NULL) &&
+                    (inherite->type == IR_ENTRY_TYPE_INTERFACE)) {
+                        siblingv[idx] = childv[inherite - ir->entries];
+                        childv[inherite - ir->entries] = idx;
+                }
+        }
+
+        for (idx = 0; idx < ir->entryc; idx++) {
+                struct ir_entry *inherite;
+
+                if (ir->entries[idx].type != IR_ENTRY_TYPE_INTERFACE) {
+                        continue;
+                }
+
+                inherite = ir_inherit_entry(ir, ir->entries + idx);
+                if ((inherite == NULL) ||
+                    (inherite->type != IR_ENTRY_TYPE_INTERFACE)) {
+                        class_id = assign_class_ids(ir,
+                                                    childv,
+                                                    siblingv,
+                                                    idx,
+                                                    class_id);
+                }
+        }
+
+        free(childv);
+
+        return 0;
+}
+
+
+/**
+ * generate the class identifier enumeration
+ *
+ * The last identifier of each interface is only needed for the instance
+ * checks made with class identifiers.
+ */
+static int output_binding_class_ids(struct ir *ir, struct opctx *bindc)
+{
+        struct ir_entry **orderv;
+        int idx;
+        int classc = 0;
+
+        orderv = calloc(ir->entryc + 1, sizeof(*orderv));
+        if (orderv == NULL) {
+                return -1;
+        }
+
+        for (idx = 0; idx < ir->entryc; idx++) {
+                if (ir->entries[idx].class_id != -1) {
+                        orderv[ir->entries[idx].class_id] = ir->entries + idx;
+                        classc++;
+                }
+        }
+
+        outputf(bindc,
+                "/* Class identifiers in pre-order of interface inheritance */\n"
+                "typedef enum {\n");
+        for (idx = 0; idx < classc; idx++) {
+                outputf(bindc, "\t");
+                output_class_id(bindc, orderv[idx]->name);
+                outputf(bindc, " = %d,\n", idx);
+        }
+        outputf(bindc, "\t");
+        output_upper_prefix(bindc);
+        outputf(bindc,
+                "_CLASSCOUNT = %d\n"
+                "} %s_class_id_t;\n"
+                "\n",
+                classc, DLPFX);
+
+        if (options->class_ids) {
+                outputf(bindc,
+                        "/* Last class identifier of each interface or those inheriting it */\n");
+                for (idx = 0; idx < classc; idx++) {
+                        outputf(bindc, "#define ");
+                        output_class_id_last(bindc, orderv[idx]->name);
+                        outputf(bindc, " %d\n", orderv[idx]->class_id_last);
+                }
+                outputf(bindc, "\n");
         }
-        fprintf(makef, "\nNSGENBIND_PREFIX:=%s\n", options->outdirname);
 
-        genb_fclose_tmp(makef, "Makefile");
+        free(orderv);
 
         return 0;
 }
@@ -276,6 +563,10 @@ output_makefile(struct ir *ir)
  * the create prototypes interface is used to cause all the prototype creation
  * functions for all generated classes to be called in the correct order with
  * the primary global (if any) generated last.
+ *
+ * When prototypes are created lazily the create prototypes interface only
+ * creates the primary global prototype and the get prototype interface
+ * creates any other prototype the first time it is requested.
  */
 static int
 output_binding_header(struct ir *ir)
@@ -306,86 +597,560 @@ output_binding_header(struct ir *ir)
                 "extern const char *%s_error_fmt_bool_type;\n"
                 "extern const char *%s_error_fmt_number_type;\n"
                 "extern const char *%s_magic_string_private;\n"
-                "extern const char *%s_magic_string_prototypes;\n"
-                "\n",
+                "extern const char *%s_magic_string_prototypes;\n",
                 DLPFX, DLPFX, DLPFX, DLPFX, DLPFX);
+        if (options->class_ids) {
+                outputf(bindc,
+                        "extern const char *%s_error_fmt_interface_type;\n",
+                        DLPFX);
+        }
+        outputf(bindc, "\n");
+
+        if ((options->class_ids || options->prototype_handles) &&
+            (output_binding_class_ids(ir, bindc) != 0)) {
+                close_header(ir, bindc);
+                return -1;
+        }
 
         outputf(bindc,
                 "duk_bool_t %s_instanceof(duk_context *ctx, duk_idx_t index, const char *klass);\n",
                 DLPFX);
+        if (options->class_ids) {
+                outputf(bindc,
+                        "duk_bool_t %s_instanceof_class(duk_context *ctx, duk_idx_t index, %s_class_id_t first, %s_class_id_t last);\n",
+                        DLPFX, DLPFX, DLPFX);
+                outputf(bindc, "#define ");
+                output_upper_prefix(bindc);
+                outputf(bindc,
+                        "_INSTANCEOF(ctx, index, K) \\\n"
+                        "\t%s_instanceof_class(ctx, index, ", DLPFX);
+                output_class_id(bindc, "##K");
+                outputf(bindc, ", ");
+                output_class_id_last(bindc, "##K");
+                outputf(bindc, ")\n");
+        }
 
         outputf(bindc,
                 "duk_ret_t %s_create_prototypes(duk_context *ctx);\n", DLPFX);
 
-        close_header(ir, bindc);
+        if (options->lazy_prototypes) {
+                outputf(bindc,
+                        "duk_bool_t %s_get_prototype(duk_context *ctx, const char *proto_name);\n"
+                        "void %s_define_interface_objects(duk_context *ctx, duk_idx_t idx);\n",
+                        DLPFX, DLPFX);
+        }
 
-        return 0;
+        if (options->prototype_handles) {
+                outputf(bindc,
+                        "void **%s_get_prototype_handles(duk_context *ctx);\n"
+                        "#define ",
+                        DLPFX);
+                output_upper_prefix(bindc);
+                outputf(bindc,
+                        "_PUSH_PROTOTYPE(ctx, handles, K) \\\n"
+                        "\tduk_push_heapptr(ctx, (handles)[");
+                output_class_id(bindc, "##K");
+                outputf(bindc, "])\n");
+        }
+
+        if (options->prototype_tables) {
+                output_binding_table_declarations(bindc);
+        }
+
+        return close_header(ir, bindc);
 }
 
 
 /**
- * generate binding source
+ * generate a call creating the prototype of an interface
+ */
+static void
+output_create_prototype_call(struct opctx *bindc,
+                             struct ir_entry *interfacee,
+                             const char *proto_name)
+{
+        outputf(bindc, "\t%s_create_prototype(ctx, ", DLPFX);
+        if (options->prototype_handles) {
+                outputf(bindc, "handles, ");
+                output_class_id(bindc, interfacee->name);
+                outputf(bindc, ", ");
+        }
+        outputf(bindc,
+                "%s_%s___proto, \"%s\", \"%s\");\n",
+                DLPFX,
+                interfacee->class_name,
+                proto_name,
+                interfacee->name);
+}
+
+
+/**
+ * generate the accessor of the prototype handles
+ */
+static void output_prototype_handles(struct opctx *bindc)
+{
+        outputf(bindc,
+                "void **%s_get_prototype_handles(duk_context *ctx)\n"
+                "{\n"
+                "\tvoid **handles;\n"
+                "\n"
+                "\tduk_get_global_string(ctx, %s_magic_string_prototypes);\n"
+                "\t/* ... protos */\n"
+                "\tduk_get_prop_string(ctx, -1, \"%sPROTOTYPE_HANDLES\");\n"
+                "\t/* ... protos handles */\n"
+                "\thandles = duk_get_buffer(ctx, -1, NULL);\n"
+                "\tduk_pop_2(ctx);\n"
+                "\treturn handles;\n"
+                "}\n"
+                "\n",
+                DLPFX, DLPFX, MAGICPFX);
+}
+
+
+/**
+ * generate the function creating every prototype
  *
- * The binding header contains all the duk-libdom specific binding
- * implementations.
+ * The prototypes are created in the order of the interface entries which
+ * ensures a parent prototype exists before any which inherit from it.
  */
-static int
-output_binding_src(struct ir *ir)
+static void output_binding_create_prototypes(struct ir *ir, struct opctx *bindc)
 {
         int idx;
         struct ir_entry *pglobale = NULL;
         char *proto_name;
-        struct opctx *bindc;
-        int res;
 
-        /* open the output binding file */
-        res = output_open("binding.c", &bindc);
-        if (res != 0 ) {
-                return -1;
+        outputf(bindc,
+                "duk_ret_t %s_create_prototypes(duk_context *ctx)\n", DLPFX);
+
+        outputf(bindc, "{\n");
+
+        if (options->prototype_handles) {
+                outputf(bindc,
+                        "\tvoid **handles;\n"
+                        "\n"
+                        "\t/* prototype handles live as long as the prototypes */\n"
+                        "\thandles = duk_push_fixed_buffer(ctx, (");
+                output_upper_prefix(bindc);
+                outputf(bindc,
+                        "_CLASSCOUNT + 1) * sizeof(void *));\n"
+                        "\tduk_put_global_string(ctx, \"%sPROTOTYPE_HANDLES\");\n"
+                        "\n",
+                        MAGICPFX);
         }
 
-        /* tool preface */
-        output_tool_preface(bindc);
+        for (idx = 0; idx < ir->entryc; idx++) {
+                struct ir_entry *interfacee;
 
-        /* binding preface */
-        output_method_cdata(bindc,
-                            ir->binding_node,
-                            GENBIND_METHOD_TYPE_PREFACE);
+                interfacee = ir->entries + idx;
 
-        /* tool prologue */
-        output_tool_prologue(bindc);
+                if (interfacee->type == IR_ENTRY_TYPE_DICTIONARY) {
+                        continue;
+                }
 
-        /* binding prologue */
-        output_method_cdata(bindc,
-                            ir->binding_node,
-                            GENBIND_METHOD_TYPE_PROLOGUE);
+                /* do not generate prototype calls for interfaces marked
+                 * no output
+                 */
+                if (interfacee->type == IR_ENTRY_TYPE_INTERFACE) {
+                        if (interfacee->u.interface.noobject) {
+                                continue;
+                        }
 
-        outputc(bindc, '\n');
+                        if (interfacee->u.interface.primary_global) {
+                                pglobale = interfacee;
+                                continue;
+                        }
+                }
+                proto_name = get_prototype_name(interfacee->name);
 
-        outputf(bindc,
-                "/* Error format strings */\n"
-                "const char *%s_error_fmt_argument =\"%%d argument required, but ony %%d present.\";\n"
-                "const char *%s_error_fmt_bool_type =\"argument %%d (%%s) requires a bool\";\n"
-                "const char *%s_error_fmt_number_type =\"argument %%d (%%s) requires a number\";\n",
-                DLPFX, DLPFX, DLPFX);
+                output_create_prototype_call(bindc, interfacee, proto_name);
 
-        outputf(bindc, "\n");
+                free(proto_name);
+        }
 
-        outputf(bindc,
-                "/* Magic identifiers */\n"
-                "const char *%s_magic_string_private =\"%sPRIVATE\";\n"
-                "const char *%s_magic_string_prototypes =\"%sPROTOTYPES\";\n",
-                DLPFX, MAGICPFX, DLPFX, MAGICPFX);
+        if (pglobale != NULL) {
+                outputf(bindc, "\n\t/* Global object prototype is last */\n");
 
-        outputf(bindc, "\n");
+                proto_name = get_prototype_name(pglobale->name);
+                output_create_prototype_call(bindc, pglobale, proto_name);
+                free(proto_name);
+        }
 
+        outputf(bindc, "\n\treturn DUK_ERR_NONE;\n");
 
-        /* instanceof helper */
+        outputf(bindc, "}\n");
+}
+
+
+/**
+ * prototype created on demand
+ */
+struct lazy_prototype {
+        struct ir_entry *entry;
+        char *proto_name;
+};
+
+
+static int compare_lazy_prototype(const void *a, const void *b)
+{
+        const struct lazy_prototype *pa = a;
+        const struct lazy_prototype *pb = b;
+
+        return strcmp(pa->proto_name, pb->proto_name);
+}
+
+
+/**
+ * generate accessors which create global interface objects on first use
+ *
+ * The accessors are defined on the primary global prototype in place of
+ * the interface objects and replace themselves with the object the first
+ * time they are read.
+ */
+static void
+output_binding_lazy_interface_objects(struct opctx *bindc,
+                                      const char *global_proto_name,
+                                      int protoc)
+{
         outputf(bindc,
-                "duk_bool_t\n"
-                "%s_instanceof(duk_context *ctx, duk_idx_t _idx, const char *klass)\n"
+                "static duk_ret_t\n"
+                "%s_interface_object_getter(duk_context *ctx)\n"
                 "{\n"
-                "\tduk_idx_t idx = duk_normalize_index(ctx, _idx);\n"
+                "\tconst %s_prototype_t *proto;\n"
+                "\tduk_idx_t holder;\n"
+                "\tduk_idx_t objs;\n"
+                "\n"
+                "\tproto = &%s_prototype_table[duk_get_current_magic(ctx)];\n"
+                "\tif (!%s_get_prototype(ctx, \"%s\")) {\n"
+                "\t\treturn 0;\n"
+                "\t}\n"
+                "\t/* holder */\n"
+                "\tholder = duk_get_top_index(ctx);\n"
+                "\tduk_push_object(ctx);\n"
+                "\t/* holder objs */\n"
+                "\tobjs = duk_get_top_index(ctx);\n"
+                "\tif (!%s_get_prototype(ctx, proto->proto_name)) {\n"
+                "\t\treturn 0;\n"
+                "\t}\n"
+                "\t/* holder objs proto */\n"
+                "\tdukky_inject_not_ctr(ctx, objs, proto->klass_name);\n"
+                "\t/* holder objs */\n"
+                "\tduk_push_string(ctx, proto->klass_name);\n"
+                "\tduk_get_prop_string(ctx, objs, proto->klass_name);\n"
+                "\t/* holder objs name obj */\n"
+                "\tduk_def_prop(ctx, holder, DUK_DEFPROP_HAVE_VALUE |\n"
+                "\t\t     DUK_DEFPROP_HAVE_WRITABLE | DUK_DEFPROP_WRITABLE |\n"
+                "\t\t     DUK_DEFPROP_HAVE_ENUMERABLE | DUK_DEFPROP_ENUMERABLE |\n"
+                "\t\t     DUK_DEFPROP_HAVE_CONFIGURABLE | DUK_DEFPROP_CONFIGURABLE);\n"
+                "\t/* holder objs */\n"
+                "\tduk_get_prop_string(ctx, objs, proto->klass_name);\n"
+                "\treturn 1;\n"
+                "}\n"
+                "\n",
+                DLPFX, DLPFX, DLPFX, DLPFX, global_proto_name, DLPFX);
+
+        outputf(bindc,
+                "static duk_ret_t\n"
+                "%s_interface_object_setter(duk_context *ctx)\n"
+                "{\n"
+                "\tconst %s_prototype_t *proto;\n"
+                "\n"
+                "\tproto = &%s_prototype_table[duk_get_current_magic(ctx)];\n"
+                "\t/* value */\n"
+                "\tduk_push_this(ctx);\n"
+                "\tduk_push_string(ctx, proto->klass_name);\n"
+                "\tduk_dup(ctx, 0);\n"
+                "\t/* value this name value */\n"
+                "\tduk_def_prop(ctx, 1, DUK_DEFPROP_HAVE_VALUE |\n"
+                "\t\t     DUK_DEFPROP_HAVE_WRITABLE | DUK_DEFPROP_WRITABLE |\n"
+                "\t\t     DUK_DEFPROP_HAVE_ENUMERABLE | DUK_DEFPROP_ENUMERABLE |\n"
+                "\t\t     DUK_DEFPROP_HAVE_CONFIGURABLE | DUK_DEFPROP_CONFIGURABLE);\n"
+                "\treturn 0;\n"
+                "}\n"
+                "\n",
+                DLPFX, DLPFX, DLPFX);
+
+        outputf(bindc,
+                "void %s_define_interface_objects(duk_context *ctx, duk_idx_t idx)\n"
+                "{\n"
+                "\tduk_int_t protoidx;\n"
+                "\n"
+                "\tidx = duk_normalize_index(ctx, idx);\n"
+                "\tfor (protoidx = 0; protoidx < %d; protoidx++) {\n"
+                "\t\tduk_push_string(ctx, %s_prototype_table[protoidx].klass_name);\n"
+                "\t\tduk_push_c_function(ctx, %s_interface_object_getter, 0);\n"
+                "\t\tduk_set_magic(ctx, -1, protoidx);\n"
+                "\t\tduk_push_c_function(ctx, %s_interface_object_setter, 1);\n"
+                "\t\tduk_set_magic(ctx, -1, protoidx);\n"
+                "\t\tduk_def_prop(ctx, idx, DUK_DEFPROP_HAVE_GETTER |\n"
+                "\t\t\t     DUK_DEFPROP_HAVE_SETTER |\n"
+                "\t\t\t     DUK_DEFPROP_HAVE_ENUMERABLE | DUK_DEFPROP_ENUMERABLE |\n"
+                "\t\t\t     DUK_DEFPROP_HAVE_CONFIGURABLE | DUK_DEFPROP_CONFIGURABLE);\n"
+                "\t}\n"
+                "}\n"
+                "\n",
+                DLPFX, protoc, DLPFX, DLPFX, DLPFX);
+}
+
+
+/**
+ * generate the on demand prototype creation
+ *
+ * A table of the prototype creators sorted by prototype name is searched
+ * when a prototype is first requested. Each prototype creator requests
+ * the prototype it inherits from so the parent chain is always created
+ * before a prototype which inherits from it.
+ *
+ * Only the primary global prototype is created by the create prototypes
+ * interface.
+ */
+static int
+output_binding_lazy_prototypes(struct ir *ir, struct opctx *bindc)
+{
+        struct lazy_prototype *protov;
+        struct ir_entry *pglobale = NULL;
+        char *global_proto_name = NULL;
+        int protoc = 0;
+        int idx;
+
+        protov = calloc(ir->entryc + 1, sizeof(*protov));
+        if (protov == NULL) {
+                return -1;
+        }
+
+        for (idx = 0; idx < ir->entryc; idx++) {
+                struct ir_entry *interfacee;
+
+                interfacee = ir->entries + idx;
+
+                /* prototypes are only created for interfaces which
+                 * generate output
+                 */
+                if ((interfacee->type != IR_ENTRY_TYPE_INTERFACE) ||
+                    (interfacee->u.interface.noobject)) {
+                        continue;
+                }
+
+                if (interfacee->u.interface.primary_global) {
+                        pglobale = interfacee;
+                }
+
+                protov[protoc].entry = interfacee;
+                protov[protoc].proto_name = get_prototype_name(interfacee->name);
+                protoc++;
+        }
+
+        qsort(protov, protoc, sizeof(*protov), compare_lazy_prototype);
+
+        outputf(bindc,
+                "/* Prototype creators sorted by prototype name */\n"
+                "typedef struct {\n"
+                "\tconst char *proto_name;\n"
+                "\tconst char *klass_name;\n"
+                "\tduk_safe_call_function genproto;\n"
+                "} %s_prototype_t;\n"
+                "\n"
+                "static const %s_prototype_t %s_prototype_table[] = {\n",
+                DLPFX, DLPFX, DLPFX);
+        for (idx = 0; idx < protoc; idx++) {
+                outputf(bindc,
+                        "\t{ \"%s\", \"%s\", %s_%s___proto },\n",
+                        protov[idx].proto_name,
+                        protov[idx].entry->name,
+                        DLPFX,
+                        protov[idx].entry->class_name);
+                if (protov[idx].entry == pglobale) {
+                        global_proto_name = protov[idx].proto_name;
+                }
+        }
+        /* terminating entry keeps the table valid when empty */
+        outputf(bindc,
+                "\t{ NULL, NULL, NULL }\n"
+                "};\n"
+                "\n");
+
+        outputf(bindc,
+                "static int %s_prototype_cmp(const void *key, const void *entry)\n"
+                "{\n"
+                "\treturn strcmp(key, ((const %s_prototype_t *)entry)->proto_name);\n"
+                "}\n"
+                "\n",
+                DLPFX, DLPFX);
+
+        outputf(bindc,
+                "duk_bool_t %s_get_prototype(duk_context *ctx, const char *proto_name)\n"
+                "{\n"
+                "\tconst %s_prototype_t *proto;\n"
+                "\n"
+                "\tduk_get_global_string(ctx, %s_magic_string_prototypes);\n"
+                "\t/* ... protos */\n"
+                "\tif (duk_get_prop_string(ctx, -1, proto_name)) {\n"
+                "\t\t/* ... protos proto */\n"
+                "\t\tduk_replace(ctx, -2);\n"
+                "\t\treturn true;\n"
+                "\t}\n"
+                "\tduk_pop_2(ctx);\n"
+                "\t/* ... */\n"
+                "\tproto = bsearch(proto_name, %s_prototype_table, %d,\n"
+                "\t\t\tsizeof(%s_prototype_t), %s_prototype_cmp);\n"
+                "\tif (proto == NULL) {\n"
+                "\t\tduk_push_undefined(ctx);\n"
+                "\t\treturn false;\n"
+                "\t}\n"
+                "\tduk_get_global_string(ctx, %s_magic_string_prototypes);\n"
+                "\t/* ... protos */\n"
+                "\tif (%s_create_prototype(ctx, proto->genproto, proto->proto_name,\n"
+                "\t\t\t\t   proto->klass_name) != DUK_ERR_NONE) {\n"
+                "\t\tduk_pop(ctx);\n"
+                "\t\tduk_push_undefined(ctx);\n"
+                "\t\treturn false;\n"
+                "\t}\n"
+                "\t/* ... protos proto */\n"
+                "\tduk_replace(ctx, -2);\n"
+                "\treturn true;\n"
+                "}\n"
+                "\n",
+                DLPFX, DLPFX, DLPFX, DLPFX, protoc, DLPFX, DLPFX, DLPFX, DLPFX);
+
+        if (global_proto_name != NULL) {
+                output_binding_lazy_interface_objects(bindc,
+                                                      global_proto_name,
+                                                      protoc);
+        }
+
+        outputf(bindc,
+                "duk_ret_t %s_create_prototypes(duk_context *ctx)\n"
+                "{\n",
+                DLPFX);
+        if (global_proto_name != NULL) {
+                outputf(bindc,
+                        "\t/* Global object prototype, all others are created on first use */\n"
+                        "\t%s_get_prototype(ctx, \"%s\");\n"
+                        "\tduk_pop(ctx);\n"
+                        "\n",
+                        DLPFX, global_proto_name);
+        }
+        outputf(bindc,
+                "\treturn DUK_ERR_NONE;\n"
+                "}\n");
+
+        for (idx = 0; idx < protoc; idx++) {
+                free(protov[idx].proto_name);
+        }
+        free(protov);
+
+        return 0;
+}
+
+
+/**
+ * generate the class identifier instanceof helper
+ */
+static void output_instanceof_class(struct opctx *bindc)
+{
+        outputf(bindc,
+                "duk_bool_t\n"
+                "%s_instanceof_class(duk_context *ctx,\n"
+                "\t\t\t duk_idx_t idx,\n"
+                "\t\t\t %s_class_id_t first,\n"
+                "\t\t\t %s_class_id_t last)\n"
+                "{\n"
+                "\tunsigned int *class_id;\n"
+                "\n"
+                "\t/* ... ??? ... */\n"
+                "\tif (!duk_check_type(ctx, idx, DUK_TYPE_OBJECT)) {\n"
+                "\t\treturn false;\n"
+                "\t}\n"
+                "\t/* ... obj ... */\n",
+                DLPFX, DLPFX, DLPFX);
+        if (options->private_literal) {
+                outputf(bindc,
+                        "\tduk_get_prop_literal(ctx, idx, PRIVATE_MAGIC);\n");
+        } else {
+                outputf(bindc,
+                        "\tduk_get_prop_string(ctx, idx, %s_magic_string_private);\n",
+                        DLPFX);
+        }
+        outputf(bindc,
+                "\t/* ... obj ... priv? */\n"
+                "\tclass_id = duk_get_pointer(ctx, -1);\n"
+                "\tduk_pop(ctx);\n"
+                "\t/* ... obj ... */\n"
+                "\tif (class_id == NULL) {\n"
+                "\t\treturn false;\n"
+                "\t}\n"
+                "\t/* the class identifier is the first private member */\n"
+                "\treturn (*class_id >= (unsigned int)first) &&\n"
+                "\t\t(*class_id <= (unsigned int)last);\n"
+                "}\n"
+                "\n");
+}
+
+
+/**
+ * generate binding source
+ *
+ * The binding header contains all the duk-libdom specific binding
+ * implementations.
+ */
+static int
+output_binding_src(struct ir *ir)
+{
+        struct opctx *bindc;
+        int res;
+
+        /* open the output binding file */
+        res = output_open("binding.c", &bindc);
+        if (res != 0 ) {
+                return -1;
+        }
+
+        /* tool preface */
+        output_tool_preface(bindc);
+
+        /* binding preface */
+        output_method_cdata(bindc,
+                            ir->binding_node,
+                            GENBIND_METHOD_TYPE_PREFACE);
+
+        /* tool prologue */
+        output_tool_prologue(bindc);
+
+        /* binding prologue */
+        output_method_cdata(bindc,
+                            ir->binding_node,
+                            GENBIND_METHOD_TYPE_PROLOGUE);
+
+        outputc(bindc, '\n');
+
+        outputf(bindc,
+                "/* Error format strings */\n"
+                "const char *%s_error_fmt_argument =\"%%d argument required, but ony %%d present.\";\n"
+                "const char *%s_error_fmt_bool_type =\"argument %%d (%%s) requires a bool\";\n"
+                "const char *%s_error_fmt_number_type =\"argument %%d (%%s) requires a number\";\n",
+                DLPFX, DLPFX, DLPFX);
+        if (options->class_ids) {
+                outputf(bindc,
+                        "const char *%s_error_fmt_interface_type =\"argument %%d (%%s) requires a %%s\";\n",
+                        DLPFX);
+        }
+
+        outputf(bindc, "\n");
+
+        outputf(bindc,
+                "/* Magic identifiers */\n"
+                "const char *%s_magic_string_private =\"%sPRIVATE\";\n"
+                "const char *%s_magic_string_prototypes =\"%sPROTOTYPES\";\n",
+                DLPFX, MAGICPFX, DLPFX, MAGICPFX);
+
+        outputf(bindc, "\n");
+
+
+        /* instanceof helper */
+        outputf(bindc,
+                "duk_bool_t\n"
+                "%s_instanceof(duk_context *ctx, duk_idx_t _idx, const char *klass)\n"
+                "{\n"
+                "\tduk_idx_t idx = duk_normalize_index(ctx, _idx);\n"
                 "\t/* ... ??? ... */\n"
                 "\tif (!duk_check_type(ctx, idx, DUK_TYPE_OBJECT)) {\n"
                 "\t\treturn false;\n"
@@ -415,6 +1180,11 @@ output_binding_src(struct ir *ir)
                 "\n",
                 DLPFX, DLPFX);
 
+        /* class identifier instanceof helper */
+        if (options->class_ids) {
+                output_instanceof_class(bindc);
+        }
+
         /* prototype creation helper function */
         outputf(bindc,
                 "static duk_ret_t\n"
@@ -444,6 +1214,12 @@ output_binding_src(struct ir *ir)
         outputf(bindc,
                 "static duk_ret_t %s_create_prototype(duk_context *ctx,\n",
                 DLPFX);
+        if (options->prototype_handles) {
+                outputf(bindc,
+                        "\t\t\t\t\tvoid **handles,\n"
+                        "\t\t\t\t\t%s_class_id_t class_id,\n",
+                        DLPFX);
+        }
         outputf(bindc,
                 "\t\t\t\t\tduk_safe_call_function genproto,\n"
                 "\t\t\t\t\tconst char *proto_name,\n"
@@ -451,7 +1227,9 @@ output_binding_src(struct ir *ir)
                 "{\n"
                 "\tduk_int_t ret;\n"
                 "\tduk_push_object(ctx);\n"
-                "\tif ((ret = duk_safe_call(ctx, genproto, NULL, 1, 1)) != DUK_EXEC_SUCCESS) {\n"
+                "\tif ((ret = duk_safe_call(ctx, genproto, %s, 1, 1)) != DUK_EXEC_SUCCESS) {\n",
+                options->prototype_handles ? "handles" : "NULL");
+        outputf(bindc,
                 "\t\tduk_pop(ctx);\n"
                 "\t\tNSLOG(dukky, WARNING, \"Failed to register prototype for %%s\", proto_name + 2);\n"
                 "\t\treturn ret;\n"
@@ -462,124 +1240,464 @@ output_binding_src(struct ir *ir)
                 "\tduk_push_c_function(ctx, %s_to_string, 0);\n"
                 "\tduk_put_prop_string(ctx, -2, \"toString\");\n"
                 "\tduk_push_string(ctx, \"toString\");\n"
-                "\tduk_def_prop(ctx, -2, DUK_DEFPROP_HAVE_ENUMERABLE);\n"
-                "\tduk_put_global_string(ctx, proto_name);\n"
-                "\treturn DUK_ERR_NONE;\n"
-                "}\n\n",
+                "\tduk_def_prop(ctx, -2, DUK_DEFPROP_HAVE_ENUMERABLE);\n",
                 MAGICPFX,
                 DLPFX);
+        if (options->prototype_handles) {
+                /* the prototype is kept alive by the prototypes object */
+                outputf(bindc,
+                        "\thandles[class_id] = duk_get_heapptr(ctx, -1);\n");
+        }
+        if (options->lazy_prototypes) {
+                /* keep the prototype on the stack for the caller */
+                outputf(bindc,
+                        "\t/* ... protos proto */\n"
+                        "\tduk_dup(ctx, -1);\n"
+                        "\tduk_put_prop_string(ctx, -3, proto_name);\n");
+        } else {
+                outputf(bindc,
+                        "\tduk_put_global_string(ctx, proto_name);\n");
+        }
+        outputf(bindc,
+                "\treturn DUK_ERR_NONE;\n"
+                "}\n\n");
+
+        if (options->prototype_tables) {
+                output_binding_table_populate(bindc);
+        }
+
+        if (options->prototype_handles) {
+                output_prototype_handles(bindc);
+        }
 
         /* generate prototype creation */
-        outputf(bindc,
-                "duk_ret_t %s_create_prototypes(duk_context *ctx)\n", DLPFX);
+        if (options->lazy_prototypes) {
+                res = output_binding_lazy_prototypes(ir, bindc);
+        } else {
+                output_binding_create_prototypes(ir, bindc);
+        }
+        if (res != 0) {
+                output_close(bindc);
+                return -1;
+        }
 
-        outputf(bindc, "{\n");
+        /* binding postface */
+        output_method_cdata(bindc,
+                            ir->binding_node,
+                            GENBIND_METHOD_TYPE_POSTFACE);
 
-        for (idx = 0; idx < ir->entryc; idx++) {
-                struct ir_entry *interfacee;
+        return output_close(bindc);
+}
 
-                interfacee = ir->entries + idx;
+/**
+ * generate the output for a single interface or dictionary entry
+ */
+static int output_entry(struct ir *ir, struct ir_entry *irentry)
+{
+        int res = 0;
 
-                if (interfacee->type == IR_ENTRY_TYPE_DICTIONARY) {
-                        continue;
+        switch (irentry->type) {
+        case IR_ENTRY_TYPE_INTERFACE:
+                /* do not generate class for interfaces marked no
+                 * output
+                 */
+                if (!irentry->u.interface.noobject) {
+                        res = output_interface(ir, irentry);
                 }
+                break;
 
-                /* do not generate prototype calls for interfaces marked
-                 * no output
+        case IR_ENTRY_TYPE_DICTIONARY:
+                res = output_dictionary(ir, irentry);
+                break;
+
+        default:
+                break;
+        }
+
+        return res;
+}
+
+/** leaf name of the manifest of entry output hashes */
+#define OUTPUT_MANIFEST "nsgenbind-manifest"
+
+/**
+ * output generation context
+ */
+struct output_jobs {
+        struct ir *ir;
+        pthread_mutex_t lock; /**< protects next */
+        int next; /**< index of next entry to be generated */
+        bool failed; /**< an entry generation has failed */
+        int *resv; /**< result of each entry generation */
+        struct genb_diag *diagv; /**< diagnostics from each entry */
+        uint64_t *hashv; /**< hash of the inputs of each entry */
+        bool *skipv; /**< entry output is up to date */
+        struct genb_context *context; /**< context the output belongs to */
+};
+
+/**
+ * compute the hash of the inputs shared by every entry
+ *
+ * The generator itself is identified by its executable so a rebuilt
+ * generator does not reuse output from a previous one.
+ *
+ * \return true and the hash updated if the inputs could be identified.
+ */
+static bool output_global_hash(struct ir *ir, uint64_t *hash_out)
+{
+        uint64_t hash = GENB_HASH_INIT;
+        struct ir_entry *entry;
+        bool has_class;
+        int idx;
+
+        if (!genb_hash_generator(&hash)) {
+                return false;
+        }
+
+        /* the output directory is used in generated include paths */
+        hash = genb_hash(hash,
+                         options->outdirname,
+                         strlen(options->outdirname) + 1);
+        hash = genb_hash(hash, &options->dbglog, sizeof(options->dbglog));
+        hash = genb_hash(hash,
+                         &options->prototype_tables,
+                         sizeof(options->prototype_tables));
+        hash = genb_hash(hash,
+                         &options->lazy_prototypes,
+                         sizeof(options->lazy_prototypes));
+        hash = genb_hash(hash,
+                         &options->private_literal,
+                         sizeof(options->private_literal));
+        hash = genb_hash(hash,
+                         &options->prototype_handles,
+                         sizeof(options->prototype_handles));
+        hash = genb_hash(hash, &options->class_ids, sizeof(options->class_ids));
+        hash = genb_hash(hash, &options->warnings, sizeof(options->warnings));
+
+        hash = genbind_node_hash(ir->binding_node, hash);
+
+        if (options->class_ids) {
+                /* argument checks depend on the class and identifiers
+                 * of other interfaces
                  */
-                if (interfacee->type == IR_ENTRY_TYPE_INTERFACE) {
-                        if (interfacee->u.interface.noobject) {
-                                continue;
-                        }
+                for (idx = 0; idx < ir->entryc; idx++) {
+                        entry = ir->entries + idx;
+                        has_class = (entry->class != NULL);
+                        hash = genb_hash(hash,
+                                         entry->name,
+                                         strlen(entry->name) + 1);
+                        hash = genb_hash(hash, &has_class, sizeof(has_class));
+                        hash = genb_hash(hash,
+                                         &entry->class_id,
+                                         sizeof(entry->class_id));
+                        hash = genb_hash(hash,
+                                         &entry->class_id_last,
+                                         sizeof(entry->class_id_last));
+                }
+        }
 
-                        if (interfacee->u.interface.primary_global) {
-                                pglobale = interfacee;
-                                continue;
+        *hash_out = hash;
+        return true;
+}
+
+/**
+ * compute the hash of the inputs the output for an entry depends upon
+ *
+ * This is the entry and its binding class along with those of every
+ * entry it inherits from as they determine the private data layout and
+ * initialiser calls.
+ */
+static uint64_t
+output_entry_hash(struct ir *ir, struct ir_entry *entry, uint64_t hash)
+{
+        struct ir_entry *cure;
+        int idx;
+
+        hash = genb_hash(hash, &entry->refcount, sizeof(entry->refcount));
+
+        for (cure = entry; cure != NULL; cure = ir_inherit_entry(ir, cure)) {
+                hash = webidl_node_hash(cure->node, hash);
+                hash = genbind_node_hash(cure->class, hash);
+        }
+
+        /* the global object creates every interface object */
+        if ((entry->type == IR_ENTRY_TYPE_INTERFACE) &&
+            entry->u.interface.primary_global) {
+                for (idx = 0; idx < ir->entryc; idx++) {
+                        cure = ir->entries + idx;
+                        hash = genb_hash(hash, cure->name,
+                                         strlen(cure->name) + 1);
+                        hash = genb_hash(hash, &cure->type,
+                                         sizeof(cure->type));
+                        if (cure->type == IR_ENTRY_TYPE_INTERFACE) {
+                                hash = genb_hash(hash,
+                                        &cure->u.interface.noobject,
+                                        sizeof(cure->u.interface.noobject));
                         }
                 }
-                proto_name = get_prototype_name(interfacee->name);
+        }
 
-                outputf(bindc,
-                        "\t%s_create_prototype(ctx, %s_%s___proto, \"%s\", \"%s\");\n",
-                        DLPFX,
-                        DLPFX,
-                        interfacee->class_name,
-                        proto_name,
-                        interfacee->name);
+        return hash;
+}
 
-                free(proto_name);
+/**
+ * check if the output for an entry is generated to a file
+ */
+static bool output_entry_has_file(struct ir_entry *entry)
+{
+        if (entry->filename == NULL) {
+                return false;
         }
+        if ((entry->type == IR_ENTRY_TYPE_INTERFACE) &&
+            entry->u.interface.noobject) {
+                return false;
+        }
+        return true;
+}
 
-        if (pglobale != NULL) {
-                outputf(bindc, "\n\t/* Global object prototype is last */\n");
+/**
+ * find the entries whose output is already up to date
+ *
+ * \return the manifest the skipped entries were found in or NULL if no
+ *         entries can be skipped.
+ */
+static struct manifest *output_jobs_check(struct output_jobs *jobs)
+{
+        struct manifest *manifest;
+        struct ir_entry *entry;
+        uint64_t global_hash;
+        uint64_t hash;
+        char *fpath;
+        int idx;
 
-                proto_name = get_prototype_name(pglobale->name);
-                outputf(bindc,
-                        "\t%s_create_prototype(ctx, %s_%s___proto, \"%s\", \"%s\");\n",
-                        DLPFX,
-                        DLPFX,
-                        pglobale->class_name,
-                        proto_name,
-                        pglobale->name);
-                free(proto_name);
+        if (options->dryrun || !output_global_hash(jobs->ir, &global_hash)) {
+                return NULL;
         }
 
-        outputf(bindc, "\n\treturn DUK_ERR_NONE;\n");
+        manifest = manifest_load(OUTPUT_MANIFEST);
+        if (manifest == NULL) {
+                return NULL;
+        }
 
-        outputf(bindc, "}\n");
+        for (idx = 0; idx < jobs->ir->entryc; idx++) {
+                entry = jobs->ir->entries + idx;
+                if (!output_entry_has_file(entry)) {
+                        continue;
+                }
 
-        /* binding postface */
-        output_method_cdata(bindc,
-                            ir->binding_node,
-                            GENBIND_METHOD_TYPE_POSTFACE);
+                jobs->hashv[idx] = output_entry_hash(jobs->ir,
+                                                     entry,
+                                                     global_hash);
 
-        output_close(bindc);
+                if (!manifest_find(manifest, entry->filename, &hash) ||
+                    (hash != jobs->hashv[idx])) {
+                        continue;
+                }
 
-        return 0;
+                /* the output must also still be present */
+                fpath = genb_fpath(entry->filename);
+                if (access(fpath, F_OK) == 0) {
+                        jobs->skipv[idx] = true;
+                        depfile_add_output(fpath);
+                        stats_add(STATS_FILES_SKIPPED, 1);
+                }
+                free(fpath);
+        }
+
+        return manifest;
 }
 
-static int output_interfaces_dictionaries(struct ir *ir)
+/**
+ * record the hashes of the entries whose output is up to date
+ *
+ * Entries which produced diagnostics are not recorded so they are
+ * generated again, and the diagnostics repeated, on the next run.
+ */
+static int output_jobs_save(struct output_jobs *jobs, bool *cleanv)
 {
+        struct manifest *manifest;
+        struct ir_entry *entry;
+        int idx;
         int res;
+
+        manifest = manifest_new();
+        if (manifest == NULL) {
+                return -1;
+        }
+
+        for (idx = 0; idx < jobs->ir->entryc; idx++) {
+                entry = jobs->ir->entries + idx;
+                if (!output_entry_has_file(entry) || !cleanv[idx]) {
+                        continue;
+                }
+                if (manifest_add(manifest,
+                                 entry->filename,
+                                 jobs->hashv[idx]) != 0) {
+                        manifest_free(manifest);
+                        return -1;
+                }
+        }
+
+        res = manifest_save(manifest, OUTPUT_MANIFEST);
+        manifest_free(manifest);
+
+        return res;
+}
+
+/**
+ * output generation worker thread
+ *
+ * takes entries from the job context until there are none left or one
+ * fails. Diagnostics are captured per entry so they can be reported in
+ * entry order once all the workers are complete.
+ */
+static void *output_jobs_worker(void *ctx)
+{
+        struct output_jobs *jobs = ctx;
         int idx;
 
-        /* generate interfaces */
-        for (idx = 0; idx < ir->entryc; idx++) {
-                struct ir_entry *irentry;
+        genb_context_set(jobs->context);
 
-                irentry = ir->entries + idx;
+        for (;;) {
+                pthread_mutex_lock(&jobs->lock);
+                if (jobs->failed) {
+                        idx = jobs->ir->entryc;
+                } else {
+                        idx = jobs->next++;
+                }
+                pthread_mutex_unlock(&jobs->lock);
 
-                switch (irentry->type) {
-                case IR_ENTRY_TYPE_INTERFACE:
-                        /* do not generate class for interfaces marked no
-                         * output
-                         */
-                        if (!irentry->u.interface.noobject) {
-                                res = output_interface(ir, irentry);
-                                if (res != 0) {
-                                        return res;
-                                }
-                        }
+                if (idx >= jobs->ir->entryc) {
                         break;
+                }
 
-                case IR_ENTRY_TYPE_DICTIONARY:
-                        res = output_dictionary(ir, irentry);
-                        if (res != 0) {
-                                return res;
+                if (jobs->skipv[idx]) {
+                        /* output is already up to date */
+                        continue;
+                }
+
+                genb_diag_capture(jobs->diagv + idx);
+                jobs->resv[idx] = output_entry(jobs->ir,
+                                               jobs->ir->entries + idx);
+                genb_diag_capture(NULL);
+
+                if (jobs->resv[idx] != 0) {
+                        pthread_mutex_lock(&jobs->lock);
+                        jobs->failed = true;
+                        pthread_mutex_unlock(&jobs->lock);
+                }
+        }
+
+        return NULL;
+}
+
+/**
+ * generate interfaces and dictionaries
+ *
+ * Entries whose inputs are unchanged since the output was last generated
+ * are skipped. The rest are generated by a pool of worker threads or
+ * serially if only one job is requested.
+ */
+static int output_interfaces_dictionaries(struct ir *ir)
+{
+        struct output_jobs jobs;
+        struct manifest *manifest;
+        pthread_t *threadv;
+        bool *cleanv;
+        unsigned int nthreads;
+        unsigned int started = 0;
+        int res = 0;
+        int idx;
+
+        nthreads = options->jobs;
+        if (nthreads < 1) {
+                nthreads = 1;
+        }
+
+        jobs.ir = ir;
+        jobs.next = 0;
+        jobs.failed = false;
+        jobs.context = genb_context;
+        jobs.resv = calloc(ir->entryc + 1, sizeof(int));
+        jobs.diagv = calloc(ir->entryc + 1, sizeof(struct genb_diag));
+        jobs.hashv = calloc(ir->entryc + 1, sizeof(uint64_t));
+        jobs.skipv = calloc(ir->entryc + 1, sizeof(bool));
+        cleanv = calloc(ir->entryc + 1, sizeof(bool));
+        threadv = calloc(nthreads, sizeof(pthread_t));
+        if ((jobs.resv == NULL) ||
+            (jobs.diagv == NULL) ||
+            (jobs.hashv == NULL) ||
+            (jobs.skipv == NULL) ||
+            (cleanv == NULL) ||
+            (threadv == NULL)) {
+                res = -1;
+                goto jobs_free;
+        }
+        pthread_mutex_init(&jobs.lock, NULL);
+
+        manifest = output_jobs_check(&jobs);
+
+        if (nthreads > 1) {
+                for (started = 0; started < nthreads; started++) {
+                        if (pthread_create(threadv + started,
+                                           NULL,
+                                           output_jobs_worker,
+                                           &jobs) != 0) {
+                                break;
                         }
+                }
+        }
 
-                default:
-                        break;
+        if (started == 0) {
+                /* generate serially */
+                output_jobs_worker(&jobs);
+        }
+
+        while (started > 0) {
+                started--;
+                pthread_join(threadv[started], NULL);
+        }
+
+        /* report diagnostics in entry order up to the first failure */
+        for (idx = 0; idx < ir->entryc; idx++) {
+                if (res == 0) {
+                        cleanv[idx] = (jobs.diagv[idx].len == 0);
+                        genb_diag_flush(jobs.diagv + idx);
+                        res = jobs.resv[idx];
+                } else {
+                        /* discard diagnostics from entries after failure */
+                        free(jobs.diagv[idx].data);
                 }
         }
 
-        return 0;
+        /* output built after an allocation failure is incomplete */
+        if ((res == 0) && genb_context_failed()) {
+                res = -1;
+        }
+
+        if ((res == 0) && (manifest != NULL)) {
+                res = output_jobs_save(&jobs, cleanv);
+        }
+
+        manifest_free(manifest);
+        pthread_mutex_destroy(&jobs.lock);
+
+jobs_free:
+        free(jobs.resv);
+        free(jobs.diagv);
+        free(jobs.hashv);
+        free(jobs.skipv);
+        free(cleanv);
+        free(threadv);
+
+        return res;
 }
 
 int duk_libdom_output(struct ir *ir)
 {
         int idx;
         int res = 0;
+        struct stats_time start;
 
         /* process ir entries for output */
         for (idx = 0; idx < ir->entryc; idx++) {
@@ -603,37 +1721,54 @@ int duk_libdom_output(struct ir *ir)
                 }
         }
 
+        res = compute_class_ids(ir);
+        if (res != 0) {
+                goto output_err;
+        }
+
+        stats_time_start(&start);
         res = output_interfaces_dictionaries(ir);
+        stats_phase("output_interfaces_dictionaries", &start);
         if (res != 0) {
                 goto output_err;
         }
 
         /* generate private header */
+        stats_time_start(&start);
         res = output_private_header(ir);
+        stats_phase("output_private_header", &start);
         if (res != 0) {
                 goto output_err;
         }
 
         /* generate prototype header */
+        stats_time_start(&start);
         res = output_prototype_header(ir);
+        stats_phase("output_prototype_header", &start);
         if (res != 0) {
                 goto output_err;
         }
 
         /* generate binding header */
+        stats_time_start(&start);
         res = output_binding_header(ir);
+        stats_phase("output_binding_header", &start);
         if (res != 0) {
                 goto output_err;
         }
 
         /* generate binding source */
+        stats_time_start(&start);
         res = output_binding_src(ir);
+        stats_phase("output_binding_src", &start);
         if (res != 0) {
                 goto output_err;
         }
 
         /* generate makefile fragment */
+        stats_time_start(&start);
         res = output_makefile(ir);
+        stats_phase("output_makefile", &start);
 
 output_err:
 
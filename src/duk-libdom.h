@@ -9,6 +9,9 @@
 #ifndef nsgenbind_duk_libdom_h
 #define nsgenbind_duk_libdom_h
 
+/** prefix for all generated functions */
+#define DLPFX "dukky"
+
 /**
  * Generate output for duktape and libdom bindings.
  */
@@ -114,6 +117,40 @@ int output_ctype(struct opctx *outc, struct genbind_node *node, bool identifier)
  */
 char *gen_idl2c_name(const char *idlname);
 
+/**
+ * output the binding prefix in upper case for generated macro names.
+ *
+ * \param outc The output context.
+ * \return 0 on success.
+ */
+int output_upper_prefix(struct opctx *outc);
+
+/**
+ * output the class identifier name of an interface.
+ *
+ * The name is the enumeration value in the generated binding header used
+ * to identify instances of the interface.
+ *
+ * \param outc The output context.
+ * \param interface_name The IDL name of the interface.
+ * \return 0 on success.
+ */
+int output_class_id(struct opctx *outc, const char *interface_name);
+
+/**
+ * output the name of the last class identifier of an interface.
+ *
+ * The name is defined in the generated binding header as the highest
+ * class identifier of the interface and those inheriting from it. The
+ * CLASSLAST and CLASSCOUNT names cannot be formed from an interface
+ * name so never collide with a class identifier.
+ *
+ * \param outc The output context.
+ * \param interface_name The IDL name of the interface.
+ * \return 0 on success.
+ */
+int output_class_id_last(struct opctx *outc, const char *interface_name);
+
 /**
  * Generate class property setter for a single attribute.
  */
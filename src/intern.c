@@ -0,0 +1,250 @@
+/* string interning implementation
+ *
+ * This file is part of nsgenbind.
+ * Licensed under the MIT License,
+ *                http://www.opensource.org/licenses/mit-license.php
+ * Copyright 2026 agent <agent@local>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "arena.h"
+#include "context.h"
+#include "intern.h"
+
+/** initial number of hash table slots, must be a power of two */
+#define INTERN_INITIAL_SIZE 1024
+
+/**
+ * hash table slot
+ */
+struct intern_entry {
+        char *str; /**< interned string or NULL if slot unused */
+        size_t len; /**< length of string */
+        uint32_t hash; /**< hash of string */
+};
+
+/**
+ * FNV-1a hash of a string
+ */
+static uint32_t intern_hash(const char *s, size_t len)
+{
+        uint32_t hash = 2166136261U;
+
+        while (len > 0) {
+                hash ^= (unsigned char)*s++;
+                hash *= 16777619U;
+                len--;
+        }
+        return hash;
+}
+
+/**
+ * find the slot for a string
+ *
+ * \return The slot holding the string or the empty slot it would occupy.
+ */
+static struct intern_entry *
+intern_find(struct intern_table *table, const char *s, size_t len, uint32_t hash)
+{
+        unsigned int idx;
+        struct intern_entry *entry;
+
+        idx = hash & (table->size - 1);
+        for (;;) {
+                entry = table->entries + idx;
+                if (entry->str == NULL) {
+                        return entry;
+                }
+                if ((entry->hash == hash) &&
+                    (entry->len == len) &&
+                    (memcmp(entry->str, s, len) == 0)) {
+                        return entry;
+                }
+                idx = (idx + 1) & (table->size - 1);
+        }
+}
+
+/**
+ * resize the hash table
+ *
+ * \return 0 on success else -1 on allocation failure.
+ */
+static int intern_resize(struct intern_table *table, unsigned int size)
+{
+        struct intern_entry *oldentries;
+        unsigned int oldsize;
+        unsigned int idx;
+
+        oldentries = table->entries;
+        oldsize = table->size;
+
+        table->entries = calloc(size, sizeof(struct intern_entry));
+        if (table->entries == NULL) {
+                table->entries = oldentries;
+                return -1;
+        }
+        table->size = size;
+
+        for (idx = 0; idx < oldsize; idx++) {
+                if (oldentries[idx].str != NULL) {
+                        *intern_find(table,
+                                     oldentries[idx].str,
+                                     oldentries[idx].len,
+                                     oldentries[idx].hash) = oldentries[idx];
+                }
+        }
+        free(oldentries);
+
+        return 0;
+}
+
+/* exported interface documented in intern.h */
+int intern_init(struct intern_table *table)
+{
+        memset(table, 0, sizeof(struct intern_table));
+
+        if (pthread_rwlock_init(&table->lock, NULL) != 0) {
+                return -1;
+        }
+        return 0;
+}
+
+/* exported interface documented in intern.h */
+void intern_fini(struct intern_table *table)
+{
+        free(table->entries);
+        arena_free(table->arena);
+        pthread_rwlock_destroy(&table->lock);
+}
+
+/* exported interface documented in intern.h */
+char *intern_nstring(const char *s, size_t n)
+{
+        struct intern_table *table = &genb_context->intern;
+        size_t len;
+        uint32_t hash;
+        struct intern_entry *entry;
+        char *res = NULL;
+
+        for (len = 0; (len < n) && (s[len] != 0); len++) {
+                continue;
+        }
+        hash = intern_hash(s, len);
+
+        /* requests are counted by concurrent readers */
+        __atomic_fetch_add(&table->requests, 1, __ATOMIC_RELAXED);
+
+        /* most strings are already interned so only a miss excludes
+         * the other parse jobs
+         */
+        pthread_rwlock_rdlock(&table->lock);
+        if (table->entries != NULL) {
+                res = intern_find(table, s, len, hash)->str;
+        }
+        pthread_rwlock_unlock(&table->lock);
+        if (res != NULL) {
+                return res;
+        }
+
+        pthread_rwlock_wrlock(&table->lock);
+
+        if (table->arena == NULL) {
+                table->arena = arena_new(0);
+                if ((table->arena == NULL) ||
+                    (intern_resize(table, INTERN_INITIAL_SIZE) != 0)) {
+                        arena_free(table->arena);
+                        table->arena = NULL;
+                        goto nomem;
+                }
+        }
+
+        /* another job may have added the string since the lookup */
+        entry = intern_find(table, s, len, hash);
+        if (entry->str != NULL) {
+                pthread_rwlock_unlock(&table->lock);
+                return entry->str;
+        }
+
+        /* keep the table no more than half full */
+        if ((table->count * 2) >= table->size) {
+                if (intern_resize(table, table->size * 2) != 0) {
+                        goto nomem;
+                }
+                entry = intern_find(table, s, len, hash);
+        }
+
+        entry->str = arena_strndup(table->arena, s, len);
+        if (entry->str == NULL) {
+                goto nomem;
+        }
+        entry->len = len;
+        entry->hash = hash;
+        table->count++;
+        res = entry->str;
+
+        pthread_rwlock_unlock(&table->lock);
+
+        return res;
+
+nomem:
+        pthread_rwlock_unlock(&table->lock);
+        fprintf(stderr, "Error: string table allocation failed\n");
+        genb_context_nomem();
+        return NULL;
+}
+
+/* exported interface documented in intern.h */
+char *intern_string(const char *s)
+{
+        return intern_nstring(s, strlen(s));
+}
+
+/* exported interface documented in intern.h */
+const char *intern_lookup(const char *s)
+{
+        size_t len;
+        struct intern_table *table = &genb_context->intern;
+        const char *res = NULL;
+
+        if (s == NULL) {
+                return NULL;
+        }
+
+        len = strlen(s);
+
+        pthread_rwlock_rdlock(&table->lock);
+        if (table->entries != NULL) {
+                res = intern_find(table, s, len, intern_hash(s, len))->str;
+        }
+        pthread_rwlock_unlock(&table->lock);
+
+        return res;
+}
+
+/* exported interface documented in intern.h */
+void intern_free(void)
+{
+        struct intern_table *table = &genb_context->intern;
+
+        free(table->entries);
+        table->entries = NULL;
+        arena_free(table->arena);
+        table->arena = NULL;
+        table->size = 0;
+        table->count = 0;
+        table->requests = 0;
+}
+
+/* exported interface documented in intern.h */
+int intern_stats(unsigned int *count, unsigned int *requests)
+{
+        *count = genb_context->intern.count;
+        *requests = __atomic_load_n(&genb_context->intern.requests,
+                                    __ATOMIC_RELAXED);
+        return 0;
+}
@@ -0,0 +1,95 @@
+/* string interning
+ *
+ * This file is part of nsgenbind.
+ * Licensed under the MIT License,
+ *                http://www.opensource.org/licenses/mit-license.php
+ * Copyright 2026 agent <agent@local>
+ */
+
+#ifndef nsgenbind_intern_h
+#define nsgenbind_intern_h
+
+#include <stddef.h>
+#include <pthread.h>
+
+struct intern_entry;
+struct arena;
+
+/**
+ * open addressed hash table of interned strings
+ *
+ * Each generator context has its own table.
+ */
+struct intern_table {
+        struct intern_entry *entries; /**< table slots */
+        unsigned int size; /**< number of slots */
+        unsigned int count; /**< number of used slots */
+        unsigned int requests; /**< number of intern requests */
+        struct arena *arena; /**< string storage */
+        pthread_rwlock_t lock; /**< serialises interning with lookups */
+};
+
+/**
+ * initialise an empty string table
+ *
+ * \param table The table to initialise.
+ * \return 0 on success else -1.
+ */
+int intern_init(struct intern_table *table);
+
+/**
+ * release a string table and every string interned in it
+ *
+ * \param table The table to finalise.
+ */
+void intern_fini(struct intern_table *table);
+
+/**
+ * intern a string
+ *
+ * Every distinct string is stored only once so interned strings may be
+ * compared for equality by pointer. The returned string must not be
+ * modified and remains valid until intern_free() is called.
+ *
+ * The string is interned in the table of the calling thread's generator
+ * context which is locked so strings may be interned and looked up
+ * concurrently.
+ *
+ * \param s The string to intern.
+ * \return The interned copy of the string or NULL on allocation failure
+ *         which is recorded in the generator context.
+ */
+char *intern_string(const char *s);
+
+/**
+ * intern at most n characters of a string
+ *
+ * \param s The string to intern.
+ * \param n The maximum number of characters of s to use.
+ * \return The interned copy of the string or NULL on allocation failure.
+ */
+char *intern_nstring(const char *s, size_t n);
+
+/**
+ * find the interned copy of a string
+ *
+ * \param s The string to look for.
+ * \return The interned copy of the string or NULL if it has never been
+ *         interned and hence cannot be equal to any interned string.
+ */
+const char *intern_lookup(const char *s);
+
+/**
+ * release all interned strings
+ */
+void intern_free(void);
+
+/**
+ * get interning statistics
+ *
+ * \param count Updated with the number of distinct strings.
+ * \param requests Updated with the number of strings interned.
+ */
+int intern_stats(unsigned int *count, unsigned int *requests);
+
+#endif
@@ -0,0 +1,1206 @@
+/* intermediate representation serialisation implementation
+ *
+ * This file is part of nsgenbind.
+ * Licensed under the MIT License,
+ *                http://www.opensource.org/licenses/mit-license.php
+ * Copyright 2026 agent <agent@local>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#include "utils.h"
+#include "intern.h"
+#include "nsgenbind-ast.h"
+#include "webidl-ast.h"
+#include "ir.h"
+#include "ir-serial.h"
+
+/** identifies a serialised intermediate representation */
+#define IRS_MAGIC "NSGB-IR"
+
+/** format version, changed whenever the layout changes */
+#define IRS_VERSION 1
+
+/** number of Web IDL node types */
+#define IRS_WEBIDL_NODE_TYPES (WEBIDL_NODE_TYPE_EXTENDED_ATTRIBUTE + 1)
+
+/** number of binding node types */
+#define IRS_GENBIND_NODE_TYPES (GENBIND_NODE_TYPE_PARAMETER + 1)
+
+/** fail compilation unless a condition holds */
+#define IRS_STATIC_ASSERT(name, cond) \
+        typedef char irs_static_assert_##name[(cond) ? 1 : -1]
+
+/* node types are stored by their value so a change to either
+ * enumeration must change the version, update these checks with it
+ */
+IRS_STATIC_ASSERT(webidl_node_types, IRS_WEBIDL_NODE_TYPES == 25);
+IRS_STATIC_ASSERT(genbind_node_types, IRS_GENBIND_NODE_TYPES == 18);
+
+/** text length used to store a NULL text */
+#define IRS_NULL_TEXT UINT32_MAX
+
+/** initial number of slots in a node map, must be a power of two */
+#define IRS_MAP_INITIAL_SIZE 4096
+
+/**
+ * kind of payload a node carries
+ */
+enum irs_payload {
+        IRS_PAYLOAD_NONE, /**< no payload */
+        IRS_PAYLOAD_TEXT, /**< length and characters */
+        IRS_PAYLOAD_INT, /**< integer */
+        IRS_PAYLOAD_FLOAT, /**< floating point number */
+        IRS_PAYLOAD_LIST, /**< reference to first child node */
+};
+
+/**
+ * node accessors and constructors for one kind of abstract syntax tree
+ *
+ * Nodes are referred to in the file by their position in the tree node
+ * table plus one so zero is a NULL reference.
+ */
+struct irs_ast {
+        int typec; /**< number of node types */
+        int (*gettype)(void *node);
+        void *(*next)(void *node);
+        void *(*getnode)(void *node);
+        char *(*gettext)(void *node);
+        int *(*getint)(void *node);
+        float *(*getfloat)(void *node);
+        void *(*new_node)(int type, void *next, void *value);
+        void *(*new_int)(int type, void *next, int value);
+        void *(*new_float)(int type, void *next, float value);
+};
+
+/**
+ * open addressed map of node pointers to their reference
+ */
+struct irs_map {
+        const void **keyv; /**< node pointers or NULL if slot unused */
+        uint32_t *refv; /**< node references */
+        uint32_t size; /**< number of slots */
+        uint32_t count; /**< number of used slots */
+};
+
+/**
+ * abstract syntax tree being written
+ */
+struct irs_tree {
+        const struct irs_ast *ast; /**< node accessors */
+        struct irs_map map; /**< nodes already written */
+        uint32_t nodec; /**< number of nodes written */
+};
+
+/**
+ * growable buffer the file is built in
+ */
+struct irs_wbuf {
+        char *data;
+        size_t len;
+        size_t alloc;
+        bool err; /**< an allocation failed or a node was not found */
+};
+
+/**
+ * bounds checked reader over the file content
+ */
+struct irs_rbuf {
+        const char *data;
+        size_t len;
+        size_t pos;
+        bool err; /**< a read went past the end or a value was invalid */
+};
+
+
+static int irs_webidl_gettype(void *node)
+{
+        return webidl_node_gettype(node);
+}
+
+static void *irs_webidl_next(void *node)
+{
+        return webidl_node_next(node);
+}
+
+static void *irs_webidl_getnode(void *node)
+{
+        return webidl_node_getnode(node);
+}
+
+static char *irs_webidl_gettext(void *node)
+{
+        return webidl_node_gettext(node);
+}
+
+static int *irs_webidl_getint(void *node)
+{
+        return webidl_node_getint(node);
+}
+
+static float *irs_webidl_getfloat(void *node)
+{
+        return webidl_node_getfloat(node);
+}
+
+static void *irs_webidl_new_node(int type, void *next, void *value)
+{
+        return webidl_node_new(type, next, value);
+}
+
+static void *irs_webidl_new_int(int type, void *next, int value)
+{
+        return webidl_new_number_node(type, next, value);
+}
+
+static void *irs_webidl_new_float(int type, void *next, float value)
+{
+        return webidl_new_float_node(type, next, value);
+}
+
+static const struct irs_ast irs_webidl_ast = {
+        IRS_WEBIDL_NODE_TYPES,
+        irs_webidl_gettype,
+        irs_webidl_next,
+        irs_webidl_getnode,
+        irs_webidl_gettext,
+        irs_webidl_getint,
+        irs_webidl_getfloat,
+        irs_webidl_new_node,
+        irs_webidl_new_int,
+        irs_webidl_new_float,
+};
+
+static int irs_genbind_gettype(void *node)
+{
+        return genbind_node_gettype(node);
+}
+
+static void *irs_genbind_next(void *node)
+{
+        return genbind_node_next(node);
+}
+
+static void *irs_genbind_getnode(void *node)
+{
+        return genbind_node_getnode(node);
+}
+
+static char *irs_genbind_gettext(void *node)
+{
+        return genbind_node_gettext(node);
+}
+
+static int *irs_genbind_getint(void *node)
+{
+        return genbind_node_getint(node);
+}
+
+static void *irs_genbind_new_node(int type, void *next, void *value)
+{
+        return genbind_new_node(type, next, value);
+}
+
+static void *irs_genbind_new_int(int type, void *next, int value)
+{
+        return genbind_new_number_node(type, next, value);
+}
+
+/* binding nodes never carry floating point values */
+static const struct irs_ast irs_genbind_ast = {
+        IRS_GENBIND_NODE_TYPES,
+        irs_genbind_gettype,
+        irs_genbind_next,
+        irs_genbind_getnode,
+        irs_genbind_gettext,
+        irs_genbind_getint,
+        NULL,
+        irs_genbind_new_node,
+        irs_genbind_new_int,
+        NULL,
+};
+
+
+static uint32_t irs_map_slot(struct irs_map *map, const void *key)
+{
+        uint64_t hash = (uint64_t)(uintptr_t)key;
+        uint32_t idx;
+
+        hash = (hash ^ (hash >> 29)) * 0x9e3779b97f4a7c15ULL;
+        idx = (uint32_t)(hash >> 32) & (map->size - 1);
+
+        while ((map->keyv[idx] != NULL) && (map->keyv[idx] != key)) {
+                idx = (idx + 1) & (map->size - 1);
+        }
+        return idx;
+}
+
+/**
+ * find the reference of a node already written
+ *
+ * \return The reference or 0 if the node has not been written.
+ */
+static uint32_t irs_map_find(struct irs_map *map, const void *key)
+{
+        uint32_t idx;
+
+        if ((key == NULL) || (map->size == 0)) {
+                return 0;
+        }
+        idx = irs_map_slot(map, key);
+        if (map->keyv[idx] == NULL) {
+                return 0;
+        }
+        return map->refv[idx];
+}
+
+static int irs_map_add(struct irs_map *map, const void *key, uint32_t ref)
+{
+        struct irs_map old = *map;
+        uint32_t idx;
+
+        /* keep the map no more than half full */
+        if ((map->count * 2) >= map->size) {
+                map->size = (old.size == 0) ? IRS_MAP_INITIAL_SIZE : old.size * 2;
+                map->keyv = calloc(map->size, sizeof(void *));
+                map->refv = calloc(map->size, sizeof(uint32_t));
+                if ((map->keyv == NULL) || (map->refv == NULL)) {
+                        free(map->keyv);
+                        free(map->refv);
+                        *map = old;
+                        return -1;
+                }
+                for (idx = 0; idx < old.size; idx++) {
+                        if (old.keyv[idx] != NULL) {
+                                uint32_t slot;
+
+                                slot = irs_map_slot(map, old.keyv[idx]);
+                                map->keyv[slot] = old.keyv[idx];
+                                map->refv[slot] = old.refv[idx];
+                        }
+                }
+                free(old.keyv);
+                free(old.refv);
+        }
+
+        idx = irs_map_slot(map, key);
+        map->keyv[idx] = key;
+        map->refv[idx] = ref;
+        map->count++;
+
+        return 0;
+}
+
+static void irs_map_free(struct irs_map *map)
+{
+        free(map->keyv);
+        free(map->refv);
+}
+
+
+static void irs_write(struct irs_wbuf *wbuf, const void *data, size_t len)
+{
+        char *ndata;
+        size_t nalloc;
+
+        if (wbuf->err) {
+                return;
+        }
+
+        if ((wbuf->len + len) > wbuf->alloc) {
+                nalloc = wbuf->alloc + len + (64 * 1024);
+                ndata = realloc(wbuf->data, nalloc);
+                if (ndata == NULL) {
+                        wbuf->err = true;
+                        return;
+                }
+                wbuf->data = ndata;
+                wbuf->alloc = nalloc;
+        }
+        memcpy(wbuf->data + wbuf->len, data, len);
+        wbuf->len += len;
+}
+
+static void irs_write_u8(struct irs_wbuf *wbuf, uint8_t value)
+{
+        irs_write(wbuf, &value, sizeof(value));
+}
+
+static void irs_write_u32(struct irs_wbuf *wbuf, uint32_t value)
+{
+        uint8_t data[4];
+
+        data[0] = value & 0xff;
+        data[1] = (value >> 8) & 0xff;
+        data[2] = (value >> 16) & 0xff;
+        data[3] = (value >> 24) & 0xff;
+        irs_write(wbuf, data, sizeof(data));
+}
+
+static void irs_write_i32(struct irs_wbuf *wbuf, int value)
+{
+        irs_write_u32(wbuf, (uint32_t)value);
+}
+
+static void irs_write_float(struct irs_wbuf *wbuf, float value)
+{
+        uint32_t bits;
+
+        memcpy(&bits, &value, sizeof(bits));
+        irs_write_u32(wbuf, bits);
+}
+
+static void irs_write_text(struct irs_wbuf *wbuf, const char *text)
+{
+        uint32_t len;
+
+        if (text == NULL) {
+                irs_write_u32(wbuf, IRS_NULL_TEXT);
+                return;
+        }
+        len = strlen(text);
+        irs_write_u32(wbuf, len);
+        irs_write(wbuf, text, len);
+}
+
+/**
+ * write a reference to a node which must already have been written
+ */
+static void
+irs_write_ref(struct irs_wbuf *wbuf, struct irs_tree *tree, const void *node)
+{
+        uint32_t ref = 0;
+
+        if (node != NULL) {
+                ref = irs_map_find(&tree->map, node);
+                if (ref == 0) {
+                        /* node is not part of the tree */
+                        wbuf->err = true;
+                }
+        }
+        irs_write_u32(wbuf, ref);
+}
+
+/**
+ * get the kind of payload a node carries
+ *
+ * The node content is not dereferenced so this may be used on a node
+ * constructed with a payload its type does not hold.
+ */
+static enum irs_payload irs_node_payload(const struct irs_ast *ast, void *node)
+{
+        if (ast->gettext(node) != NULL) {
+                return IRS_PAYLOAD_TEXT;
+        }
+        if (ast->getint(node) != NULL) {
+                return IRS_PAYLOAD_INT;
+        }
+        if ((ast->getfloat != NULL) && (ast->getfloat(node) != NULL)) {
+                return IRS_PAYLOAD_FLOAT;
+        }
+        if (ast->getnode(node) != NULL) {
+                return IRS_PAYLOAD_LIST;
+        }
+        return IRS_PAYLOAD_NONE;
+}
+
+/**
+ * write a node
+ *
+ * The node's children and next sibling must already have been written.
+ */
+static void
+irs_write_node(struct irs_wbuf *wbuf, struct irs_tree *tree, void *node)
+{
+        const struct irs_ast *ast = tree->ast;
+        enum irs_payload payload;
+
+        irs_write_u32(wbuf, ast->gettype(node));
+
+        payload = irs_node_payload(ast, node);
+        irs_write_u8(wbuf, payload);
+
+        switch (payload) {
+        case IRS_PAYLOAD_TEXT:
+                irs_write_text(wbuf, ast->gettext(node));
+                break;
+
+        case IRS_PAYLOAD_INT:
+                irs_write_i32(wbuf, *ast->getint(node));
+                break;
+
+        case IRS_PAYLOAD_FLOAT:
+                irs_write_float(wbuf, *ast->getfloat(node));
+                break;
+
+        case IRS_PAYLOAD_LIST:
+                irs_write_ref(wbuf, tree, ast->getnode(node));
+                break;
+
+        case IRS_PAYLOAD_NONE:
+                break;
+        }
+
+        irs_write_ref(wbuf, tree, ast->next(node));
+
+        tree->nodec++;
+        if (irs_map_add(&tree->map, node, tree->nodec) != 0) {
+                wbuf->err = true;
+        }
+}
+
+/**
+ * write a list of nodes and everything below them
+ *
+ * Nodes are written after their children and following siblings so the
+ * reader can construct each node complete. The walk stops at a node
+ * already written as the rest of the list is then shared.
+ */
+static void
+irs_write_list(struct irs_wbuf *wbuf, struct irs_tree *tree, void *list)
+{
+        const struct irs_ast *ast = tree->ast;
+        void **nodev = NULL;
+        void **newv;
+        size_t nodec = 0;
+        size_t alloc = 0;
+        void *node;
+        void *child;
+
+        for (node = list;
+             (node != NULL) && (irs_map_find(&tree->map, node) == 0);
+             node = ast->next(node)) {
+                if (nodec == alloc) {
+                        alloc += 64;
+                        newv = realloc(nodev, alloc * sizeof(void *));
+                        if (newv == NULL) {
+                                free(nodev);
+                                wbuf->err = true;
+                                return;
+                        }
+                        nodev = newv;
+                }
+                nodev[nodec++] = node;
+        }
+
+        while ((nodec > 0) && !wbuf->err) {
+                node = nodev[--nodec];
+
+                child = ast->getnode(node);
+                if (child != NULL) {
+                        irs_write_list(wbuf, tree, child);
+                }
+
+                /* the child walk may have reached a shared node */
+                if (irs_map_find(&tree->map, node) == 0) {
+                        irs_write_node(wbuf, tree, node);
+                }
+        }
+
+        free(nodev);
+}
+
+/**
+ * write every node of an abstract syntax tree
+ */
+static void
+irs_write_tree(struct irs_wbuf *wbuf, struct irs_tree *tree, void *root)
+{
+        size_t countpos;
+
+        /* the node count is filled in once it is known */
+        countpos = wbuf->len;
+        irs_write_u32(wbuf, 0);
+
+        irs_write_list(wbuf, tree, root);
+
+        if (!wbuf->err) {
+                struct irs_wbuf count = { wbuf->data + countpos, 0, 4, false };
+
+                irs_write_u32(&count, tree->nodec);
+        }
+}
+
+static void
+irs_write_arguments(struct irs_wbuf *wbuf,
+                    struct irs_tree *webidl,
+                    int argumentc,
+                    struct ir_operation_argument_entry *argumentv)
+{
+        int idx;
+
+        irs_write_i32(wbuf, argumentc);
+        for (idx = 0; idx < argumentc; idx++) {
+                irs_write_text(wbuf, argumentv[idx].name);
+                irs_write_i32(wbuf, argumentv[idx].optionalc);
+                irs_write_i32(wbuf, argumentv[idx].elipsisc);
+                irs_write_ref(wbuf, webidl, argumentv[idx].node);
+        }
+}
+
+static void
+irs_write_interface(struct irs_wbuf *wbuf,
+                    struct irs_tree *webidl,
+                    struct irs_tree *genbind,
+                    struct ir_interface_entry *interfacee)
+{
+        int idx;
+        int sidx;
+
+        irs_write_u8(wbuf, interfacee->noobject);
+        irs_write_u8(wbuf, interfacee->primary_global);
+
+        irs_write_i32(wbuf, interfacee->operationc);
+        for (idx = 0; idx < interfacee->operationc; idx++) {
+                struct ir_operation_entry *operatione;
+
+                operatione = interfacee->operationv + idx;
+                irs_write_text(wbuf, operatione->name);
+                irs_write_ref(wbuf, webidl, operatione->node);
+                irs_write_ref(wbuf, genbind, operatione->method);
+
+                irs_write_i32(wbuf, operatione->overloadc);
+                for (sidx = 0; sidx < operatione->overloadc; sidx++) {
+                        struct ir_operation_overload_entry *overloade;
+
+                        overloade = operatione->overloadv + sidx;
+                        irs_write_ref(wbuf, webidl, overloade->type);
+                        irs_write_i32(wbuf, overloade->optionalc);
+                        irs_write_i32(wbuf, overloade->elipsisc);
+                        irs_write_arguments(wbuf,
+                                            webidl,
+                                            overloade->argumentc,
+                                            overloade->argumentv);
+                }
+        }
+
+        irs_write_i32(wbuf, interfacee->attributec);
+        for (idx = 0; idx < interfacee->attributec; idx++) {
+                struct ir_attribute_entry *attributee;
+
+                attributee = interfacee->attributev + idx;
+                irs_write_text(wbuf, attributee->name);
+                irs_write_ref(wbuf, webidl, attributee->node);
+
+                irs_write_i32(wbuf, attributee->typec);
+                for (sidx = 0; sidx < attributee->typec; sidx++) {
+                        struct ir_type_entry *typee;
+
+                        typee = attributee->typev + sidx;
+                        irs_write_u32(wbuf, typee->base);
+                        irs_write_u32(wbuf, typee->modifier);
+                        irs_write_u8(wbuf, typee->nullable);
+                        irs_write_text(wbuf, typee->name);
+                }
+
+                irs_write_u32(wbuf, attributee->modifier);
+                irs_write_text(wbuf, attributee->putforwards);
+                irs_write_text(wbuf, attributee->treatnullas);
+                irs_write_ref(wbuf, genbind, attributee->getter);
+                irs_write_ref(wbuf, genbind, attributee->setter);
+        }
+
+        irs_write_i32(wbuf, interfacee->constantc);
+        for (idx = 0; idx < interfacee->constantc; idx++) {
+                irs_write_text(wbuf, interfacee->constantv[idx].name);
+                irs_write_ref(wbuf, webidl, interfacee->constantv[idx].node);
+        }
+}
+
+/* exported interface documented in ir-serial.h */
+int ir_save(struct ir *ir, const char *fname)
+{
+        struct irs_wbuf wbuf = { NULL, 0, 0, false };
+        struct irs_tree webidl;
+        struct irs_tree genbind;
+        int idx;
+        int res;
+
+        memset(&webidl, 0, sizeof(webidl));
+        webidl.ast = &irs_webidl_ast;
+        memset(&genbind, 0, sizeof(genbind));
+        genbind.ast = &irs_genbind_ast;
+
+        irs_write(&wbuf, IRS_MAGIC, sizeof(IRS_MAGIC));
+        irs_write_u32(&wbuf, IRS_VERSION);
+
+        irs_write_tree(&wbuf, &webidl, ir->webidl);
+        irs_write_tree(&wbuf, &genbind, ir->genbind);
+
+        irs_write_ref(&wbuf, &webidl, ir->webidl);
+        irs_write_ref(&wbuf, &genbind, ir->genbind);
+        irs_write_ref(&wbuf, &genbind, ir->binding_node);
+
+        irs_write_i32(&wbuf, ir->entryc);
+        for (idx = 0; idx < ir->entryc; idx++) {
+                struct ir_entry *entry = ir->entries + idx;
+
+                irs_write_text(&wbuf, entry->name);
+                irs_write_ref(&wbuf, &webidl, entry->node);
+                irs_write_text(&wbuf, entry->inherit_name);
+                irs_write_ref(&wbuf, &genbind, entry->class);
+                irs_write_i32(&wbuf, entry->inherit_idx);
+                irs_write_i32(&wbuf, entry->refcount);
+                irs_write_u32(&wbuf, entry->type);
+
+                switch (entry->type) {
+                case IR_ENTRY_TYPE_INTERFACE:
+                        irs_write_interface(&wbuf,
+                                            &webidl,
+                                            &genbind,
+                                            &entry->u.interface);
+                        break;
+
+                case IR_ENTRY_TYPE_DICTIONARY:
+                        irs_write_arguments(&wbuf,
+                                            &webidl,
+                                            entry->u.dictionary.memberc,
+                                            entry->u.dictionary.memberv);
+                        break;
+                }
+        }
+
+        irs_map_free(&webidl.map);
+        irs_map_free(&genbind.map);
+
+        if (wbuf.err) {
+                fprintf(stderr,
+                        "Error: unable to serialise intermediate representation\n");
+                free(wbuf.data);
+                return -1;
+        }
+
+        res = genb_fupdate(fname, wbuf.data, wbuf.len);
+        free(wbuf.data);
+
+        return res;
+}
+
+
+static const void *irs_read(struct irs_rbuf *rbuf, size_t len)
+{
+        const void *res;
+
+        if (rbuf->err || ((rbuf->len - rbuf->pos) < len)) {
+                rbuf->err = true;
+                return NULL;
+        }
+        res = rbuf->data + rbuf->pos;
+        rbuf->pos += len;
+        return res;
+}
+
+static uint8_t irs_read_u8(struct irs_rbuf *rbuf)
+{
+        const uint8_t *data;
+
+        data = irs_read(rbuf, 1);
+        if (data == NULL) {
+                return 0;
+        }
+        return *data;
+}
+
+static uint32_t irs_read_u32(struct irs_rbuf *rbuf)
+{
+        const uint8_t *data;
+
+        data = irs_read(rbuf, 4);
+        if (data == NULL) {
+                return 0;
+        }
+        return (uint32_t)data[0] |
+                ((uint32_t)data[1] << 8) |
+                ((uint32_t)data[2] << 16) |
+                ((uint32_t)data[3] << 24);
+}
+
+static int irs_read_i32(struct irs_rbuf *rbuf)
+{
+        return (int)irs_read_u32(rbuf);
+}
+
+/**
+ * read the number of elements in an array
+ *
+ * Every element takes at least one byte so a count larger than the
+ * remaining data is invalid.
+ */
+static int irs_read_count(struct irs_rbuf *rbuf)
+{
+        uint32_t count;
+
+        count = irs_read_u32(rbuf);
+        if (rbuf->err ||
+            (count > (rbuf->len - rbuf->pos)) ||
+            (count > INT32_MAX)) {
+                rbuf->err = true;
+                return 0;
+        }
+        return count;
+}
+
+static float irs_read_float(struct irs_rbuf *rbuf)
+{
+        uint32_t bits;
+        float value;
+
+        bits = irs_read_u32(rbuf);
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+}
+
+/**
+ * read text
+ *
+ * \return The interned text or NULL.
+ */
+static char *irs_read_text(struct irs_rbuf *rbuf)
+{
+        uint32_t len;
+        const char *data;
+
+        len = irs_read_u32(rbuf);
+        if (rbuf->err || (len == IRS_NULL_TEXT)) {
+                return NULL;
+        }
+        data = irs_read(rbuf, len);
+        if (data == NULL) {
+                return NULL;
+        }
+        return intern_nstring(data, len);
+}
+
+/**
+ * read a reference to a node already constructed
+ */
+static void *
+irs_read_ref(struct irs_rbuf *rbuf, void **nodev, uint32_t nodec)
+{
+        uint32_t ref;
+
+        ref = irs_read_u32(rbuf);
+        if (ref == 0) {
+                return NULL;
+        }
+        if (ref > nodec) {
+                rbuf->err = true;
+                return NULL;
+        }
+        return nodev[ref - 1];
+}
+
+/**
+ * read every node of an abstract syntax tree
+ *
+ * Each node must have a known type and the payload its type holds.
+ *
+ * \param rbuf The file content.
+ * \param ast The node constructors.
+ * \param nodev_out Updated with the constructed nodes in file order.
+ * \return The number of nodes.
+ */
+static uint32_t
+irs_read_tree(struct irs_rbuf *rbuf, const struct irs_ast *ast, void ***nodev_out)
+{
+        void **nodev;
+        uint32_t nodec;
+        uint32_t idx;
+        int type;
+        uint8_t payload;
+        char *text;
+        int number;
+        float flt;
+        void *child;
+        void *next;
+
+        *nodev_out = NULL;
+
+        nodec = irs_read_count(rbuf);
+        if (nodec == 0) {
+                return 0;
+        }
+
+        nodev = calloc(nodec, sizeof(void *));
+        if (nodev == NULL) {
+                rbuf->err = true;
+                return 0;
+        }
+
+        for (idx = 0; (idx < nodec) && !rbuf->err; idx++) {
+                type = irs_read_i32(rbuf);
+                payload = irs_read_u8(rbuf);
+                if ((type < 0) || (type >= ast->typec)) {
+                        rbuf->err = true;
+                        break;
+                }
+
+                switch (payload) {
+                case IRS_PAYLOAD_NONE:
+                        next = irs_read_ref(rbuf, nodev, idx);
+                        nodev[idx] = ast->new_node(type, next, NULL);
+                        break;
+
+                case IRS_PAYLOAD_TEXT:
+                        text = irs_read_text(rbuf);
+                        next = irs_read_ref(rbuf, nodev, idx);
+                        nodev[idx] = ast->new_node(type, next, text);
+                        break;
+
+                case IRS_PAYLOAD_INT:
+                        number = irs_read_i32(rbuf);
+                        next = irs_read_ref(rbuf, nodev, idx);
+                        nodev[idx] = ast->new_int(type, next, number);
+                        break;
+
+                case IRS_PAYLOAD_FLOAT:
+                        if (ast->new_float == NULL) {
+                                rbuf->err = true;
+                                break;
+                        }
+                        flt = irs_read_float(rbuf);
+                        next = irs_read_ref(rbuf, nodev, idx);
+                        nodev[idx] = ast->new_float(type, next, flt);
+                        break;
+
+                case IRS_PAYLOAD_LIST:
+                        child = irs_read_ref(rbuf, nodev, idx);
+                        next = irs_read_ref(rbuf, nodev, idx);
+                        nodev[idx] = ast->new_node(type, next, child);
+                        break;
+
+                default:
+                        rbuf->err = true;
+                        break;
+                }
+
+                /* the node accessors only return the payload of the
+                 * type so a mismatch is seen as a different payload
+                 */
+                if (!rbuf->err &&
+                    ((nodev[idx] == NULL) ||
+                     (irs_node_payload(ast, nodev[idx]) != payload))) {
+                        rbuf->err = true;
+                }
+        }
+
+        *nodev_out = nodev;
+        return nodec;
+}
+
+/**
+ * table of the constructed nodes of a tree
+ */
+struct irs_nodes {
+        void **nodev;
+        uint32_t nodec;
+};
+
+static int
+irs_read_arguments(struct irs_rbuf *rbuf,
+                   struct irs_nodes *webidl,
+                   struct ir_operation_argument_entry **argumentv_out)
+{
+        struct ir_operation_argument_entry *argumentv;
+        int argumentc;
+        int idx;
+
+        *argumentv_out = NULL;
+
+        argumentc = irs_read_count(rbuf);
+        if (argumentc == 0) {
+                return 0;
+        }
+
+        argumentv = calloc(argumentc, sizeof(*argumentv));
+        if (argumentv == NULL) {
+                rbuf->err = true;
+                return 0;
+        }
+
+        for (idx = 0; idx < argumentc; idx++) {
+                argumentv[idx].name = irs_read_text(rbuf);
+                argumentv[idx].optionalc = irs_read_i32(rbuf);
+                argumentv[idx].elipsisc = irs_read_i32(rbuf);
+                argumentv[idx].node = irs_read_ref(rbuf,
+                                                   webidl->nodev,
+                                                   webidl->nodec);
+        }
+
+        *argumentv_out = argumentv;
+        return argumentc;
+}
+
+static void
+irs_read_interface(struct irs_rbuf *rbuf,
+                   struct irs_nodes *webidl,
+                   struct irs_nodes *genbind,
+                   struct ir_interface_entry *interfacee)
+{
+        int idx;
+        int sidx;
+
+        interfacee->noobject = irs_read_u8(rbuf);
+        interfacee->primary_global = irs_read_u8(rbuf);
+
+        /* counts are only set once the array they describe exists */
+        idx = irs_read_count(rbuf);
+        if (idx > 0) {
+                interfacee->operationv = calloc(idx,
+                                        sizeof(struct ir_operation_entry));
+                if (interfacee->operationv == NULL) {
+                        rbuf->err = true;
+                        return;
+                }
+                interfacee->operationc = idx;
+        }
+        for (idx = 0; idx < interfacee->operationc; idx++) {
+                struct ir_operation_entry *operatione;
+
+                operatione = interfacee->operationv + idx;
+                operatione->name = irs_read_text(rbuf);
+                operatione->node = irs_read_ref(rbuf,
+                                                webidl->nodev,
+                                                webidl->nodec);
+                operatione->method = irs_read_ref(rbuf,
+                                                  genbind->nodev,
+                                                  genbind->nodec);
+
+                sidx = irs_read_count(rbuf);
+                if (sidx > 0) {
+                        operatione->overloadv = calloc(sidx,
+                                sizeof(struct ir_operation_overload_entry));
+                        if (operatione->overloadv == NULL) {
+                                rbuf->err = true;
+                                return;
+                        }
+                        operatione->overloadc = sidx;
+                }
+                for (sidx = 0; sidx < operatione->overloadc; sidx++) {
+                        struct ir_operation_overload_entry *overloade;
+
+                        overloade = operatione->overloadv + sidx;
+                        overloade->type = irs_read_ref(rbuf,
+                                                       webidl->nodev,
+                                                       webidl->nodec);
+                        overloade->optionalc = irs_read_i32(rbuf);
+                        overloade->elipsisc = irs_read_i32(rbuf);
+                        overloade->argumentc = irs_read_arguments(rbuf,
+                                                        webidl,
+                                                        &overloade->argumentv);
+                }
+        }
+
+        idx = irs_read_count(rbuf);
+        if (idx > 0) {
+                interfacee->attributev = calloc(idx,
+                                        sizeof(struct ir_attribute_entry));
+                if (interfacee->attributev == NULL) {
+                        rbuf->err = true;
+                        return;
+                }
+                interfacee->attributec = idx;
+        }
+        for (idx = 0; idx < interfacee->attributec; idx++) {
+                struct ir_attribute_entry *attributee;
+
+                attributee = interfacee->attributev + idx;
+                attributee->name = irs_read_text(rbuf);
+                attributee->node = irs_read_ref(rbuf,
+                                                webidl->nodev,
+                                                webidl->nodec);
+
+                sidx = irs_read_count(rbuf);
+                if (sidx > 0) {
+                        attributee->typev = calloc(sidx,
+                                                sizeof(struct ir_type_entry));
+                        if (attributee->typev == NULL) {
+                                rbuf->err = true;
+                                return;
+                        }
+                        attributee->typec = sidx;
+                }
+                for (sidx = 0; sidx < attributee->typec; sidx++) {
+                        struct ir_type_entry *typee;
+
+                        typee = attributee->typev + sidx;
+                        typee->base = irs_read_u32(rbuf);
+                        typee->modifier = irs_read_u32(rbuf);
+                        typee->nullable = irs_read_u8(rbuf);
+                        typee->name = irs_read_text(rbuf);
+                }
+
+                attributee->modifier = irs_read_u32(rbuf);
+                attributee->putforwards = irs_read_text(rbuf);
+                attributee->treatnullas = irs_read_text(rbuf);
+                attributee->getter = irs_read_ref(rbuf,
+                                                  genbind->nodev,
+                                                  genbind->nodec);
+                attributee->setter = irs_read_ref(rbuf,
+                                                  genbind->nodev,
+                                                  genbind->nodec);
+        }
+
+        idx = irs_read_count(rbuf);
+        if (idx > 0) {
+                interfacee->constantv = calloc(idx,
+                                        sizeof(struct ir_constant_entry));
+                if (interfacee->constantv == NULL) {
+                        rbuf->err = true;
+                        return;
+                }
+                interfacee->constantc = idx;
+        }
+        for (idx = 0; idx < interfacee->constantc; idx++) {
+                interfacee->constantv[idx].name = irs_read_text(rbuf);
+                interfacee->constantv[idx].node = irs_read_ref(rbuf,
+                                                        webidl->nodev,
+                                                        webidl->nodec);
+        }
+}
+
+/**
+ * read the intermediate representation from the file content
+ */
+static void irs_read_ir(struct irs_rbuf *rbuf, struct ir *ir)
+{
+        struct irs_nodes webidl;
+        struct irs_nodes genbind;
+        const char *magic;
+        int entryc;
+        int idx;
+
+        magic = irs_read(rbuf, sizeof(IRS_MAGIC));
+        if ((magic == NULL) ||
+            (memcmp(magic, IRS_MAGIC, sizeof(IRS_MAGIC)) != 0) ||
+            (irs_read_u32(rbuf) != IRS_VERSION)) {
+                rbuf->err = true;
+                return;
+        }
+
+        webidl.nodec = irs_read_tree(rbuf, &irs_webidl_ast, &webidl.nodev);
+        genbind.nodec = irs_read_tree(rbuf, &irs_genbind_ast, &genbind.nodev);
+
+        ir->webidl = irs_read_ref(rbuf, webidl.nodev, webidl.nodec);
+        ir->genbind = irs_read_ref(rbuf, genbind.nodev, genbind.nodec);
+        ir->binding_node = irs_read_ref(rbuf, genbind.nodev, genbind.nodec);
+
+        entryc = irs_read_count(rbuf);
+        if (entryc > 0) {
+                ir->entries = calloc(entryc, sizeof(struct ir_entry));
+                if (ir->entries == NULL) {
+                        rbuf->err = true;
+                }
+        }
+
+        for (idx = 0; (idx < entryc) && !rbuf->err; idx++) {
+                struct ir_entry *entry = ir->entries + idx;
+
+                ir->entryc++;
+
+                entry->name = irs_read_text(rbuf);
+                entry->node = irs_read_ref(rbuf, webidl.nodev, webidl.nodec);
+                entry->inherit_name = irs_read_text(rbuf);
+                entry->class = irs_read_ref(rbuf, genbind.nodev, genbind.nodec);
+                entry->inherit_idx = irs_read_i32(rbuf);
+                entry->refcount = irs_read_i32(rbuf);
+                entry->type = irs_read_u32(rbuf);
+
+                if ((entry->inherit_idx < -1) ||
+                    (entry->inherit_idx >= entryc)) {
+                        rbuf->err = true;
+                        break;
+                }
+
+                switch (entry->type) {
+                case IR_ENTRY_TYPE_INTERFACE:
+                        irs_read_interface(rbuf,
+                                           &webidl,
+                                           &genbind,
+                                           &entry->u.interface);
+                        break;
+
+                case IR_ENTRY_TYPE_DICTIONARY:
+                        entry->u.dictionary.memberc = irs_read_arguments(rbuf,
+                                        &webidl,
+                                        &entry->u.dictionary.memberv);
+                        break;
+
+                default:
+                        rbuf->err = true;
+                        break;
+                }
+        }
+
+        if (!rbuf->err && (rbuf->pos != rbuf->len)) {
+                /* trailing data */
+                rbuf->err = true;
+        }
+
+        if (!rbuf->err && (ir_check_inheritance(ir) != 0)) {
+                rbuf->err = true;
+        }
+
+        if (!rbuf->err && (ir_index_entries(ir) != 0)) {
+                rbuf->err = true;
+        }
+
+        free(webidl.nodev);
+        free(genbind.nodev);
+}
+
+/* exported interface documented in ir-serial.h */
+int ir_load(const char *fname, struct ir **ir_out)
+{
+        FILE *irf;
+        struct genb_mapped *input;
+        struct irs_rbuf rbuf;
+        struct ir *ir;
+
+        irf = fopen(fname, "r");
+        if (irf == NULL) {
+                fprintf(stderr, "Error opening %s: %s\n",
+                        fname, strerror(errno));
+                return -1;
+        }
+        input = genb_mapfile(irf);
+        fclose(irf);
+        if (input == NULL) {
+                fprintf(stderr, "Error reading %s: %s\n",
+                        fname, strerror(errno));
+                return -1;
+        }
+
+        ir = calloc(1, sizeof(struct ir));
+        if (ir == NULL) {
+                fprintf(stderr, "Allocation error\n");
+                genb_unmapfile(input);
+                return -1;
+        }
+
+        rbuf.data = input->data;
+        rbuf.len = input->size;
+        rbuf.pos = 0;
+        rbuf.err = false;
+
+        irs_read_ir(&rbuf, ir);
+
+        genb_unmapfile(input);
+
+        if (rbuf.err || (ir->binding_node == NULL)) {
+                fprintf(stderr,
+                        "Error: %s is not a valid intermediate representation\n",
+                        fname);
+                ir_free(ir);
+                return -1;
+        }
+
+        *ir_out = ir;
+
+        return 0;
+}
@@ -0,0 +1,44 @@
+/* intermediate representation serialisation
+ *
+ * This file is part of nsgenbind.
+ * Licensed under the MIT License,
+ *                http://www.opensource.org/licenses/mit-license.php
+ * Copyright 2026 agent <agent@local>
+ */
+
+#ifndef nsgenbind_ir_serial_h
+#define nsgenbind_ir_serial_h
+
+struct ir;
+
+/** leaf name of the serialised intermediate representation */
+#define IR_SERIAL_FILENAME "nsgenbind.ir"
+
+/**
+ * write an intermediate representation to a file in the output directory
+ *
+ * The file holds the map along with the Web IDL and binding abstract
+ * syntax trees it refers to so a backend can generate output from it
+ * alone. Values are stored little endian so the file may be shared
+ * between hosts. The file is only rewritten if its content changes.
+ *
+ * \param ir The intermediate representation to write.
+ * \param fname The leaf name of the file.
+ * \return 0 on success else -1 and an error message is printed.
+ */
+int ir_save(struct ir *ir, const char *fname);
+
+/**
+ * load an intermediate representation written by ir_save()
+ *
+ * The abstract syntax trees are allocated as if they had been parsed and
+ * are released by webidl_ast_free() and genbind_ast_free().
+ *
+ * \param fname The path of the file.
+ * \param ir_out Updated with the loaded intermediate representation
+ *               which must be released with ir_free().
+ * \return 0 on success else -1 and an error message is printed.
+ */
+int ir_load(const char *fname, struct ir **ir_out);
+
+#endif
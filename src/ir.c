@@ -8,6 +8,7 @@
 
 #include <stdbool.h>
 #include <stdio.h>
+#include <stdint.h>
 #include <errno.h>
 #include <string.h>
 #include <stdlib.h>
@@ -15,195 +16,618 @@
 
 #include "options.h"
 #include "utils.h"
+#include "intern.h"
+#include "nameindex.h"
 #include "nsgenbind-ast.h"
 #include "webidl-ast.h"
 #include "ir.h"
 
-/** count the number of nodes of a given type on an interface */
+/**
+ * find index of inherited node if it is one of those listed in the
+ * binding also maintain refcounts
+ *
+ * Entry names are interned so parents are found through an index keyed
+ * on the name pointer. When several entries share a name the lowest
+ * indexed one other than the inheriting entry itself is used.
+ *
+ * \return 0 on success or -1 on allocation failure.
+ */
 static int
-enumerate_interface_type(struct webidl_node *interface_node,
-                         enum webidl_node_type node_type)
+compute_inherit_refcount(struct ir_entry *entries, int entryc)
 {
-        int count = 0;
-        struct webidl_node *members_node;
+        struct nameindex *index;
+        struct ir_entry *first;
+        int *samenext; /* next higher index with the same name or -1 */
+        int idx;
+        int inf;
 
-        members_node = webidl_node_find_type(
-                webidl_node_getnode(interface_node),
-                NULL,
-                WEBIDL_NODE_TYPE_LIST);
-        while (members_node != NULL) {
-                count += webidl_node_enumerate_type(
-                        webidl_node_getnode(members_node),
-                        node_type);
+        index = nameindex_new();
+        samenext = calloc(entryc + 1, sizeof(int));
+        if ((index == NULL) || (samenext == NULL)) {
+                nameindex_free(index);
+                free(samenext);
+                return -1;
+        }
 
-                members_node = webidl_node_find_type(
-                        webidl_node_getnode(interface_node),
-                        members_node,
-                        WEBIDL_NODE_TYPE_LIST);
+        /* add in reverse so the index keeps the lowest entry of a name */
+        for (idx = entryc - 1; idx >= 0; idx--) {
+                samenext[idx] = -1;
+                if (entries[idx].name == NULL) {
+                        continue;
+                }
+                first = nameindex_find(index, 0, entries[idx].name);
+                if (first != NULL) {
+                        samenext[idx] = first - entries;
+                }
+                if (nameindex_add(index, 0, entries[idx].name,
+                                  entries + idx) != 0) {
+                        nameindex_free(index);
+                        free(samenext);
+                        return -1;
+                }
         }
 
-        return count;
+        for (idx = 0; idx < entryc; idx++) {
+                entries[idx].inherit_idx = -1;
+
+                first = nameindex_find(index, 0, entries[idx].inherit_name);
+                if (first == NULL) {
+                        continue;
+                }
+                inf = first - entries;
+
+                /* cannot inherit from self */
+                if (inf == idx) {
+                        inf = samenext[idx];
+                }
+                if (inf != -1) {
+                        entries[idx].inherit_idx = inf;
+                        entries[inf].refcount++;
+                }
+        }
+
+        nameindex_free(index);
+        free(samenext);
+
+        return 0;
 }
 
-/* find index of inherited node if it is one of those listed in the
- * binding also maintain refcounts
+/**
+ * add a source map index to the heap of entries ready to be sorted
+ */
+static void sort_heap_push(int *heap, int *heapc, int inf)
+{
+        int pos;
+        int parent;
+
+        pos = (*heapc)++;
+        while (pos > 0) {
+                parent = (pos - 1) / 2;
+                if (heap[parent] <= inf) {
+                        break;
+                }
+                heap[pos] = heap[parent];
+                pos = parent;
+        }
+        heap[pos] = inf;
+}
+
+/**
+ * remove the lowest source map index from the heap of ready entries
+ */
+static int sort_heap_pop(int *heap, int *heapc)
+{
+        int res;
+        int last;
+        int pos;
+        int child;
+
+        res = heap[0];
+        last = heap[--(*heapc)];
+
+        pos = 0;
+        for (;;) {
+                child = (pos * 2) + 1;
+                if (child >= *heapc) {
+                        break;
+                }
+                if ((child + 1 < *heapc) && (heap[child + 1] < heap[child])) {
+                        child++;
+                }
+                if (last <= heap[child]) {
+                        break;
+                }
+                heap[pos] = heap[child];
+                pos = child;
+        }
+        heap[pos] = last;
+
+        return res;
+}
+
+/**
+ * report the inheritance cycles left in a map that could not be sorted
+ *
+ * Every entry left unplaced is part of a cycle as each entry has at most
+ * one parent.
  */
 static void
-compute_inherit_refcount(struct ir_entry *entries, int entryc)
+report_inherit_cycles(const struct ir_entry *srcinf, int infc, int *dstidx)
 {
         int idx;
         int inf;
 
-        for (idx = 0; idx < entryc; idx++ ) {
-                entries[idx].inherit_idx = -1;
-                for (inf = 0; inf < entryc; inf++ ) {
-                        /* cannot inherit from self and name must match */
-                        if ((inf != idx) &&
-                            (entries[idx].inherit_name != NULL ) &&
-                            (strcmp(entries[idx].inherit_name,
-                                    entries[inf].name) == 0)) {
-                                entries[idx].inherit_idx = inf;
-                                entries[inf].refcount++;
-                                break;
+        for (idx = 0; idx < infc; idx++) {
+                if (dstidx[idx] != -1) {
+                        continue;
+                }
+
+                genb_diagf("Error: inheritance cycle: %s", srcinf[idx].name);
+                dstidx[idx] = -2;
+
+                inf = srcinf[idx].inherit_idx;
+                while ((inf != -1) && (dstidx[inf] == -1)) {
+                        genb_diagf(" -> %s", srcinf[inf].name);
+                        dstidx[inf] = -2;
+                        inf = srcinf[inf].inherit_idx;
+                }
+                if (inf != -1) {
+                        genb_diagf(" -> %s", srcinf[inf].name);
+                }
+                genb_diagf("\n");
+        }
+}
+
+/**
+ * order entries so each follows every entry which inherits from it
+ *
+ * Kahn's algorithm, entries no other entry inherits from are ready and
+ * are placed from the end of the output map backwards. Placing an entry
+ * reduces the count of children of its parent which becomes ready once
+ * it reaches zero.
+ *
+ * The ready entries are kept in a heap ordered on their source index so
+ * the first ready entry in the source map is always the one placed.
+ *
+ * The children are counted from the inheritance indexes so the
+ * refcounts of the source map need not be valid.
+ *
+ * \param srcinf The source map.
+ * \param infc The number of entries in the source map.
+ * \param dstidx Updated with the output map index of each source entry.
+ * \return 0 on success else -1 on allocation failure or if the
+ *         inheritance has a cycle, which is reported.
+ */
+static int
+inherit_order(const struct ir_entry *srcinf, int infc, int *dstidx)
+{
+        int *heap; /* source indexes of entries ready to be placed */
+        int heapc = 0;
+        int *childc; /* number of unplaced entries inheriting from each */
+        int idx;
+        int inf;
+        int parent;
+
+        heap = calloc(infc + 1, sizeof(int));
+        childc = calloc(infc + 1, sizeof(int));
+        if ((heap == NULL) || (childc == NULL)) {
+                free(heap);
+                free(childc);
+                return -1;
+        }
+
+        for (inf = 0; inf < infc; inf++) {
+                if (srcinf[inf].inherit_idx != -1) {
+                        childc[srcinf[inf].inherit_idx]++;
+                }
+        }
+
+        for (inf = 0; inf < infc; inf++) {
+                dstidx[inf] = -1;
+                if (childc[inf] == 0) {
+                        sort_heap_push(heap, &heapc, inf);
+                }
+        }
+
+        for (idx = infc - 1; idx >= 0; idx--) {
+                if (heapc == 0) {
+                        /* remaining entries all have a child unplaced */
+                        report_inherit_cycles(srcinf, infc, dstidx);
+                        free(heap);
+                        free(childc);
+                        return -1;
+                }
+                inf = sort_heap_pop(heap, &heapc);
+                dstidx[inf] = idx;
+
+                parent = srcinf[inf].inherit_idx;
+                if (parent != -1) {
+                        childc[parent]--;
+                        if (childc[parent] == 0) {
+                                sort_heap_push(heap, &heapc, parent);
                         }
                 }
         }
+
+        free(heap);
+        free(childc);
+
+        return 0;
 }
 
-/** Topoligical sort based on the refcount
+/** Topoligical sort based on the inheritance
  *
- * do not need to consider loops as constructed graph is a acyclic
+ * The inheritance index and refcounts of the sorted map are computed
+ * from those of the source map.
  *
- * alloc a second copy of the map
- * repeat until all entries copied:
- *   walk source mapping until first entry with zero refcount
- *   put the entry  at the end of the output map
- *   reduce refcount on inherit index if !=-1
- *   remove entry from source map
+ * \return The sorted map or NULL on error.
  */
 static struct ir_entry *
 entry_topoligical_sort(struct ir_entry *srcinf, int infc)
 {
         struct ir_entry *dstinf;
+        int *dstidx; /* output map index of each source entry */
         int idx;
         int inf;
 
-        dstinf = calloc(infc, sizeof(struct ir_entry));
-        if (dstinf == NULL) {
+        dstinf = calloc(infc + 1, sizeof(struct ir_entry));
+        dstidx = calloc(infc + 1, sizeof(int));
+        if ((dstinf == NULL) || (dstidx == NULL) ||
+            (inherit_order(srcinf, infc, dstidx) != 0)) {
+                free(dstinf);
+                free(dstidx);
                 return NULL;
         }
 
-        for (idx = infc - 1; idx >= 0; idx--) {
-                /* walk source map until first valid entry with zero refcount */
-                inf = 0;
-                while ((inf < infc) &&
-                       ((srcinf[inf].name == NULL) ||
-                        (srcinf[inf].refcount > 0))) {
-                        inf++;
-                }
-                if (inf == infc) {
-                        free(dstinf);
-                        return NULL;
-                }
-
-                /* copy entry to the end of the output map */
+        /* copy each entry to its place in the output map */
+        for (inf = 0; inf < infc; inf++) {
+                idx = dstidx[inf];
                 dstinf[idx].name = srcinf[inf].name;
                 dstinf[idx].node = srcinf[inf].node;
                 dstinf[idx].inherit_name = srcinf[inf].inherit_name;
                 dstinf[idx].class = srcinf[inf].class;
                 dstinf[idx].type = srcinf[inf].type;
                 dstinf[idx].u = srcinf[inf].u;
+        }
 
-                /* reduce refcount on inherit index if !=-1 */
+        /* map inheritance onto the sorted entries */
+        for (inf = 0; inf < infc; inf++) {
+                idx = dstidx[inf];
+                dstinf[idx].inherit_idx = -1;
                 if (srcinf[inf].inherit_idx != -1) {
-                        srcinf[srcinf[inf].inherit_idx].refcount--;
+                        dstinf[idx].inherit_idx =
+                                dstidx[srcinf[inf].inherit_idx];
+                        dstinf[dstinf[idx].inherit_idx].refcount++;
                 }
-
-                /* remove entry from source map */
-                srcinf[inf].name = NULL;
         }
 
+        free(dstidx);
+
         return dstinf;
 }
 
-static struct ir_operation_entry *
-find_operation_name(struct ir_operation_entry *operationv,
-                     int operationc,
-                     const char *name)
+/* exported interface documented in ir.h */
+int ir_check_inheritance(struct ir *map)
 {
-        struct ir_operation_entry *cure;
-        int opc;
-
-        for (opc = 0; opc < operationc; opc++) {
-                cure = operationv + opc;
-
-                if (cure->name == name) {
-                        /* check pointers for equivalence */
-                        return cure;
-                } else {
-                        if ((cure->name != NULL) &&
-                            (name != NULL) &&
-                            (strcmp(cure->name, name) == 0)) {
-                                return cure;
-                        }
+        int *dstidx;
+        int res;
+
+        dstidx = calloc(map->entryc + 1, sizeof(int));
+        if (dstidx == NULL) {
+                return -1;
+        }
+        res = inherit_order(map->entries, map->entryc, dstidx);
+        free(dstidx);
+
+        return res;
+}
+
+/** number of entries first allocated for a growable array */
+#define IR_ARRAY_INITIAL 8
+
+/**
+ * ensure a growable array has space for another entry
+ *
+ * The array is doubled when full and entries gained are zeroed.
+ *
+ * \param arrayv The array.
+ * \param arrayc The number of entries in use.
+ * \param allocc The number of entries allocated, updated when grown.
+ * \param size The size of an entry.
+ * \return The array, which may have moved, or NULL on allocation failure.
+ */
+static void *
+array_reserve(void *arrayv, int arrayc, int *allocc, size_t size)
+{
+        void *newv;
+        int alloc;
+
+        if (arrayc < *allocc) {
+                return arrayv;
+        }
+
+        alloc = (*allocc == 0) ? IR_ARRAY_INITIAL : *allocc * 2;
+        newv = realloc(arrayv, alloc * size);
+        if (newv == NULL) {
+                return NULL;
+        }
+        memset((char *)newv + (*allocc * size), 0, (alloc - *allocc) * size);
+        *allocc = alloc;
+
+        return newv;
+}
+
+/**
+ * interned extended attribute keys looked up while mapping members
+ */
+struct extended_keys {
+        const char *putforwards;
+        const char *treatnullas;
+};
+
+/**
+ * the parts of a member used by the intermediate representation
+ *
+ * A member's child list is newest first so where a part occurs more than
+ * once the one nearest the list tail is kept, which is the node
+ * webidl_node_find_type() would have returned.
+ */
+struct member_parts {
+        struct webidl_node *ident; /**< identifier */
+        struct webidl_node *type; /**< type (operation return type) */
+        struct webidl_node *list; /**< argument list */
+        struct webidl_node *modifier; /**< modifier */
+        int optionalc; /**< number of optional markers */
+        int elipsisc; /**< number of elipsis markers */
+        const char *putforwards; /**< PutForwards extended attribute value */
+        const char *treatnullas; /**< TreatNullAs extended attribute value */
+};
+
+/**
+ * get the value of an extended attribute key/value item
+ *
+ * \param ext_attr The extended attribute node.
+ * \param key The interned key.
+ * \return The value if the attribute is of the form key=value else NULL.
+ */
+static char *
+get_extended_value(struct webidl_node *ext_attr, const char *key)
+{
+        char *ident;
+        struct webidl_node *elem;
+
+        elem = webidl_node_find_type(webidl_node_getnode(ext_attr),
+                                     NULL,
+                                     WEBIDL_NODE_TYPE_IDENT);
+        ident = webidl_node_gettext(elem);
+        if ((key == NULL) || (ident != key)) {
+                return NULL;
+        }
+
+        /* first identifier matches */
+        elem = webidl_node_find_type(webidl_node_getnode(ext_attr),
+                                     elem,
+                                     WEBIDL_NODE_TYPE_IDENT);
+        ident = webidl_node_gettext(elem);
+        if ((ident == NULL) || (*ident != '=')) {
+                return NULL;
+        }
+
+        return webidl_node_gettext(
+                webidl_node_find_type(webidl_node_getnode(ext_attr),
+                                      elem,
+                                      WEBIDL_NODE_TYPE_IDENT));
+}
+
+/**
+ * fill a type entry from a type node in one walk of its children
+ */
+static void type_entry_fill(struct webidl_node *type_node,
+                            struct ir_type_entry *typee)
+{
+        struct webidl_node *node;
+        enum webidl_type *base = NULL;
+        enum webidl_type_modifier *modifier = NULL;
+        char *name = NULL;
+        bool nullable = false;
+
+        for (node = webidl_node_getnode(type_node);
+             node != NULL;
+             node = webidl_node_next(node)) {
+                switch (webidl_node_gettype(node)) {
+                case WEBIDL_NODE_TYPE_TYPE_BASE:
+                        base = (enum webidl_type *)webidl_node_getint(node);
+                        break;
+
+                case WEBIDL_NODE_TYPE_MODIFIER:
+                        modifier = (enum webidl_type_modifier *)
+                                webidl_node_getint(node);
+                        break;
+
+                case WEBIDL_NODE_TYPE_TYPE_NULLABLE:
+                        nullable = true;
+                        break;
+
+                case WEBIDL_NODE_TYPE_IDENT:
+                        name = webidl_node_gettext(node);
+                        break;
+
+                default:
+                        break;
                 }
         }
 
-        return NULL;
+        if (base != NULL) {
+                typee->base = *base;
+        }
+        if (modifier != NULL) {
+                typee->modifier = *modifier;
+        } else {
+                typee->modifier = WEBIDL_TYPE_MODIFIER_NONE;
+        }
+        typee->nullable = nullable;
+        typee->name = name;
 }
 
+/**
+ * collect the parts of a member in one walk of its children
+ *
+ * \param member The member node.
+ * \param keys The extended attribute keys or NULL if not required.
+ * \param typec_out Updated with the number of types or NULL if the
+ *                  types are not required.
+ * \param typev_out Updated with the types in source order.
+ * \param parts Updated with the member parts.
+ * \return 0 on success or -1 on allocation failure.
+ */
 static int
-argument_map_new(struct webidl_node *arg_list_node,
-                 int *argumentc_out,
-                 struct ir_operation_argument_entry **argumentv_out)
+member_parts_get(struct webidl_node *member,
+                 const struct extended_keys *keys,
+                 int *typec_out,
+                 struct ir_type_entry **typev_out,
+                 struct member_parts *parts)
 {
-        int argumentc;
-        struct webidl_node *argument;
-        struct ir_operation_argument_entry *argumentv;
-        struct ir_operation_argument_entry *cure;
-
-        argumentc = webidl_node_enumerate_type(
-                            webidl_node_getnode(arg_list_node),
-                            WEBIDL_NODE_TYPE_ARGUMENT);
-        if (argumentc == 0) {
-                *argumentc_out = 0;
-                *argumentv_out = NULL;
-                return 0;
+        struct webidl_node *node;
+        struct ir_type_entry *typev = NULL;
+        struct ir_type_entry *newv;
+        struct ir_type_entry swap;
+        int typec = 0;
+        int typea = 0;
+        int idx;
+        const char *value;
+
+        memset(parts, 0, sizeof(*parts));
+
+        for (node = webidl_node_getnode(member);
+             node != NULL;
+             node = webidl_node_next(node)) {
+                switch (webidl_node_gettype(node)) {
+                case WEBIDL_NODE_TYPE_IDENT:
+                        parts->ident = node;
+                        break;
+
+                case WEBIDL_NODE_TYPE_TYPE:
+                        parts->type = node;
+                        if (typec_out == NULL) {
+                                break;
+                        }
+                        newv = array_reserve(typev, typec, &typea,
+                                             sizeof(*typev));
+                        if (newv == NULL) {
+                                free(typev);
+                                return -1;
+                        }
+                        typev = newv;
+                        type_entry_fill(node, typev + typec);
+                        typec++;
+                        break;
+
+                case WEBIDL_NODE_TYPE_LIST:
+                        parts->list = node;
+                        break;
+
+                case WEBIDL_NODE_TYPE_MODIFIER:
+                        parts->modifier = node;
+                        break;
+
+                case WEBIDL_NODE_TYPE_OPTIONAL:
+                        parts->optionalc++;
+                        break;
+
+                case WEBIDL_NODE_TYPE_ELLIPSIS:
+                        parts->elipsisc++;
+                        break;
+
+                case WEBIDL_NODE_TYPE_EXTENDED_ATTRIBUTE:
+                        if (keys == NULL) {
+                                break;
+                        }
+                        value = get_extended_value(node, keys->putforwards);
+                        if (value != NULL) {
+                                parts->putforwards = value;
+                        }
+                        value = get_extended_value(node, keys->treatnullas);
+                        if (value != NULL) {
+                                parts->treatnullas = value;
+                        }
+                        break;
+
+                default:
+                        break;
+                }
         }
 
-        argumentv = calloc(argumentc, sizeof(*argumentv));
-        cure = argumentv;
+        if (typec_out != NULL) {
+                /* types were gathered newest first */
+                for (idx = 0; idx < (typec / 2); idx++) {
+                        swap = typev[idx];
+                        typev[idx] = typev[typec - 1 - idx];
+                        typev[typec - 1 - idx] = swap;
+                }
+                *typec_out = typec;
+                *typev_out = typev;
+        }
 
-        /* iterate each argument node within the list */
-        argument = webidl_node_find_type(webidl_node_getnode(arg_list_node),
-                                         NULL,
-                                         WEBIDL_NODE_TYPE_ARGUMENT);
+        return 0;
+}
 
-        while (argument != NULL) {
+/**
+ * fill an argument entry from an argument node
+ */
+static void
+argument_entry_fill(struct webidl_node *argument,
+                    struct ir_operation_argument_entry *argumente)
+{
+        struct member_parts parts;
 
-                cure->name = webidl_node_gettext(
-                                webidl_node_find_type(
-                                        webidl_node_getnode(argument),
-                                        NULL,
-                                        WEBIDL_NODE_TYPE_IDENT));
+        member_parts_get(argument, NULL, NULL, NULL, &parts);
 
-                cure->node = argument;
+        argumente->name = webidl_node_gettext(parts.ident);
+        argumente->node = argument;
+        argumente->optionalc = parts.optionalc;
+        argumente->elipsisc = parts.elipsisc;
+}
 
-                cure->optionalc = webidl_node_enumerate_type(
-                        webidl_node_getnode(argument),
-                        WEBIDL_NODE_TYPE_OPTIONAL);
+/**
+ * create the argument entries of a list
+ *
+ * \param list_node The list node containing the arguments.
+ * \param argumentc_out Updated with the number of arguments.
+ * \param argumentv_out Updated with the arguments.
+ * \return 0 on success or -1 on allocation failure.
+ */
+static int
+argument_map_new(struct webidl_node *list_node,
+                 int *argumentc_out,
+                 struct ir_operation_argument_entry **argumentv_out)
+{
+        struct webidl_node_iter argument_it;
+        struct webidl_node *argument;
+        struct ir_operation_argument_entry *argumentv = NULL;
+        struct ir_operation_argument_entry *newv;
+        int argumentc = 0;
+        int argumenta = 0;
 
-                cure->elipsisc = webidl_node_enumerate_type(
-                        webidl_node_getnode(argument),
-                        WEBIDL_NODE_TYPE_ELLIPSIS);
+        webidl_node_iter_init(&argument_it, webidl_node_getnode(list_node));
+        argument = webidl_node_iter_next(&argument_it,
+                                         WEBIDL_NODE_TYPE_ARGUMENT);
+        while (argument != NULL) {
+                newv = array_reserve(argumentv, argumentc, &argumenta,
+                                     sizeof(*argumentv));
+                if (newv == NULL) {
+                        webidl_node_iter_fini(&argument_it);
+                        free(argumentv);
+                        return -1;
+                }
+                argumentv = newv;
 
-                cure++;
+                argument_entry_fill(argument, argumentv + argumentc);
+                argumentc++;
 
-                argument = webidl_node_find_type(
-                        webidl_node_getnode(arg_list_node),
-                        argument,
-                        WEBIDL_NODE_TYPE_ARGUMENT);
+                argument = webidl_node_iter_next(&argument_it,
+                                                 WEBIDL_NODE_TYPE_ARGUMENT);
         }
+        webidl_node_iter_fini(&argument_it);
 
         *argumentc_out = argumentc;
         *argumentv_out = argumentv;
@@ -212,21 +636,20 @@ argument_map_new(struct webidl_node *arg_list_node,
 }
 
 /**
- * create a new overloaded parameter set on an operation
+ * add an overloaded parameter set to an operation
  *
  * each operation can be overloaded with multiple function signatures. By
  * adding them to the operation as overloads duplicate operation enrtries is
  * avoided.
  */
 static int
-overload_map_new(struct webidl_node *op_node,
+overload_map_new(struct member_parts *parts,
                  int *overloadc_out,
                  struct ir_operation_overload_entry **overloadv_out)
 {
         int overloadc = *overloadc_out;
         struct ir_operation_overload_entry *overloadv;
         struct ir_operation_overload_entry *cure;
-        struct webidl_node *arg_list_node;
         int argc;
 
         /* update allocation */
@@ -235,557 +658,438 @@ overload_map_new(struct webidl_node *op_node,
         if (overloadv == NULL) {
                 return -1;
         }
+        *overloadv_out = overloadv;
 
         /* get added entry */
         cure = overloadv + (overloadc - 1);
-
-        /* clear entry */
-        cure = memset(cure, 0, sizeof(*cure));
+        memset(cure, 0, sizeof(*cure));
 
         /* return type */
-        cure->type = webidl_node_find_type(webidl_node_getnode(op_node),
-                                           NULL,
-                                           WEBIDL_NODE_TYPE_TYPE);
+        cure->type = parts->type;
 
-        arg_list_node = webidl_node_find_type(webidl_node_getnode(op_node),
-                                              NULL,
-                                              WEBIDL_NODE_TYPE_LIST);
-        if (arg_list_node != NULL) {
-                argument_map_new(arg_list_node,
-                                 &cure->argumentc,
-                                 &cure->argumentv);
+        if (parts->list != NULL) {
+                if (argument_map_new(parts->list,
+                                     &cure->argumentc,
+                                     &cure->argumentv) != 0) {
+                        return -1;
+                }
         }
 
         for (argc = 0; argc < cure->argumentc; argc++) {
-                struct ir_operation_argument_entry *arge;
-                arge = cure->argumentv + argc;
-                cure->optionalc += arge->optionalc;
-                cure->elipsisc += arge->elipsisc;
+                cure->optionalc += cure->argumentv[argc].optionalc;
+                cure->elipsisc += cure->argumentv[argc].elipsisc;
         }
 
-        /* return entry list */
         *overloadc_out = overloadc;
-        *overloadv_out = overloadv;
 
         return 0;
 }
 
+/**
+ * index the methods of a binding class by method type and identifier
+ *
+ * The class list is walked once and the method nearest its tail kept for
+ * each type and identifier as genbind_node_find_method_ident() would find.
+ *
+ * \param class The binding class or NULL.
+ * \param index_out Updated with the index or NULL if there is no class.
+ * \return 0 on success or -1 on allocation failure.
+ */
 static int
-operation_map_new(struct webidl_node *interface,
-                  struct genbind_node *class,
-                  int *operationc_out,
-                  struct ir_operation_entry **operationv_out)
+method_index_new(struct genbind_node *class, struct nameindex **index_out)
 {
-        struct webidl_node *list_node;
-        struct webidl_node *op_node; /* attribute node */
-        struct ir_operation_entry *cure; /* current entry */
-        struct ir_operation_entry *operationv;
-        int operationc;
-
-        /* enumerate operationss including overloaded members */
-        operationc = enumerate_interface_type(interface,
-                                              WEBIDL_NODE_TYPE_OPERATION);
-
-        if (operationc < 1) {
-                /* no operations so empty map */
-                *operationc_out = 0;
-                *operationv_out = NULL;
+        struct nameindex *index;
+        struct genbind_node *node;
+        int *method_type;
+        char *ident;
+
+        *index_out = NULL;
+        if (class == NULL) {
                 return 0;
         }
 
-        operationv = calloc(operationc,
-                            sizeof(struct ir_operation_entry));
-        if (operationv == NULL) {
+        index = nameindex_new();
+        if (index == NULL) {
                 return -1;
-        };
-        cure = operationv;
-
-        /* iterate each list node within the interface */
-        list_node = webidl_node_find_type(
-                webidl_node_getnode(interface),
-                NULL,
-                WEBIDL_NODE_TYPE_LIST);
-
-        while (list_node != NULL) {
-                /* iterate through operations on list */
-                op_node = webidl_node_find_type(
-                        webidl_node_getnode(list_node),
-                        NULL,
-                        WEBIDL_NODE_TYPE_OPERATION);
-
-                while (op_node != NULL) {
-                        const char *operation_name;
-                        struct ir_operation_entry *finde;
-
-                        /* get operation name */
-                        operation_name = webidl_node_gettext(
-                                webidl_node_find_type(
-                                        webidl_node_getnode(op_node),
-                                        NULL,
-                                        WEBIDL_NODE_TYPE_IDENT));
-                        /* if this operation is already an entry in the list
-                         * augment that entry else create a new one
-                         */
-                        finde = find_operation_name(operationv,
-                                                    operationc,
-                                                    operation_name);
-                        if (finde == NULL) {
-                                /* operation does not already exist in list */
-
-                                cure->name = operation_name;
-
-                                cure->node = op_node;
-
-                                cure->method = genbind_node_find_method_ident(
-                                               class,
-                                               NULL,
-                                               GENBIND_METHOD_TYPE_METHOD,
-                                               cure->name);
-
-                                overload_map_new(op_node,
-                                                 &cure->overloadc,
-                                                 &cure->overloadv);
+        }
 
-                                cure++; /* advance to next entry */
-                        } else {
-                                overload_map_new(op_node,
-                                                 &finde->overloadc,
-                                                 &finde->overloadv);
-                                /* Overloaded entry does not advance the
-                                 * current entry but does reduce list
-                                 * length. Do not bother shortening allocation.
-                                 */
-                                operationc--;
-                        }
+        for (node = genbind_node_getnode(class);
+             node != NULL;
+             node = genbind_node_next(node)) {
+                if (genbind_node_gettype(node) != GENBIND_NODE_TYPE_METHOD) {
+                        continue;
+                }
 
-                        /* move to next operation */
-                        op_node = webidl_node_find_type(
-                                webidl_node_getnode(list_node),
-                                op_node,
-                                WEBIDL_NODE_TYPE_OPERATION);
+                method_type = genbind_node_getint(
+                        genbind_node_find_type(
+                                genbind_node_getnode(node),
+                                NULL,
+                                GENBIND_NODE_TYPE_METHOD_TYPE));
+                ident = genbind_node_gettext(
+                        genbind_node_find_type(
+                                genbind_node_getnode(node),
+                                NULL,
+                                GENBIND_NODE_TYPE_IDENT));
+                if ((method_type == NULL) || (ident == NULL)) {
+                        continue;
                 }
 
-                list_node = webidl_node_find_type(
-                        webidl_node_getnode(interface),
-                        list_node,
-                        WEBIDL_NODE_TYPE_LIST);
+                if (nameindex_add(index, *method_type, ident, node) != 0) {
+                        nameindex_free(index);
+                        return -1;
+                }
         }
 
-        *operationc_out = operationc;
-        *operationv_out = operationv; /* resulting operations map */
+        *index_out = index;
 
         return 0;
 }
 
 /**
- * get the value of an extended attribute key/value item
+ * find a binding method for a member
  */
-static char *
-get_extended_value(struct webidl_node *node, const char *key)
+static struct genbind_node *
+method_index_find(struct nameindex *index,
+                  enum genbind_method_type method_type,
+                  const char *name)
 {
-        char *ident;
-        struct webidl_node *ext_attr;
-        struct webidl_node *elem;
-
-        /* walk each extended attribute */
-        ext_attr = webidl_node_find_type(
-                webidl_node_getnode(node),
-                NULL,
-                WEBIDL_NODE_TYPE_EXTENDED_ATTRIBUTE);
-        while (ext_attr != NULL) {
-
-                elem = webidl_node_find_type(
-                        webidl_node_getnode(ext_attr),
-                        NULL,
-                        WEBIDL_NODE_TYPE_IDENT);
-                ident = webidl_node_gettext(elem);
-
-                if ((ident != NULL) && (strcmp(ident, key) == 0)) {
-                        /* first identifier matches */
-
-                        elem = webidl_node_find_type(
-                                webidl_node_getnode(ext_attr),
-                                elem,
-                                WEBIDL_NODE_TYPE_IDENT);
-                        ident = webidl_node_gettext(elem);
-
-                        if ((ident != NULL) && (*ident == '=')) {
-                                return webidl_node_gettext(
-                                        webidl_node_find_type(
-                                                webidl_node_getnode(ext_attr),
-                                                elem,
-                                                WEBIDL_NODE_TYPE_IDENT));
-                        }
-                }
-
-                ext_attr = webidl_node_find_type(
-                        webidl_node_getnode(node),
-                        ext_attr,
-                        WEBIDL_NODE_TYPE_EXTENDED_ATTRIBUTE);
+        if ((index == NULL) || (name == NULL)) {
+                return NULL;
         }
-
-        return NULL;
+        return nameindex_find(index, method_type, name);
 }
 
+/**
+ * state of an interface map being built
+ */
+struct interface_builder {
+        struct ir_interface_entry *interfacee; /**< entry being filled */
+        struct nameindex *methods; /**< binding class methods */
+        struct extended_keys keys; /**< extended attribute keys */
+
+        /** operations by name for finding overloads */
+        struct nameindex *operations;
+
+        int operationa; /**< operations allocated */
+        int attributea; /**< attributes allocated */
+        int constanta; /**< constants allocated */
+
+        /**
+         * overloads of operations without an identifier
+         *
+         * These have always been added to the next operation created so
+         * are held until it is.
+         */
+        int pendingc;
+        struct ir_operation_overload_entry *pendingv;
+};
 
 /**
- * Create IR entry for a type
+ * map an operation as a new entry or an overload of an existing one
  */
 static int
-type_map_new(struct webidl_node *node,
-             int *typec_out,
-             struct ir_type_entry **typev_out)
+operation_map_new(struct interface_builder *builder,
+                  struct webidl_node *op_node)
 {
-        int typec;
-        struct webidl_node *type_node;
-        struct ir_type_entry *typev;
-        struct ir_type_entry *cure;
-
-        typec = webidl_node_enumerate_type(
-                            webidl_node_getnode(node),
-                            WEBIDL_NODE_TYPE_TYPE);
-        if (typec == 0) {
-                *typec_out = 0;
-                *typev_out = NULL;
-                return 0;
-        }
-
-        typev = calloc(typec, sizeof(*typev));
-        cure = typev;
-
-        type_node = webidl_node_find_type(webidl_node_getnode(node),
-                                          NULL,
-                                          WEBIDL_NODE_TYPE_TYPE);
-
-        while (type_node != NULL) {
-                enum webidl_type *base;
-                enum webidl_type_modifier *modifier;
-
-                /* type base */
-                base = (enum webidl_type *)webidl_node_getint(
-                        webidl_node_find_type(
-                                webidl_node_getnode(type_node),
-                                NULL,
-                                WEBIDL_NODE_TYPE_TYPE_BASE));
-                if (base != NULL) {
-                        cure->base = *base;
-                }
-
-                /* type modifier */
-                modifier = (enum webidl_type_modifier *)webidl_node_getint(
-                        webidl_node_find_type(
-                                webidl_node_getnode(type_node),
-                                NULL,
-                                WEBIDL_NODE_TYPE_MODIFIER));
-                if (modifier != NULL) {
-                        cure->modifier = *modifier;
-                } else {
-                        cure->modifier = WEBIDL_TYPE_MODIFIER_NONE;
-                }
+        struct ir_interface_entry *interfacee = builder->interfacee;
+        struct ir_operation_entry *newv;
+        struct ir_operation_entry *cure;
+        struct member_parts parts;
+        const char *name;
+        intptr_t opidx;
 
-                /* type nullability */
-                cure->nullable = (webidl_node_find_type(
-                        webidl_node_getnode(type_node),
-                        NULL,
-                        WEBIDL_NODE_TYPE_TYPE_NULLABLE) != NULL);
+        member_parts_get(op_node, NULL, NULL, NULL, &parts);
+        name = webidl_node_gettext(parts.ident);
 
-                /* type name */
-                cure->name = webidl_node_gettext(
-                        webidl_node_find_type(
-                                webidl_node_getnode(type_node),
-                                NULL,
-                                WEBIDL_NODE_TYPE_IDENT));
+        if (name == NULL) {
+                return overload_map_new(&parts,
+                                        &builder->pendingc,
+                                        &builder->pendingv);
+        }
 
-                /* next entry */
-                cure++;
+        /* if this operation is already an entry augment it */
+        opidx = (intptr_t)nameindex_find(builder->operations, 0, name);
+        if (opidx != 0) {
+                cure = interfacee->operationv + (opidx - 1);
+                return overload_map_new(&parts,
+                                        &cure->overloadc,
+                                        &cure->overloadv);
+        }
 
-                type_node = webidl_node_find_type(
-                        webidl_node_getnode(node),
-                        type_node,
-                        WEBIDL_NODE_TYPE_TYPE);
+        newv = array_reserve(interfacee->operationv,
+                             interfacee->operationc,
+                             &builder->operationa,
+                             sizeof(*newv));
+        if (newv == NULL) {
+                return -1;
+        }
+        interfacee->operationv = newv;
+        cure = newv + interfacee->operationc;
+        interfacee->operationc++;
+
+        /* the index holds the position as the array may move */
+        if (nameindex_add(builder->operations,
+                          0,
+                          name,
+                          (void *)(intptr_t)interfacee->operationc) != 0) {
+                return -1;
         }
 
-        *typec_out = typec;
-        *typev_out = typev;
+        cure->name = name;
+        cure->node = op_node;
+        cure->method = method_index_find(builder->methods,
+                                         GENBIND_METHOD_TYPE_METHOD,
+                                         name);
 
-        return 0;
+        cure->overloadc = builder->pendingc;
+        cure->overloadv = builder->pendingv;
+        builder->pendingc = 0;
+        builder->pendingv = NULL;
+
+        return overload_map_new(&parts, &cure->overloadc, &cure->overloadv);
 }
 
 /**
  * Create a new ir entry for an attribute
  */
 static int
-attribute_map_new(struct webidl_node *interface,
-                  struct genbind_node *class,
-                  int *attributec_out,
-                  struct ir_attribute_entry **attributev_out)
+attribute_map_new(struct interface_builder *builder,
+                  struct webidl_node *at_node)
 {
-        struct webidl_node *list_node;
-        struct webidl_node *at_node; /* attribute node */
-        struct ir_attribute_entry *cure; /* current entry */
-        struct ir_attribute_entry *attributev;
-        int attributec;
-
-        /* enumerate attributes */
-        attributec = enumerate_interface_type(interface,
-                                              WEBIDL_NODE_TYPE_ATTRIBUTE);
-        *attributec_out = attributec;
-
-        if (attributec < 1) {
-                *attributev_out = NULL; /* no attributes so empty map */
-                return 0;
+        struct ir_interface_entry *interfacee = builder->interfacee;
+        struct ir_attribute_entry *newv;
+        struct ir_attribute_entry *cure;
+        struct member_parts parts;
+        enum webidl_type_modifier *modifier;
+
+        newv = array_reserve(interfacee->attributev,
+                             interfacee->attributec,
+                             &builder->attributea,
+                             sizeof(*newv));
+        if (newv == NULL) {
+                return -1;
         }
-
-        attributev = calloc(attributec, sizeof(struct ir_attribute_entry));
-        if (attributev == NULL) {
+        interfacee->attributev = newv;
+        cure = newv + interfacee->attributec;
+        interfacee->attributec++;
+
+        if (member_parts_get(at_node,
+                             &builder->keys,
+                             &cure->typec,
+                             &cure->typev,
+                             &parts) != 0) {
                 return -1;
-        };
-        cure = attributev;
-
-        /* iterate each list node within the interface */
-        list_node = webidl_node_find_type(
-                webidl_node_getnode(interface),
-                NULL,
-                WEBIDL_NODE_TYPE_LIST);
-
-        while (list_node != NULL) {
-                /* iterate through attributes on list */
-                at_node = webidl_node_find_type(
-                        webidl_node_getnode(list_node),
-                        NULL,
-                        WEBIDL_NODE_TYPE_ATTRIBUTE);
-
-                while (at_node != NULL) {
-                        /* process attribute node into an entry */
-
-                        enum webidl_type_modifier *modifier;
-
-                        cure->node = at_node;
-
-                        cure->name = webidl_node_gettext(
-                                webidl_node_find_type(
-                                        webidl_node_getnode(at_node),
-                                        NULL,
-                                        WEBIDL_NODE_TYPE_IDENT));
-
-                        cure->getter = genbind_node_find_method_ident(
-                                               class,
-                                               NULL,
-                                               GENBIND_METHOD_TYPE_GETTER,
-                                               cure->name);
-
-                        /* create attribute type vector */
-                        type_map_new(at_node, &cure->typec, &cure->typev);
-
-
-                        /* get binding node for read/write attributes */
-                        modifier = (enum webidl_type_modifier *)webidl_node_getint(
-                                webidl_node_find_type(
-                                        webidl_node_getnode(at_node),
-                                        NULL,
-                                        WEBIDL_NODE_TYPE_MODIFIER));
-                        if ((modifier != NULL) &&
-                            (*modifier == WEBIDL_TYPE_MODIFIER_READONLY)) {
-                                cure->modifier = WEBIDL_TYPE_MODIFIER_READONLY;
-                        } else {
-                                cure->modifier = WEBIDL_TYPE_MODIFIER_NONE;
-                                cure->setter = genbind_node_find_method_ident(
-                                                     class,
-                                                     NULL,
-                                                     GENBIND_METHOD_TYPE_SETTER,
-                                                     cure->name);
-                        }
-
-                        /* check for putforwards extended attribute */
-                        cure->putforwards = get_extended_value(at_node,
-                                                               "PutForwards");
+        }
 
-                        if ((cure->putforwards != NULL) &&
-                            (cure->modifier != WEBIDL_TYPE_MODIFIER_READONLY)) {
-                                WARN(WARNING_WEBIDL,
-                                     "putforwards on a writable attribute (%s) is prohibited",
-                                     cure->name);
-                        }
+        cure->node = at_node;
+        cure->name = webidl_node_gettext(parts.ident);
+
+        cure->getter = method_index_find(builder->methods,
+                                         GENBIND_METHOD_TYPE_GETTER,
+                                         cure->name);
+
+        /* get binding node for read/write attributes */
+        modifier = (enum webidl_type_modifier *)webidl_node_getint(
+                parts.modifier);
+        if ((modifier != NULL) &&
+            (*modifier == WEBIDL_TYPE_MODIFIER_READONLY)) {
+                cure->modifier = WEBIDL_TYPE_MODIFIER_READONLY;
+        } else {
+                cure->modifier = WEBIDL_TYPE_MODIFIER_NONE;
+                cure->setter = method_index_find(builder->methods,
+                                                 GENBIND_METHOD_TYPE_SETTER,
+                                                 cure->name);
+        }
 
-                        /* check for treatnullas extended attribute */
-                        cure->treatnullas = get_extended_value(at_node,
-                                                               "TreatNullAs");
+        /* check for putforwards extended attribute */
+        cure->putforwards = parts.putforwards;
+        if ((cure->putforwards != NULL) &&
+            (cure->modifier != WEBIDL_TYPE_MODIFIER_READONLY)) {
+                WARN(WARNING_WEBIDL,
+                     "putforwards on a writable attribute (%s) is prohibited",
+                     cure->name);
+        }
 
-                        /* move to next attribute */
-                        cure++;
+        /* check for treatnullas extended attribute */
+        cure->treatnullas = parts.treatnullas;
 
-                        at_node = webidl_node_find_type(
-                                webidl_node_getnode(list_node),
-                                at_node,
-                                WEBIDL_NODE_TYPE_ATTRIBUTE);
-                }
+        return 0;
+}
 
-                list_node = webidl_node_find_type(
-                        webidl_node_getnode(interface),
-                        list_node,
-                        WEBIDL_NODE_TYPE_LIST);
+/**
+ * Create a new ir entry for a constant
+ */
+static int
+constant_map_new(struct interface_builder *builder,
+             struct webidl_node *constant_node)
+{
+        struct ir_interface_entry *interfacee = builder->interfacee;
+        struct ir_constant_entry *newv;
+        struct ir_constant_entry *cure;
+        struct member_parts parts;
+
+        newv = array_reserve(interfacee->constantv,
+                             interfacee->constantc,
+                             &builder->constanta,
+                             sizeof(*newv));
+        if (newv == NULL) {
+                return -1;
         }
+        interfacee->constantv = newv;
+        cure = newv + interfacee->constantc;
+        interfacee->constantc++;
+
+        member_parts_get(constant_node, NULL, NULL, NULL, &parts);
 
-        *attributev_out = attributev; /* resulting attributes map */
+        cure->node = constant_node;
+        cure->name = webidl_node_gettext(parts.ident);
 
         return 0;
 }
 
+/**
+ * map the operations, attributes and constants of an interface
+ *
+ * Every member list of the interface is walked once in source order and
+ * each member completely mapped when it is visited.
+ *
+ * \param interface The interface node.
+ * \param class The binding class of the interface or NULL.
+ * \param interfacee The interface entry to fill.
+ * \return 0 on success or -1 on allocation failure.
+ */
 static int
-constant_map_new(struct webidl_node *interface,
-                 int *constantc_out,
-                 struct ir_constant_entry **constantv_out)
+interface_map_new(struct webidl_node *interface,
+                  struct genbind_node *class,
+                  struct ir_interface_entry *interfacee)
 {
+        struct interface_builder builder;
+        struct webidl_node_iter list_it;
+        struct webidl_node_iter member_it;
         struct webidl_node *list_node;
-        struct webidl_node *constant_node; /* constant node */
-        struct ir_constant_entry *cure; /* current entry */
-        struct ir_constant_entry *constantv;
-        int constantc;
-
-        /* enumerate constants */
-        constantc = enumerate_interface_type(interface,
-                                              WEBIDL_NODE_TYPE_CONST);
-
-        if (constantc < 1) {
-                *constantc_out = 0;
-                *constantv_out = NULL; /* no constants so empty map */
-                return 0;
-        }
+        struct webidl_node *member;
+        int res = 0;
+        int idx;
 
-        *constantc_out = constantc;
+        memset(&builder, 0, sizeof(builder));
+        builder.interfacee = interfacee;
+        builder.keys.putforwards = intern_lookup("PutForwards");
+        builder.keys.treatnullas = intern_lookup("TreatNullAs");
 
-        constantv = calloc(constantc,
-                           sizeof(struct ir_constant_entry));
-        if (constantv == NULL) {
+        builder.operations = nameindex_new();
+        if ((builder.operations == NULL) ||
+            (method_index_new(class, &builder.methods) != 0)) {
+                nameindex_free(builder.operations);
                 return -1;
-        };
-        cure = constantv;
+        }
 
         /* iterate each list node within the interface */
-        list_node = webidl_node_find_type(
-                webidl_node_getnode(interface),
-                NULL,
-                WEBIDL_NODE_TYPE_LIST);
+        webidl_node_iter_init(&list_it, webidl_node_getnode(interface));
+        list_node = webidl_node_iter_next(&list_it, WEBIDL_NODE_TYPE_LIST);
+        while ((list_node != NULL) && (res == 0)) {
+                webidl_node_iter_init(&member_it,
+                                      webidl_node_getnode(list_node));
+                member = webidl_node_iter_next_any(&member_it);
+                while ((member != NULL) && (res == 0)) {
+                        switch (webidl_node_gettype(member)) {
+                        case WEBIDL_NODE_TYPE_OPERATION:
+                                res = operation_map_new(&builder, member);
+                                break;
 
-        while (list_node != NULL) {
-                /* iterate through constants on list */
-                constant_node = webidl_node_find_type(
-                        webidl_node_getnode(list_node),
-                        NULL,
-                        WEBIDL_NODE_TYPE_CONST);
-
-                while (constant_node != NULL) {
-                        cure->node = constant_node;
-
-                        cure->name = webidl_node_gettext(
-                                webidl_node_find_type(
-                                        webidl_node_getnode(constant_node),
-                                        NULL,
-                                        WEBIDL_NODE_TYPE_IDENT));
-
-                        cure++;
-
-                        /* move to next constant */
-                        constant_node = webidl_node_find_type(
-                                webidl_node_getnode(list_node),
-                                constant_node,
-                                WEBIDL_NODE_TYPE_CONST);
+                        case WEBIDL_NODE_TYPE_ATTRIBUTE:
+                                res = attribute_map_new(&builder, member);
+                                break;
+
+                        case WEBIDL_NODE_TYPE_CONST:
+                                res = constant_map_new(&builder, member);
+                                break;
+
+                        default:
+                                break;
+                        }
+                        member = webidl_node_iter_next_any(&member_it);
                 }
+                webidl_node_iter_fini(&member_it);
 
-                list_node = webidl_node_find_type(
-                        webidl_node_getnode(interface),
-                        list_node,
-                        WEBIDL_NODE_TYPE_LIST);
+                list_node = webidl_node_iter_next(&list_it,
+                                                  WEBIDL_NODE_TYPE_LIST);
         }
+        webidl_node_iter_fini(&list_it);
 
-        *constantv_out = constantv; /* resulting constants map */
+        /* overloads not followed by a named operation are dropped */
+        for (idx = 0; idx < builder.pendingc; idx++) {
+                free(builder.pendingv[idx].argumentv);
+        }
+        free(builder.pendingv);
 
-        return 0;
-}
+        nameindex_free(builder.operations);
+        nameindex_free(builder.methods);
 
+        return res;
+}
 
+/**
+ * map the members of a dictionary
+ *
+ * \param dictionary The dictionary node.
+ * \param memberc_out Updated with the number of members.
+ * \param memberv_out Updated with the members.
+ * \return 0 on success or -1 on allocation failure.
+ */
 static int
 member_map_new(struct webidl_node *dictionary,
                int *memberc_out,
                struct ir_operation_argument_entry **memberv_out)
 {
+        struct webidl_node_iter list_it;
+        struct webidl_node_iter member_it;
         struct webidl_node *list_node;
-        struct webidl_node *member_node; /* member node */
-        struct ir_operation_argument_entry *cure; /* current entry */
-        struct ir_operation_argument_entry *memberv;
-        int memberc;
-
-        /* enumerate members */
-        memberc = enumerate_interface_type(dictionary,
-                                           WEBIDL_NODE_TYPE_ARGUMENT);
-
-        if (memberc < 1) {
-                *memberc_out = 0;
-                *memberv_out = NULL; /* no members so empty map */
-                return 0;
-        }
-
-        memberv = calloc(memberc, sizeof(struct ir_operation_argument_entry));
-        if (memberv == NULL) {
-                return -1;
-        };
-        cure = memberv;
+        struct webidl_node *member_node;
+        struct ir_operation_argument_entry *memberv = NULL;
+        struct ir_operation_argument_entry *newv;
+        int memberc = 0;
+        int membera = 0;
 
         /* iterate each list node within the dictionary */
-        list_node = webidl_node_find_type(
-                webidl_node_getnode(dictionary),
-                NULL,
-                WEBIDL_NODE_TYPE_LIST);
-
+        webidl_node_iter_init(&list_it, webidl_node_getnode(dictionary));
+        list_node = webidl_node_iter_next(&list_it, WEBIDL_NODE_TYPE_LIST);
         while (list_node != NULL) {
-                /* iterate through members on list */
-                member_node = webidl_node_find_type(
-                        webidl_node_getnode(list_node),
-                        NULL,
-                        WEBIDL_NODE_TYPE_ARGUMENT);
-
+                webidl_node_iter_init(&member_it,
+                                      webidl_node_getnode(list_node));
+                member_node = webidl_node_iter_next(&member_it,
+                                                    WEBIDL_NODE_TYPE_ARGUMENT);
                 while (member_node != NULL) {
-                        cure->node = member_node;
-
-                        cure->name = webidl_node_gettext(
-                                webidl_node_find_type(
-                                        webidl_node_getnode(member_node),
-                                        NULL,
-                                        WEBIDL_NODE_TYPE_IDENT));
-
-                        cure->optionalc = webidl_node_enumerate_type(
-                                webidl_node_getnode(member_node),
-                                WEBIDL_NODE_TYPE_OPTIONAL);
-
-                        cure->elipsisc = webidl_node_enumerate_type(
-                                webidl_node_getnode(member_node),
-                                WEBIDL_NODE_TYPE_ELLIPSIS);
+                        newv = array_reserve(memberv, memberc, &membera,
+                                             sizeof(*memberv));
+                        if (newv == NULL) {
+                                webidl_node_iter_fini(&member_it);
+                                webidl_node_iter_fini(&list_it);
+                                free(memberv);
+                                return -1;
+                        }
+                        memberv = newv;
 
-                        cure++;
+                        argument_entry_fill(member_node, memberv + memberc);
+                        memberc++;
 
-                        /* move to next member */
-                        member_node = webidl_node_find_type(
-                                webidl_node_getnode(list_node),
-                                member_node,
-                                WEBIDL_NODE_TYPE_ARGUMENT);
+                        member_node = webidl_node_iter_next(&member_it,
+                                        WEBIDL_NODE_TYPE_ARGUMENT);
                 }
+                webidl_node_iter_fini(&member_it);
 
-                list_node = webidl_node_find_type(
-                        webidl_node_getnode(dictionary),
-                        list_node,
-                        WEBIDL_NODE_TYPE_LIST);
+                list_node = webidl_node_iter_next(&list_it,
+                                                  WEBIDL_NODE_TYPE_LIST);
         }
+        webidl_node_iter_fini(&list_it);
 
         *memberc_out = memberc;
-        *memberv_out = memberv; /* resulting members map */
+        *memberv_out = memberv;
 
         return 0;
-
 }
 
 static int
-entry_map_new(struct genbind_node *genbind,
-                  struct webidl_node *interface,
+entry_map_new(struct webidl_node *interface,
                   int *interfacec_out,
                   struct ir_entry **interfacev_out)
 {
@@ -795,6 +1099,7 @@ entry_map_new(struct genbind_node *genbind,
         struct ir_entry *entries;
         struct ir_entry *sorted_entries;
         struct ir_entry *cure;
+        struct webidl_node_iter node_it;
         struct webidl_node *node;
 
         interfacec = webidl_node_enumerate_type(interface,
@@ -815,9 +1120,8 @@ entry_map_new(struct genbind_node *genbind,
 
         /* for each interface populate an entry in the map */
         cure = entries;
-        node = webidl_node_find_type(interface,
-                                     NULL,
-                                     WEBIDL_NODE_TYPE_INTERFACE);
+        webidl_node_iter_init(&node_it, interface);
+        node = webidl_node_iter_next(&node_it, WEBIDL_NODE_TYPE_INTERFACE);
         while (node != NULL) {
 
                 /* fill map entry */
@@ -838,11 +1142,8 @@ entry_map_new(struct genbind_node *genbind,
                                 WEBIDL_NODE_TYPE_INHERITANCE));
 
                 /* matching class from binding  */
-                cure->class = genbind_node_find_type_ident(
-                        genbind,
-                        NULL,
-                        GENBIND_NODE_TYPE_CLASS,
-                        cure->name);
+                cure->class = genbind_index_find(GENBIND_NODE_TYPE_CLASS,
+                                                 cure->name);
 
                 /* identify this is an interface entry */
                 cure->type = IR_ENTRY_TYPE_INTERFACE;
@@ -871,34 +1172,25 @@ entry_map_new(struct genbind_node *genbind,
                         cure->u.interface.primary_global = true;
                 }
 
-                /* enumerate and map the interface operations */
-                operation_map_new(node,
-                                  cure->class,
-                                  &cure->u.interface.operationc,
-                                  &cure->u.interface.operationv);
-
-                /* enumerate and map the interface attributes */
-                attribute_map_new(node,
-                                  cure->class,
-                                  &cure->u.interface.attributec,
-                                  &cure->u.interface.attributev);
-
-                /* enumerate and map the interface constants */
-                constant_map_new(node,
-                                 &cure->u.interface.constantc,
-                                 &cure->u.interface.constantv);
+                /* map the interface operations, attributes and constants */
+                if (interface_map_new(node,
+                                      cure->class,
+                                      &cure->u.interface) != 0) {
+                        webidl_node_iter_fini(&node_it);
+                        free(entries);
+                        return -1;
+                }
 
                 /* move to next interface */
-                node = webidl_node_find_type(interface,
-                                             node,
+                node = webidl_node_iter_next(&node_it,
                                              WEBIDL_NODE_TYPE_INTERFACE);
                 cure++;
         }
+        webidl_node_iter_fini(&node_it);
 
         /* for each dictionary populate an entry in the map */
-        node = webidl_node_find_type(interface,
-                                     NULL,
-                                     WEBIDL_NODE_TYPE_DICTIONARY);
+        webidl_node_iter_init(&node_it, interface);
+        node = webidl_node_iter_next(&node_it, WEBIDL_NODE_TYPE_DICTIONARY);
         while (node != NULL) {
 
                 /* fill map entry */
@@ -919,29 +1211,33 @@ entry_map_new(struct genbind_node *genbind,
                                 WEBIDL_NODE_TYPE_INHERITANCE));
 
                 /* matching class from binding  */
-                cure->class = genbind_node_find_type_ident(
-                        genbind,
-                        NULL,
-                        GENBIND_NODE_TYPE_CLASS,
-                        cure->name);
+                cure->class = genbind_index_find(GENBIND_NODE_TYPE_CLASS,
+                                                 cure->name);
 
                 /* identify this is an interface entry */
                 cure->type = IR_ENTRY_TYPE_DICTIONARY;
 
-                /* enumerate and map the dictionary members */
-                member_map_new(node,
-                               &cure->u.dictionary.memberc,
-                               &cure->u.dictionary.memberv);
+                /* map the dictionary members */
+                if (member_map_new(node,
+                                   &cure->u.dictionary.memberc,
+                                   &cure->u.dictionary.memberv) != 0) {
+                        webidl_node_iter_fini(&node_it);
+                        free(entries);
+                        return -1;
+                }
 
                 /* move to next interface */
-                node = webidl_node_find_type(interface,
-                                             node,
+                node = webidl_node_iter_next(&node_it,
                                              WEBIDL_NODE_TYPE_DICTIONARY);
                 cure++;
         }
+        webidl_node_iter_fini(&node_it);
 
         /* compute inheritance and refcounts on map */
-        compute_inherit_refcount(entries, entryc);
+        if (compute_inherit_refcount(entries, entryc) != 0) {
+                free(entries);
+                return -1;
+        }
 
         /* sort entries to ensure correct ordering */
         sorted_entries = entry_topoligical_sort(entries, entryc);
@@ -950,9 +1246,6 @@ entry_map_new(struct genbind_node *genbind,
                 return -1;
         }
 
-        /* compute inheritance and refcounts on sorted map */
-        compute_inherit_refcount(sorted_entries, entryc);
-
         *interfacec_out = entryc;
         *interfacev_out = sorted_entries;
 
@@ -973,12 +1266,12 @@ int ir_new(struct genbind_node *genbind,
         }
 
         map->webidl = webidl;
+        map->genbind = genbind;
         map->binding_node = genbind_node_find_type(genbind, NULL,
                                                    GENBIND_NODE_TYPE_BINDING);
 
         /* interfaces */
-        ret = entry_map_new(genbind,
-                            webidl,
+        ret = entry_map_new(webidl,
                             &map->entryc,
                             &map->entries);
         if (ret != 0) {
@@ -986,11 +1279,111 @@ int ir_new(struct genbind_node *genbind,
                 return ret;
         }
 
+        map->entry_index = NULL;
+        ret = ir_index_entries(map);
+        if (ret != 0) {
+                ir_free(map);
+                return ret;
+        }
+
         *map_out = map;
 
         return 0;
 }
 
+static void ir_interface_free(struct ir_interface_entry *interfacee)
+{
+        int idx;
+        int ovidx;
+
+        for (idx = 0; idx < interfacee->operationc; idx++) {
+                struct ir_operation_entry *operatione;
+
+                operatione = interfacee->operationv + idx;
+                for (ovidx = 0; ovidx < operatione->overloadc; ovidx++) {
+                        free(operatione->overloadv[ovidx].argumentv);
+                }
+                free(operatione->overloadv);
+        }
+        free(interfacee->operationv);
+
+        for (idx = 0; idx < interfacee->attributec; idx++) {
+                free(interfacee->attributev[idx].typev);
+                free(interfacee->attributev[idx].property_name);
+        }
+        free(interfacee->attributev);
+
+        free(interfacee->constantv);
+}
+
+/* exported interface documented in ir.h */
+void ir_free(struct ir *map)
+{
+        int idx;
+        struct ir_entry *entry;
+
+        if (map == NULL) {
+                return;
+        }
+
+        for (idx = 0; idx < map->entryc; idx++) {
+                entry = map->entries + idx;
+
+                switch (entry->type) {
+                case IR_ENTRY_TYPE_INTERFACE:
+                        ir_interface_free(&entry->u.interface);
+                        break;
+
+                case IR_ENTRY_TYPE_DICTIONARY:
+                        free(entry->u.dictionary.memberv);
+                        break;
+                }
+
+                free(entry->filename);
+                free(entry->class_name);
+                free(entry->class_init_argt);
+        }
+        free(map->entries);
+        nameindex_free(map->entry_index);
+        free(map);
+}
+
+/* exported interface documented in ir.h */
+int ir_index_entries(struct ir *map)
+{
+        int idx;
+        struct ir_entry *entry;
+
+        nameindex_free(map->entry_index);
+        map->entry_index = nameindex_new();
+        if (map->entry_index == NULL) {
+                return -1;
+        }
+
+        /* add in reverse so the index keeps the first entry of a name */
+        for (idx = map->entryc - 1; idx >= 0; idx--) {
+                entry = map->entries + idx;
+                if (entry->name == NULL) {
+                        continue;
+                }
+                if (nameindex_add(map->entry_index,
+                                  entry->type,
+                                  entry->name,
+                                  entry) != 0) {
+                        return -1;
+                }
+        }
+
+        return 0;
+}
+
+/* exported interface documented in ir.h */
+struct ir_entry *
+ir_find_entry(struct ir *map, enum ir_entry_type type, const char *name)
+{
+        return nameindex_find(map->entry_index, type, name);
+}
+
 static int ir_dump_dictionary(FILE *dumpf, struct ir_entry *ecur)
 {
         if (ecur->u.dictionary.memberc > 0) {
@@ -11,6 +11,7 @@
 
 struct genbind_node;
 struct webidl_node;
+struct nameindex;
 
 /**
  * map entry for each argument of an overload on an operation
@@ -166,6 +167,12 @@ struct ir_entry {
                               * initializer.
                               */
 	enum ir_init_argtype *class_init_argt; /**< The types of the initialiser parameters */
+        int class_id; /**< pre-order index of the interface in the
+                       * inheritance forest
+                       */
+        int class_id_last; /**< class_id of the last interface which
+                            * inherits from this one or class_id if none
+                            */
 };
 
 /** intermediate representation of WebIDL and binding data */
@@ -176,8 +183,14 @@ struct ir {
         /** The AST node of the binding information */
         struct genbind_node *binding_node;
 
+        /** Root AST node of the binding */
+        struct genbind_node *genbind;
+
         /** Root AST node of the webIDL */
         struct webidl_node *webidl;
+
+        /** index of the entries by type and name */
+        struct nameindex *entry_index;
 };
 
 /**
@@ -187,6 +200,50 @@ int ir_new(struct genbind_node *genbind,
                       struct webidl_node *webidl,
                       struct ir **map_out);
 
+/**
+ * release an interface map
+ *
+ * The abstract syntax trees the map refers to are not released.
+ *
+ * \param map The map to release or NULL.
+ */
+void ir_free(struct ir *map);
+
+/**
+ * check every inheritance chain of an interface map ends
+ *
+ * Maps created by ir_new() are always acyclic, this is for maps read
+ * from elsewhere.
+ *
+ * \param map The map to check.
+ * \return 0 if the inheritance is acyclic else -1 on allocation failure
+ *         or if there is a cycle, which is reported.
+ */
+int ir_check_inheritance(struct ir *map);
+
+/**
+ * index the entries of an interface map by name
+ *
+ * Maps created by ir_new() are already indexed, this is for maps read
+ * from elsewhere.
+ *
+ * \param map The map to index.
+ * \return 0 on success else -1 on allocation failure.
+ */
+int ir_index_entries(struct ir *map);
+
+/**
+ * find an interface map entry by name
+ *
+ * \param map The map to search.
+ * \param type The type of the entry.
+ * \param name The interned name of the entry.
+ * \return The first entry of the type with the name or NULL if there
+ *         is not one.
+ */
+struct ir_entry *
+ir_find_entry(struct ir *map, enum ir_entry_type type, const char *name);
+
 int ir_dump(struct ir *map);
 
 int ir_dumpdot(struct ir *map);
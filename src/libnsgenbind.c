@@ -0,0 +1,828 @@
+/* embeddable binding generator implementation
+ *
+ * This file is part of nsgenbind.
+ * Licensed under the MIT License,
+ *                http://www.opensource.org/licenses/mit-license.php
+ * Copyright 2026 agent <agent@local>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "nsgenbind.h"
+#include "options.h"
+#include "context.h"
+#include "utils.h"
+#include "intern.h"
+#include "depfile.h"
+#include "stats.h"
+#include "nsgenbind-ast.h"
+#include "webidl-ast.h"
+#include "ir.h"
+#include "ir-serial.h"
+#include "output.h"
+#include "jsapi-libdom.h"
+#include "duk-libdom.h"
+
+enum bindingtype_e {
+    BINDINGTYPE_UNKNOWN,
+    BINDINGTYPE_JSAPI_LIBDOM,
+    BINDINGTYPE_DUK_LIBDOM,
+};
+
+/**
+ * Web IDL AST loaded from a list of IDL files
+ */
+struct idl_set {
+        char **filev; /**< IDL files in the order they are loaded */
+        unsigned int filec; /**< number of IDL files */
+        struct webidl_node *webidl; /**< AST with implements intercalated */
+};
+
+/**
+ * Web IDL ASTs loaded for the bindings processed so far
+ */
+struct idl_sets {
+        struct idl_set *setv;
+        unsigned int setc;
+};
+
+static int webidl_file_cb(struct genbind_node *node, void *ctx)
+{
+        struct idl_set *set = ctx;
+        char **filev;
+
+        filev = realloc(set->filev, (set->filec + 1) * sizeof(char *));
+        if (filev == NULL) {
+                return -1;
+        }
+        set->filev = filev;
+        /* interned so the list outlives the binding AST */
+        set->filev[set->filec] = intern_string(genbind_node_gettext(node));
+        if (set->filev[set->filec] == NULL) {
+                return -1;
+        }
+        set->filec++;
+
+        return 0;
+}
+
+/**
+ * find a previously loaded set with the same IDL files
+ */
+static struct idl_set *
+idl_sets_find(struct idl_sets *sets, struct idl_set *key)
+{
+        unsigned int idx;
+        unsigned int fidx;
+        struct idl_set *set;
+
+        for (idx = 0; idx < sets->setc; idx++) {
+                set = sets->setv + idx;
+                if (set->filec != key->filec) {
+                        continue;
+                }
+                for (fidx = 0; fidx < set->filec; fidx++) {
+                        if (set->filev[fidx] != key->filev[fidx]) {
+                                break;
+                        }
+                }
+                if (fidx == set->filec) {
+                        return set;
+                }
+        }
+        return NULL;
+}
+
+static void idl_sets_free(struct idl_sets *sets)
+{
+        unsigned int idx;
+
+        for (idx = 0; idx < sets->setc; idx++) {
+                free(sets->setv[idx].filev);
+        }
+        free(sets->setv);
+        sets->setv = NULL;
+        sets->setc = 0;
+}
+
+/**
+ * get the result of a processing phase
+ *
+ * A phase which otherwise succeeded fails if an allocation failed while
+ * it was running.
+ *
+ * \param res The result of the phase.
+ * \param code The result for a failed allocation.
+ * \return The result of the phase.
+ */
+static int phase_result(int res, int code)
+{
+        if ((res == 0) && genb_context_failed()) {
+                return code;
+        }
+        return res;
+}
+
+/**
+ * load the IDL files a binding requires
+ *
+ * Bindings which require the same IDL files share a single AST so the
+ * files are only parsed and the implements intercalated once.
+ */
+static int genbind_load_idl(struct genbind_node *genbind,
+                            struct idl_sets *sets,
+                            struct webidl_node **webidl_out)
+{
+        int res;
+        unsigned int idx;
+        struct genbind_node *binding_node;
+        struct idl_set key = { NULL, 0, NULL };
+        struct idl_set *set;
+        struct stats_time start;
+
+        binding_node = genbind_node_find_type(genbind, NULL,
+                                              GENBIND_NODE_TYPE_BINDING);
+
+        /* list the web IDL files required */
+        res = genbind_node_foreach_type(
+                genbind_node_getnode(binding_node),
+                GENBIND_NODE_TYPE_WEBIDL,
+                webidl_file_cb,
+                &key);
+        if (res != 0) {
+                fprintf(stderr, "Error: Web IDL list allocation failed\n");
+                free(key.filev);
+                return -1;
+        }
+
+        set = idl_sets_find(sets, &key);
+        if (set != NULL) {
+                if (options->verbose) {
+                        printf("Using previously loaded Web IDL\n");
+                }
+                free(key.filev);
+                *webidl_out = set->webidl;
+                return 0;
+        }
+
+	/* load the web IDL files */
+        stats_time_start(&start);
+        if (options->verbose) {
+                for (idx = 0; idx < key.filec; idx++) {
+                        printf("Opening IDL file \"%s\"\n", key.filev[idx]);
+                }
+        }
+        res = webidl_parsefiles(key.filev, key.filec, &key.webidl);
+        stats_phase("idl_load", &start);
+	if (res != 0) {
+		fprintf(stderr, "Error: failed reading Web IDL\n");
+                free(key.filev);
+		return -1;
+	}
+
+        /* implements are implemented as mixins so intercalate them */
+        stats_time_start(&start);
+        res = phase_result(webidl_intercalate_implements(key.webidl), -1);
+        stats_phase("webidl_intercalate_implements", &start);
+	if (res != 0) {
+		fprintf(stderr, "Error: Failed to intercalate implements\n");
+                free(key.filev);
+		return -1;
+	}
+
+        set = realloc(sets->setv, (sets->setc + 1) * sizeof(struct idl_set));
+        if (set == NULL) {
+                fprintf(stderr, "Error: Web IDL list allocation failed\n");
+                free(key.filev);
+                return -1;
+        }
+        sets->setv = set;
+        sets->setv[sets->setc++] = key;
+
+        *webidl_out = key.webidl;
+
+        return 0;
+}
+
+/**
+ * report the memory used by the abstract syntax trees
+ */
+static void report_ast_stats(void)
+{
+        unsigned int nodec;
+        size_t used;
+        size_t allocated;
+        unsigned int requests;
+
+        genbind_ast_stats(&nodec, &used, &allocated);
+        printf("Binding AST: %u nodes, %zu bytes used of %zu allocated\n",
+               nodec, used, allocated);
+
+        webidl_ast_stats(&nodec, &used, &allocated);
+        printf("Web IDL AST: %u nodes, %zu bytes used of %zu allocated\n",
+               nodec, used, allocated);
+
+        intern_stats(&nodec, &requests);
+        printf("Interned strings: %u distinct from %u\n", nodec, requests);
+}
+
+/**
+ * record the sizes of the abstract syntax trees and intermediate
+ * representations in the statistics
+ */
+static void record_stats(struct ir **irv, unsigned int irc)
+{
+        unsigned int nodec;
+        size_t used;
+        size_t allocated;
+        unsigned int requests;
+        uint64_t interfacec = 0;
+        uint64_t dictionaryc = 0;
+        uint64_t operationc = 0;
+        uint64_t attributec = 0;
+        uint64_t constantc = 0;
+        uint64_t memberc = 0;
+        uint64_t entryc = 0;
+        unsigned int iridx;
+        int idx;
+
+        genbind_ast_stats(&nodec, &used, &allocated);
+        stats_count("binding_ast_nodes", nodec);
+        stats_count("binding_ast_bytes", used);
+
+        webidl_ast_stats(&nodec, &used, &allocated);
+        stats_count("webidl_ast_nodes", nodec);
+        stats_count("webidl_ast_bytes", used);
+
+        intern_stats(&nodec, &requests);
+        stats_count("interned_strings", nodec);
+
+        for (iridx = 0; iridx < irc; iridx++) {
+                struct ir *ir = irv[iridx];
+
+                if (ir == NULL) {
+                        continue;
+                }
+
+                entryc += ir->entryc;
+                for (idx = 0; idx < ir->entryc; idx++) {
+                        struct ir_entry *entry = ir->entries + idx;
+
+                        switch (entry->type) {
+                        case IR_ENTRY_TYPE_INTERFACE:
+                                interfacec++;
+                                operationc += entry->u.interface.operationc;
+                                attributec += entry->u.interface.attributec;
+                                constantc += entry->u.interface.constantc;
+                                break;
+
+                        case IR_ENTRY_TYPE_DICTIONARY:
+                                dictionaryc++;
+                                memberc += entry->u.dictionary.memberc;
+                                break;
+                        }
+                }
+        }
+
+        stats_count("ir_entries", entryc);
+        stats_count("ir_interfaces", interfacec);
+        stats_count("ir_dictionaries", dictionaryc);
+        stats_count("ir_operations", operationc);
+        stats_count("ir_attributes", attributec);
+        stats_count("ir_constants", constantc);
+        stats_count("ir_dictionary_members", memberc);
+}
+
+/**
+ * get the type of binding
+ */
+static enum bindingtype_e genbind_get_type(struct genbind_node *node)
+{
+        struct genbind_node *binding_node;
+        const char *binding_type;
+
+        binding_node = genbind_node_find_type(node,
+                                              NULL,
+                                              GENBIND_NODE_TYPE_BINDING);
+        if (binding_node == NULL) {
+            /* binding entry is missing which is invalid */
+            return BINDINGTYPE_UNKNOWN;
+        }
+
+        binding_type = genbind_node_gettext(
+                genbind_node_find_type(
+                        genbind_node_getnode(binding_node),
+                        NULL,
+                        GENBIND_NODE_TYPE_NAME));
+        if (binding_type == NULL) {
+                fprintf(stderr, "Error: missing binding type\n");
+                return BINDINGTYPE_UNKNOWN;
+        }
+
+        if (strcmp(binding_type, "jsapi_libdom") == 0) {
+                return BINDINGTYPE_JSAPI_LIBDOM;
+        }
+
+        if (strcmp(binding_type, "duk_libdom") == 0) {
+                return BINDINGTYPE_DUK_LIBDOM;
+        }
+
+        fprintf(stderr, "Error: unsupported binding type \"%s\"\n", binding_type);
+
+        return BINDINGTYPE_UNKNOWN;
+}
+
+/**
+ * dump an intermediate representation and generate output from it
+ *
+ * \param bindingtype The type of binding to generate.
+ * \param ir The intermediate representation.
+ * \return 0 on success else the program exit code.
+ */
+static int output_binding(enum bindingtype_e bindingtype, struct ir *ir)
+{
+        int res;
+
+        /* dump the intermediate representation */
+        ir_dump(ir);
+        ir_dumpdot(ir);
+
+        /* generate binding */
+        switch (bindingtype) {
+        case BINDINGTYPE_DUK_LIBDOM:
+                res = duk_libdom_output(ir);
+                break;
+
+        default:
+                fprintf(stderr, "Unable to generate binding of this type\n");
+                res = 7;
+        }
+
+        return res;
+}
+
+/**
+ * generate every output of a saved intermediate representation
+ *
+ * The file is loaded for each output directory it is paired with as
+ * output generation annotates the intermediate representation.
+ *
+ * \param first The index of the first pairing of the file.
+ * \param irv Updated with the intermediate representation for each pairing.
+ * \return 0 on success else the program exit code.
+ */
+static int generate_ir_binding(unsigned int first, struct ir **irv)
+{
+        int res;
+        unsigned int idx;
+        struct ir *ir;
+        enum bindingtype_e bindingtype;
+        struct stats_time start;
+
+        depfile_add_input(options->infilename, DEPFILE_INPUT_BINDING);
+
+        for (idx = first; idx < options->bindingc; idx++) {
+                if (strcmp(options->bindingv[idx].infilename,
+                           options->infilename) != 0) {
+                        continue;
+                }
+                options->outdirname = options->bindingv[idx].outdirname;
+
+                if (options->verbose) {
+                        printf("Loading intermediate representation \"%s\"\n",
+                               options->infilename);
+                }
+
+                stats_time_start(&start);
+                res = phase_result(ir_load(options->infilename, &ir), 6);
+                stats_phase("ir_load", &start);
+                if (res != 0) {
+                        return 6;
+                }
+                irv[idx] = ir;
+
+                if (idx == first) {
+                        genbind_dump_ast(ir->genbind);
+                        webidl_dump_ast(ir->webidl);
+                        if (options->verbose) {
+                                report_ast_stats();
+                        }
+                }
+
+                bindingtype = genbind_get_type(ir->genbind);
+                if (bindingtype == BINDINGTYPE_UNKNOWN) {
+                        return 3;
+                }
+
+                res = output_binding(bindingtype, ir);
+                if (res != 0) {
+                        return res;
+                }
+        }
+
+        return 0;
+}
+
+/**
+ * generate every output of a binding
+ *
+ * The binding is parsed once and an intermediate representation built
+ * and output for each output directory it is paired with.
+ *
+ * \param first The index of the first pairing of the binding.
+ * \param sets The Web IDL already loaded.
+ * \param irv Updated with the intermediate representation for each pairing.
+ * \return 0 on success else the program exit code.
+ */
+static int
+generate_binding(unsigned int first, struct idl_sets *sets, struct ir **irv)
+{
+        int res;
+        unsigned int idx;
+        struct genbind_node *genbind_root = NULL;
+        struct webidl_node *webidl_root = NULL;
+        struct ir *ir;
+        enum bindingtype_e bindingtype;
+        struct stats_time start;
+
+        options->infilename = options->bindingv[first].infilename;
+        options->outdirname = options->bindingv[first].outdirname;
+
+        if (options->read_ir) {
+                return generate_ir_binding(first, irv);
+        }
+
+        /* parse binding */
+        stats_time_start(&start);
+        res = phase_result(genbind_parsefile(options->infilename,
+                                             &genbind_root), 3);
+        stats_phase("binding_parse", &start);
+        if (res != 0) {
+                fprintf(stderr, "Error: parse failed with code %d\n", res);
+                return res;
+        }
+
+        /* dump the binding AST */
+        genbind_dump_ast(genbind_root);
+
+        /* get type of binding */
+        bindingtype = genbind_get_type(genbind_root);
+        if (bindingtype == BINDINGTYPE_UNKNOWN) {
+                return 3;
+        }
+
+        /* load the IDL files specified in the binding */
+        res = genbind_load_idl(genbind_root, sets, &webidl_root);
+        if (res != 0) {
+                return 4;
+        }
+
+	/* debug dump of web idl AST */
+        webidl_dump_ast(webidl_root);
+
+        if (options->verbose) {
+                report_ast_stats();
+        }
+
+        for (idx = first; idx < options->bindingc; idx++) {
+                if (strcmp(options->bindingv[idx].infilename,
+                           options->infilename) != 0) {
+                        continue;
+                }
+                options->outdirname = options->bindingv[idx].outdirname;
+
+                /* generate intermediate representation */
+                stats_time_start(&start);
+                res = phase_result(ir_new(genbind_root, webidl_root, &ir), 5);
+                stats_phase("ir_new", &start);
+                if (res != 0) {
+                        return 5;
+                }
+                irv[idx] = ir;
+
+                /* save the intermediate representation with the output */
+                if (options->write_ir && !options->dryrun) {
+                        stats_time_start(&start);
+                        res = ir_save(ir, IR_SERIAL_FILENAME);
+                        stats_phase("ir_save", &start);
+                        if (res != 0) {
+                                return 6;
+                        }
+                }
+
+                res = output_binding(bindingtype, ir);
+                if (res != 0) {
+                        return res;
+                }
+        }
+
+        return 0;
+}
+
+/**
+ * generate every binding
+ *
+ * \param sets The Web IDL already loaded.
+ * \param irv Updated with the intermediate representation of each binding.
+ * \param start The time generation started.
+ * \return 0 on success else the program exit code.
+ */
+static int
+generate_bindings(struct idl_sets *sets,
+                  struct ir **irv,
+                  struct stats_time *start)
+{
+        int res = 0;
+        unsigned int idx;
+        unsigned int prev;
+
+        for (idx = 0; (res == 0) && (idx < options->bindingc); idx++) {
+                /* each distinct binding is generated with its first pairing */
+                for (prev = 0; prev < idx; prev++) {
+                        if (strcmp(options->bindingv[prev].infilename,
+                                   options->bindingv[idx].infilename) == 0) {
+                                break;
+                        }
+                }
+                if (prev == idx) {
+                        res = generate_binding(idx, sets, irv);
+                }
+        }
+
+        /* record the files the generated binding depends on */
+        if ((res == 0) && (options->depfilename != NULL)) {
+                if (depfile_write(options->depfilename) != 0) {
+                        res = 8;
+                }
+        }
+
+        /* report where the time went */
+        if (options->stats) {
+                stats_phase("total", start);
+                record_stats(irv, options->bindingc);
+                if ((stats_write(options->statsfilename) != 0) &&
+                    (res == 0)) {
+                        res = 9;
+                }
+                stats_free();
+        }
+
+        return res;
+}
+
+/**
+ * generator context
+ */
+struct nsgenbind_ctx {
+        struct genb_context context; /**< state the pipeline runs with */
+        struct idl_sets sets; /**< Web IDL loaded so far */
+        struct ir **irv; /**< intermediate representation of each binding */
+        unsigned int irc; /**< number of entries in irv */
+        unsigned int intern_limit; /**< interned strings before a reload */
+};
+
+static char *config_strdup(const char *str, bool *failed)
+{
+        char *res;
+
+        if (str == NULL) {
+                return NULL;
+        }
+        res = strdup(str);
+        if (res == NULL) {
+                *failed = true;
+        }
+        return res;
+}
+
+/**
+ * release the bindings and everything built from them
+ *
+ * The Web IDL and the inputs it was read from are kept.
+ */
+static void release_bindings(struct nsgenbind_ctx *ctx)
+{
+        unsigned int idx;
+
+        for (idx = 0; idx < ctx->irc; idx++) {
+                ir_free(ctx->irv[idx]);
+        }
+        free(ctx->irv);
+        ctx->irv = NULL;
+        ctx->irc = 0;
+
+        for (idx = 0; idx < ctx->context.options.bindingc; idx++) {
+                free(ctx->context.options.bindingv[idx].infilename);
+                free(ctx->context.options.bindingv[idx].outdirname);
+        }
+        free(ctx->context.options.bindingv);
+        ctx->context.options.bindingv = NULL;
+        ctx->context.options.bindingc = 0;
+        ctx->context.options.infilename = NULL;
+        ctx->context.options.outdirname = NULL;
+
+        genbind_ast_free();
+        if (ctx->context.options.read_ir) {
+                /* the Web IDL was loaded with the bindings */
+                webidl_ast_free();
+        }
+        depfile_reset(false);
+}
+
+/* exported interface documented in nsgenbind.h */
+int nsgenbind_create(const struct nsgenbind_config *config,
+                     struct nsgenbind_ctx **ctx_out)
+{
+        struct nsgenbind_ctx *ctx;
+        bool failed = false;
+
+        ctx = calloc(1, sizeof(struct nsgenbind_ctx));
+        if (ctx == NULL) {
+                fprintf(stderr, "Allocation error\n");
+                return -1;
+        }
+
+        if (genb_context_init(&ctx->context) != 0) {
+                fprintf(stderr, "Allocation error\n");
+                free(ctx);
+                return -1;
+        }
+        genb_context_set(&ctx->context);
+
+        ctx->context.options.idlpath = config_strdup(config->idlpath, &failed);
+        ctx->context.options.depfilename = config_strdup(config->depfilename, &failed);
+        ctx->context.options.cachedir = config_strdup(config->cachedir, &failed);
+        ctx->context.options.statsfilename = config_strdup(config->statsfilename,
+                                                   &failed);
+        if (failed) {
+                fprintf(stderr, "Allocation error\n");
+                nsgenbind_destroy(ctx);
+                return -1;
+        }
+
+        ctx->context.options.verbose = config->verbose;
+        ctx->context.options.debug = config->debug;
+        ctx->context.options.dbglog = config->dbglog;
+        ctx->context.options.dryrun = config->dryrun;
+        ctx->context.options.stats = config->stats;
+        ctx->context.options.watch = config->watch;
+        ctx->context.options.write_ir = config->write_ir;
+        ctx->context.options.read_ir = config->read_ir;
+        ctx->context.options.prototype_tables = config->prototype_tables;
+        ctx->context.options.lazy_prototypes = config->lazy_prototypes;
+        ctx->context.options.private_literal = config->private_literal;
+        /* lazily created prototypes are fetched on demand instead */
+        ctx->context.options.prototype_handles = config->prototype_handles &&
+                !config->lazy_prototypes;
+        ctx->context.options.class_ids = config->class_ids;
+        ctx->context.options.jobs = config->jobs;
+        ctx->context.options.warnings = config->warnings;
+
+        *ctx_out = ctx;
+
+        return 0;
+}
+
+/* exported interface documented in nsgenbind.h */
+int nsgenbind_generate(struct nsgenbind_ctx *ctx,
+                       unsigned int bindingc,
+                       const struct nsgenbind_binding *bindingv)
+{
+        unsigned int idx;
+        unsigned int internc;
+        unsigned int requests;
+        int res;
+        struct stats_time start;
+
+        genb_context_set(&ctx->context);
+
+        stats_time_start(&start);
+
+        /* whatever was loaded when an allocation failed is incomplete */
+        if (ctx->context.failed) {
+                nsgenbind_reset(ctx);
+                ctx->context.failed = false;
+        }
+
+        release_bindings(ctx);
+
+        /* strings interned for previous bindings are only released
+         * with the Web IDL so it is loaded again once they have grown
+         * too numerous
+         */
+        intern_stats(&internc, &requests);
+        if ((ctx->intern_limit != 0) && (internc > ctx->intern_limit)) {
+                nsgenbind_reset(ctx);
+        }
+
+        if (bindingc == 0) {
+                fprintf(stderr,
+                        "Error: expected input filename and output directory\n");
+                return 1;
+        }
+
+        ctx->context.options.bindingv = calloc(bindingc,
+                                       sizeof(struct options_binding));
+        ctx->irv = calloc(bindingc, sizeof(struct ir *));
+        if ((ctx->context.options.bindingv == NULL) || (ctx->irv == NULL)) {
+                fprintf(stderr, "Allocation error\n");
+                release_bindings(ctx);
+                return 1;
+        }
+        ctx->context.options.bindingc = bindingc;
+        ctx->irc = bindingc;
+
+        for (idx = 0; idx < bindingc; idx++) {
+                ctx->context.options.bindingv[idx].infilename =
+                        strdup(bindingv[idx].infilename);
+                ctx->context.options.bindingv[idx].outdirname =
+                        strdup(bindingv[idx].outdirname);
+                if ((ctx->context.options.bindingv[idx].infilename == NULL) ||
+                    (ctx->context.options.bindingv[idx].outdirname == NULL)) {
+                        fprintf(stderr, "Allocation error\n");
+                        release_bindings(ctx);
+                        return 1;
+                }
+        }
+        ctx->context.options.infilename = ctx->context.options.bindingv[0].infilename;
+        ctx->context.options.outdirname = ctx->context.options.bindingv[0].outdirname;
+
+        res = generate_bindings(&ctx->sets, ctx->irv, &start);
+
+        if (ctx->intern_limit == 0) {
+                /* allow half as many strings again as a full load */
+                intern_stats(&internc, &requests);
+                ctx->intern_limit = internc + (internc / 2);
+        }
+
+        return res;
+}
+
+/**
+ * parameters of an input iteration through the public interface
+ */
+struct foreach_input_ctx {
+        int (*cb)(const char *fname,
+                  enum nsgenbind_input_type type,
+                  void *pw);
+        void *pw;
+};
+
+static int foreach_input_cb(const char *fname,
+                            enum depfile_input type,
+                            void *ctx)
+{
+        struct foreach_input_ctx *fctx = ctx;
+
+        return fctx->cb(fname,
+                        (type == DEPFILE_INPUT_IDL) ?
+                        NSGENBIND_INPUT_IDL : NSGENBIND_INPUT_BINDING,
+                        fctx->pw);
+}
+
+/* exported interface documented in nsgenbind.h */
+int nsgenbind_foreach_input(struct nsgenbind_ctx *ctx,
+                            int (*cb)(const char *fname,
+                                      enum nsgenbind_input_type type,
+                                      void *pw),
+                            void *pw)
+{
+        struct foreach_input_ctx fctx = { cb, pw };
+
+        genb_context_set(&ctx->context);
+
+        return depfile_foreach_input(foreach_input_cb, &fctx);
+}
+
+/* exported interface documented in nsgenbind.h */
+void nsgenbind_reset(struct nsgenbind_ctx *ctx)
+{
+        genb_context_set(&ctx->context);
+
+        release_bindings(ctx);
+
+        idl_sets_free(&ctx->sets);
+        webidl_ast_free();
+        intern_free();
+        ctx->intern_limit = 0;
+        depfile_free();
+}
+
+/* exported interface documented in nsgenbind.h */
+void nsgenbind_destroy(struct nsgenbind_ctx *ctx)
+{
+        nsgenbind_reset(ctx);
+
+        free(ctx->context.options.idlpath);
+        free(ctx->context.options.depfilename);
+        free(ctx->context.options.cachedir);
+        free(ctx->context.options.statsfilename);
+
+        genb_context_fini(&ctx->context);
+        genb_context_set(NULL);
+        free(ctx);
+}
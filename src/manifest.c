@@ -0,0 +1,211 @@
+/* generated output manifest implementation
+ *
+ * This file is part of nsgenbind.
+ * Licensed under the MIT License,
+ *                http://www.opensource.org/licenses/mit-license.php
+ * Copyright 2026 agent <agent@local>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include "utils.h"
+#include "manifest.h"
+
+/** first line of a manifest file */
+#define MANIFEST_HEADER "nsgenbind manifest 1\n"
+
+/**
+ * manifest entry
+ */
+struct manifest_entry {
+        char *filename; /**< leaf name of output file */
+        uint64_t hash; /**< hash output was generated from */
+};
+
+struct manifest {
+        struct manifest_entry *entryv; /**< entries */
+        unsigned int entryc; /**< number of entries */
+        unsigned int alloc; /**< allocated size of entryv */
+        bool sorted; /**< entries are sorted by filename */
+};
+
+static int manifest_cmp(const void *a, const void *b)
+{
+        const struct manifest_entry *ea = a;
+        const struct manifest_entry *eb = b;
+
+        return strcmp(ea->filename, eb->filename);
+}
+
+/* exported interface documented in manifest.h */
+struct manifest *manifest_new(void)
+{
+        return calloc(1, sizeof(struct manifest));
+}
+
+/* exported interface documented in manifest.h */
+int manifest_add(struct manifest *manifest, const char *filename, uint64_t hash)
+{
+        struct manifest_entry *entryv;
+
+        if (manifest->entryc == manifest->alloc) {
+                entryv = realloc(manifest->entryv,
+                                 (manifest->alloc + 64) *
+                                 sizeof(struct manifest_entry));
+                if (entryv == NULL) {
+                        return -1;
+                }
+                manifest->entryv = entryv;
+                manifest->alloc += 64;
+        }
+
+        manifest->entryv[manifest->entryc].filename = strdup(filename);
+        if (manifest->entryv[manifest->entryc].filename == NULL) {
+                return -1;
+        }
+        manifest->entryv[manifest->entryc].hash = hash;
+        manifest->entryc++;
+        manifest->sorted = false;
+
+        return 0;
+}
+
+/* exported interface documented in manifest.h */
+struct manifest *manifest_load(const char *fname)
+{
+        struct manifest *manifest;
+        char *fpath;
+        FILE *manf;
+        char line[1024];
+        char filename[1024];
+        uint64_t hash;
+
+        manifest = manifest_new();
+        if (manifest == NULL) {
+                return NULL;
+        }
+
+        fpath = genb_fpath(fname);
+        manf = fopen(fpath, "r");
+        free(fpath);
+        if (manf == NULL) {
+                /* no previous manifest */
+                return manifest;
+        }
+
+        if ((fgets(line, sizeof(line), manf) == NULL) ||
+            (strcmp(line, MANIFEST_HEADER) != 0)) {
+                /* unrecognised manifest is ignored */
+                fclose(manf);
+                return manifest;
+        }
+
+        while (fgets(line, sizeof(line), manf) != NULL) {
+                if (sscanf(line, "%16" SCNx64 " %1023s", &hash, filename) != 2) {
+                        continue;
+                }
+                if (manifest_add(manifest, filename, hash) != 0) {
+                        fclose(manf);
+                        manifest_free(manifest);
+                        return NULL;
+                }
+        }
+        fclose(manf);
+
+        qsort(manifest->entryv,
+              manifest->entryc,
+              sizeof(struct manifest_entry),
+              manifest_cmp);
+        manifest->sorted = true;
+
+        return manifest;
+}
+
+/* exported interface documented in manifest.h */
+bool manifest_find(struct manifest *manifest, const char *filename, uint64_t *hash)
+{
+        struct manifest_entry key;
+        struct manifest_entry *entry;
+        unsigned int idx;
+
+        key.filename = (char *)filename;
+
+        if (manifest->sorted) {
+                entry = bsearch(&key,
+                                manifest->entryv,
+                                manifest->entryc,
+                                sizeof(struct manifest_entry),
+                                manifest_cmp);
+        } else {
+                entry = NULL;
+                for (idx = 0; idx < manifest->entryc; idx++) {
+                        if (manifest_cmp(&key, manifest->entryv + idx) == 0) {
+                                entry = manifest->entryv + idx;
+                                break;
+                        }
+                }
+        }
+
+        if (entry == NULL) {
+                return false;
+        }
+        *hash = entry->hash;
+        return true;
+}
+
+/* exported interface documented in manifest.h */
+int manifest_save(struct manifest *manifest, const char *fname)
+{
+        char *data;
+        size_t datalen = 0;
+        size_t alloc;
+        unsigned int idx;
+        int res;
+
+        /* each line is the hash, a space, the filename and a newline */
+        alloc = SLEN(MANIFEST_HEADER) + 1;
+        for (idx = 0; idx < manifest->entryc; idx++) {
+                alloc += strlen(manifest->entryv[idx].filename) + 18;
+        }
+
+        data = malloc(alloc);
+        if (data == NULL) {
+                genb_diagf("Error: unable to allocate manifest %s\n", fname);
+                return -1;
+        }
+
+        datalen += snprintf(data, alloc, "%s", MANIFEST_HEADER);
+        for (idx = 0; idx < manifest->entryc; idx++) {
+                datalen += snprintf(data + datalen,
+                                    alloc - datalen,
+                                    "%016" PRIx64 " %s\n",
+                                    manifest->entryv[idx].hash,
+                                    manifest->entryv[idx].filename);
+        }
+
+        res = genb_fupdate(fname, data, datalen);
+        free(data);
+
+        return res;
+}
+
+/* exported interface documented in manifest.h */
+void manifest_free(struct manifest *manifest)
+{
+        unsigned int idx;
+
+        if (manifest == NULL) {
+                return;
+        }
+
+        for (idx = 0; idx < manifest->entryc; idx++) {
+                free(manifest->entryv[idx].filename);
+        }
+        free(manifest->entryv);
+        free(manifest);
+}
@@ -0,0 +1,70 @@
+/* generated output manifest
+ *
+ * This file is part of nsgenbind.
+ * Licensed under the MIT License,
+ *                http://www.opensource.org/licenses/mit-license.php
+ * Copyright 2026 agent <agent@local>
+ */
+
+#ifndef nsgenbind_manifest_h
+#define nsgenbind_manifest_h
+
+/**
+ * record of the content hash each output file was generated from
+ */
+struct manifest;
+
+/**
+ * create a new empty manifest
+ *
+ * \return The new manifest or NULL on allocation failure.
+ */
+struct manifest *manifest_new(void);
+
+/**
+ * load a manifest from the output directory
+ *
+ * A missing or unrecognised manifest file results in an empty manifest.
+ *
+ * \param fname The leaf name of the manifest file.
+ * \return The loaded manifest or NULL on allocation failure.
+ */
+struct manifest *manifest_load(const char *fname);
+
+/**
+ * get the hash recorded for an output file
+ *
+ * May be called concurrently with other lookups.
+ *
+ * \param manifest The manifest to search.
+ * \param filename The leaf name of the output file.
+ * \param hash Updated with the recorded hash.
+ * \return true if the file is in the manifest else false.
+ */
+bool manifest_find(struct manifest *manifest, const char *filename, uint64_t *hash);
+
+/**
+ * add an output file to a manifest
+ *
+ * \param manifest The manifest to add to.
+ * \param filename The leaf name of the output file.
+ * \param hash The hash the output was generated from.
+ * \return 0 on success else -1 on allocation failure.
+ */
+int manifest_add(struct manifest *manifest, const char *filename, uint64_t hash);
+
+/**
+ * write a manifest to the output directory
+ *
+ * \param manifest The manifest to write.
+ * \param fname The leaf name of the manifest file.
+ * \return 0 on success else -1 and a diagnostic is reported.
+ */
+int manifest_save(struct manifest *manifest, const char *fname);
+
+/**
+ * free a manifest
+ */
+void manifest_free(struct manifest *manifest);
+
+#endif
@@ -0,0 +1,165 @@
+/* index of nodes by type and name implementation
+ *
+ * This file is part of nsgenbind.
+ * Licensed under the MIT License,
+ *                http://www.opensource.org/licenses/mit-license.php
+ * Copyright 2026 agent <agent@local>
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "nameindex.h"
+
+/** initial number of slots, must be a power of two */
+#define NAMEINDEX_INITIAL_SIZE 256
+
+/**
+ * index slot
+ */
+struct nameindex_entry {
+        const char *name; /**< interned name or NULL if slot unused */
+        int type; /**< node type */
+        void *node; /**< indexed node */
+};
+
+/**
+ * open addressed hash table keyed on the name pointer and type
+ */
+struct nameindex {
+        struct nameindex_entry *entries; /**< table slots */
+        unsigned int size; /**< number of slots */
+        unsigned int count; /**< number of used slots */
+};
+
+/**
+ * hash a type and interned name pointer
+ */
+static unsigned int nameindex_hash(int type, const char *name)
+{
+        uintptr_t hash = (uintptr_t)name;
+
+        /* mix the pointer bits as the low bits are alignment */
+        hash ^= hash >> 17;
+        hash *= 0x9e3779b1U;
+        hash ^= hash >> 15;
+
+        return (unsigned int)hash ^ (unsigned int)type;
+}
+
+/**
+ * find the slot for a type and name
+ *
+ * \return The slot holding the node or the empty slot it would occupy.
+ */
+static struct nameindex_entry *
+nameindex_slot(struct nameindex *index, int type, const char *name)
+{
+        unsigned int idx;
+        struct nameindex_entry *entry;
+
+        idx = nameindex_hash(type, name) & (index->size - 1);
+        for (;;) {
+                entry = index->entries + idx;
+                if ((entry->name == NULL) ||
+                    ((entry->name == name) && (entry->type == type))) {
+                        return entry;
+                }
+                idx = (idx + 1) & (index->size - 1);
+        }
+}
+
+/**
+ * resize the table
+ */
+static int nameindex_resize(struct nameindex *index, unsigned int size)
+{
+        struct nameindex_entry *oldentries;
+        unsigned int oldsize;
+        unsigned int idx;
+
+        oldentries = index->entries;
+        oldsize = index->size;
+
+        index->entries = calloc(size, sizeof(struct nameindex_entry));
+        if (index->entries == NULL) {
+                index->entries = oldentries;
+                return -1;
+        }
+        index->size = size;
+
+        for (idx = 0; idx < oldsize; idx++) {
+                if (oldentries[idx].name != NULL) {
+                        *nameindex_slot(index,
+                                        oldentries[idx].type,
+                                        oldentries[idx].name) = oldentries[idx];
+                }
+        }
+        free(oldentries);
+
+        return 0;
+}
+
+/* exported interface documented in nameindex.h */
+struct nameindex *nameindex_new(void)
+{
+        struct nameindex *index;
+
+        index = calloc(1, sizeof(struct nameindex));
+        if (index == NULL) {
+                return NULL;
+        }
+
+        if (nameindex_resize(index, NAMEINDEX_INITIAL_SIZE) != 0) {
+                free(index);
+                return NULL;
+        }
+
+        return index;
+}
+
+/* exported interface documented in nameindex.h */
+void nameindex_free(struct nameindex *index)
+{
+        if (index != NULL) {
+                free(index->entries);
+                free(index);
+        }
+}
+
+/* exported interface documented in nameindex.h */
+int nameindex_add(struct nameindex *index, int type, const char *name, void *node)
+{
+        struct nameindex_entry *entry;
+
+        if (name == NULL) {
+                return -1;
+        }
+
+        entry = nameindex_slot(index, type, name);
+        if (entry->name == NULL) {
+                /* keep the table no more than half full */
+                if ((index->count * 2) >= index->size) {
+                        if (nameindex_resize(index, index->size * 2) != 0) {
+                                return -1;
+                        }
+                        entry = nameindex_slot(index, type, name);
+                }
+                entry->name = name;
+                entry->type = type;
+                index->count++;
+        }
+        entry->node = node;
+
+        return 0;
+}
+
+/* exported interface documented in nameindex.h */
+void *nameindex_find(struct nameindex *index, int type, const char *name)
+{
+        if ((index == NULL) || (name == NULL)) {
+                return NULL;
+        }
+
+        return nameindex_slot(index, type, name)->node;
+}
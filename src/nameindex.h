@@ -0,0 +1,54 @@
+/* index of nodes by type and name
+ *
+ * This file is part of nsgenbind.
+ * Licensed under the MIT License,
+ *                http://www.opensource.org/licenses/mit-license.php
+ * Copyright 2026 agent <agent@local>
+ */
+
+#ifndef nsgenbind_nameindex_h
+#define nsgenbind_nameindex_h
+
+/**
+ * hash index mapping a node type and interned name to a node
+ */
+struct nameindex;
+
+/**
+ * create a new empty index
+ *
+ * \return The new index or NULL on allocation failure.
+ */
+struct nameindex *nameindex_new(void);
+
+/**
+ * free an index
+ *
+ * The indexed nodes are not affected.
+ */
+void nameindex_free(struct nameindex *index);
+
+/**
+ * add a node to an index
+ *
+ * Any node previously indexed with the same type and name is replaced.
+ *
+ * \param index The index to add to.
+ * \param type The type of the node.
+ * \param name The interned name of the node.
+ * \param node The node to index.
+ * \return 0 on success else -1 on allocation failure.
+ */
+int nameindex_add(struct nameindex *index, int type, const char *name, void *node);
+
+/**
+ * find a node in an index
+ *
+ * \param index The index to search.
+ * \param type The type of the node.
+ * \param name The interned name of the node.
+ * \return The indexed node or NULL if there is not one.
+ */
+void *nameindex_find(struct nameindex *index, int type, const char *name);
+
+#endif
@@ -17,19 +17,33 @@
 #include <stdarg.h>
 
 #include "utils.h"
+#include "arena.h"
+#include "intern.h"
+#include "nameindex.h"
+#include "depfile.h"
 #include "nsgenbind-ast.h"
 #include "options.h"
+#include "context.h"
 
 /**
  * standard IO handle for parse trace logging.
+ *
+ * The bison trace output has no access to the parse so the handle is
+ * per thread.
  */
-static FILE *genbind_parsetracef;
+static __thread FILE *genbind_parsetracef;
 
 /* parser and lexer interface */
 extern int nsgenbind_debug;
-extern int nsgenbind__flex_debug;
-extern void nsgenbind_restart(FILE*);
-extern int nsgenbind_parse(char *filename, struct genbind_node **genbind_ast);
+extern int nsgenbind_lex_init_extra(struct genbind_parse_ctx *ctx, void **scanner);
+extern int nsgenbind_lex_destroy(void *scanner);
+extern void nsgenbind_set_debug(int debug, void *scanner);
+extern void nsgenbind_scan_begin(struct genb_mapped *input, void *scanner);
+extern void nsgenbind_scan_end(void *scanner);
+extern int nsgenbind_parse(void *scanner,
+                           struct genbind_parse_ctx *ctx,
+                           char *filename,
+                           struct genbind_node **genbind_ast);
 
 /* terminal nodes have a value only */
 struct genbind_node {
@@ -101,15 +115,117 @@ genbind_node_add(struct genbind_node *node, struct genbind_node *list)
 	return node;
 }
 
+/**
+ * get the arena the binding AST is allocated from
+ *
+ * \return The arena or NULL on allocation failure.
+ */
+static struct arena *genbind_get_arena(void)
+{
+        struct genbind_ast_state *ast = &genb_context->genbind;
+
+        if (ast->arena == NULL) {
+                ast->arena = arena_new(0);
+        }
+        return ast->arena;
+}
+
+/**
+ * check a binding AST allocation succeeded
+ *
+ * Failure is recorded in the generator context.
+ */
+static void *genbind_alloc_check(void *res)
+{
+        if (res == NULL) {
+                fprintf(stderr, "Error: binding AST allocation failed\n");
+                genb_context_nomem();
+        }
+        return res;
+}
+
+/* exported interface documented in nsgenbind-ast.h */
+void *genbind_alloc(size_t size)
+{
+        struct arena *arena = genbind_get_arena();
+
+        if (arena == NULL) {
+                return genbind_alloc_check(NULL);
+        }
+        return genbind_alloc_check(arena_alloc(arena, size));
+}
+
+/* exported interface documented in nsgenbind-ast.h */
+char *genbind_strdup(const char *s)
+{
+        struct arena *arena = genbind_get_arena();
+
+        if (arena == NULL) {
+                return genbind_alloc_check(NULL);
+        }
+        return genbind_alloc_check(arena_strdup(arena, s));
+}
+
+/* exported interface documented in nsgenbind-ast.h */
+char *genbind_strndup(const char *s, size_t n)
+{
+        struct arena *arena = genbind_get_arena();
+
+        if (arena == NULL) {
+                return genbind_alloc_check(NULL);
+        }
+        return genbind_alloc_check(arena_strndup(arena, s, n));
+}
+
+/* exported interface documented in nsgenbind-ast.h */
+void genbind_ast_free(void)
+{
+        struct genbind_ast_state *ast = &genb_context->genbind;
+
+        nameindex_free(ast->index);
+        ast->index = NULL;
+        arena_free(ast->arena);
+        ast->arena = NULL;
+        ast->nodec = 0;
+}
+
+/* exported interface documented in nsgenbind-ast.h */
+int genbind_ast_stats(unsigned int *nodec, size_t *used, size_t *allocated)
+{
+        struct genbind_ast_state *ast = &genb_context->genbind;
+        struct arena_stats stats = { 0, 0, 0 };
+
+        if (ast->arena != NULL) {
+                arena_get_stats(ast->arena, &stats);
+        }
+        *nodec = ast->nodec;
+        *used = stats.used;
+        *allocated = stats.allocated;
+
+        return 0;
+}
+
+/* exported interface documented in nsgenbind-ast.h */
 char *genbind_strapp(char *a, char *b)
 {
         char *fullstr;
-        int fulllen;
-        fulllen = strlen(a) + strlen(b) + 1;
-        fullstr = malloc(fulllen);
-        snprintf(fullstr, fulllen, "%s%s", a, b);
-        free(a);
-        free(b);
+        size_t alen;
+        size_t blen;
+
+        if ((a == NULL) || (b == NULL)) {
+                /* a previous allocation failed */
+                return NULL;
+        }
+
+        alen = strlen(a);
+        blen = strlen(b);
+        fullstr = genbind_alloc(alen + blen + 1);
+        if (fullstr == NULL) {
+                return NULL;
+        }
+        memcpy(fullstr, a, alen);
+        memcpy(fullstr + alen, b, blen);
+
         return fullstr;
 }
 
@@ -125,7 +241,11 @@ struct genbind_node *
 genbind_new_node(enum genbind_node_type type, struct genbind_node *l, void *r)
 {
         struct genbind_node *nn;
-        nn = calloc(1, sizeof(struct genbind_node));
+        nn = genbind_alloc(sizeof(struct genbind_node));
+        if (nn == NULL) {
+                return l;
+        }
+        genb_context->genbind.nodec++;
         nn->type = type;
         nn->l = l;
         nn->r.value = r;
@@ -138,7 +258,11 @@ genbind_new_number_node(enum genbind_node_type type,
                         int number)
 {
         struct genbind_node *nn;
-        nn = calloc(1, sizeof(struct genbind_node));
+        nn = genbind_alloc(sizeof(struct genbind_node));
+        if (nn == NULL) {
+                return l;
+        }
+        genb_context->genbind.nodec++;
         nn->type = type;
         nn->l = l;
         nn->r.number = number;
@@ -146,6 +270,95 @@ genbind_new_number_node(enum genbind_node_type type,
 }
 
 
+/* exported interface documented in nsgenbind-ast.h */
+uint64_t genbind_node_hash(struct genbind_node *node, uint64_t hash)
+{
+        struct genbind_node *child;
+        char *text;
+        int *number;
+
+        if (node == NULL) {
+                return hash;
+        }
+
+        hash = genb_hash(hash, &node->type, sizeof(node->type));
+
+        text = genbind_node_gettext(node);
+        if (text != NULL) {
+                /* include the terminator so adjacent text is distinct */
+                return genb_hash(hash, text, strlen(text) + 1);
+        }
+
+        number = genbind_node_getint(node);
+        if (number != NULL) {
+                return genb_hash(hash, number, sizeof(*number));
+        }
+
+        for (child = genbind_node_getnode(node);
+             child != NULL;
+             child = child->l) {
+                hash = genbind_node_hash(child, hash);
+        }
+
+        /* mark the end of the children */
+        return genb_hash(hash, "", 1);
+}
+
+/* exported interface documented in nsgenbind-ast.h */
+void genbind_node_iter_init(struct genbind_node_iter *it, struct genbind_node *node)
+{
+        struct genbind_node *cur;
+        int nodec = 0;
+
+        for (cur = node; cur != NULL; cur = cur->l) {
+                nodec++;
+        }
+
+        it->nodev = it->inlinev;
+        if (nodec > GENBIND_NODE_ITER_INLINE) {
+                it->nodev = malloc(nodec * sizeof(struct genbind_node *));
+                if (it->nodev == NULL) {
+                        /* iterate nothing, the phase fails once complete */
+                        fprintf(stderr, "Error: node iterator allocation failed\n");
+                        genb_context_nomem();
+                        it->nodev = it->inlinev;
+                        it->nodec = 0;
+                        return;
+                }
+        }
+
+        it->nodec = 0;
+        for (cur = node; cur != NULL; cur = cur->l) {
+                it->nodev[it->nodec++] = cur;
+        }
+}
+
+/* exported interface documented in nsgenbind-ast.h */
+struct genbind_node *
+genbind_node_iter_next(struct genbind_node_iter *it, enum genbind_node_type nodetype)
+{
+        struct genbind_node *node;
+
+        /* searches return the node nearest the list tail first */
+        while (it->nodec > 0) {
+                node = it->nodev[--it->nodec];
+                if (node->type == nodetype) {
+                        return node;
+                }
+        }
+        return NULL;
+}
+
+/* exported interface documented in nsgenbind-ast.h */
+void genbind_node_iter_fini(struct genbind_node_iter *it)
+{
+        if (it->nodev != it->inlinev) {
+                free(it->nodev);
+        }
+        it->nodev = it->inlinev;
+        it->nodec = 0;
+}
+
 /* exported interface defined in nsgenbind-ast.h */
 int
 genbind_node_foreach_type(struct genbind_node *node,
@@ -153,29 +366,24 @@ genbind_node_foreach_type(struct genbind_node *node,
                            genbind_callback_t *cb,
                            void *ctx)
 {
-        int ret;
+        struct genbind_node_iter it;
+        struct genbind_node *cur;
+        int ret = 0;
 
         if (node == NULL) {
                 return -1;
         }
-        if (node->l != NULL) {
-                ret = genbind_node_foreach_type(node->l, type, cb, ctx);
+
+        genbind_node_iter_init(&it, node);
+        while ((cur = genbind_node_iter_next(&it, type)) != NULL) {
+                ret = cb(cur, ctx);
                 if (ret != 0) {
-                        return ret;
+                        break;
                 }
         }
-        if (node->type == type) {
-                return cb(node, ctx);
-        }
+        genbind_node_iter_fini(&it);
 
-        return 0;
-}
-
-static int genbind_enumerate_node(struct genbind_node *node, void *ctx)
-{
-	UNUSED(node);
-        (*((int *)ctx))++;
-        return 0;
+        return ret;
 }
 
 /* exported interface defined in nsgenbind-ast.h */
@@ -184,10 +392,13 @@ genbind_node_enumerate_type(struct genbind_node *node,
                             enum genbind_node_type type)
 {
         int count = 0;
-        genbind_node_foreach_type(node,
-                                  type,
-                                  genbind_enumerate_node,
-                                  &count);
+
+        while (node != NULL) {
+                if (node->type == type) {
+                        count++;
+                }
+                node = node->l;
+        }
         return count;
 }
 
@@ -198,24 +409,17 @@ genbind_node_find(struct genbind_node *node,
                   genbind_callback_t *cb,
                   void *ctx)
 {
-        struct genbind_node *ret;
-
-        if ((node == NULL) || (node == prev)) {
-                return NULL;
-        }
+        struct genbind_node *ret = NULL;
 
-        if (node->l != prev) {
-                ret = genbind_node_find(node->l, prev, cb, ctx);
-                if (ret != NULL) {
-                        return ret;
+        /* the match nearest prev (or the list tail) is the result */
+        while ((node != NULL) && (node != prev)) {
+                if (cb(node, ctx) != 0) {
+                        ret = node;
                 }
+                node = node->l;
         }
 
-        if (cb(node, ctx) != 0) {
-                return node;
-        }
-
-        return NULL;
+        return ret;
 }
 
 /* exported interface documented in nsgenbind-ast.h */
@@ -240,6 +444,8 @@ genbind_node_find_type_ident(struct genbind_node *node,
         struct genbind_node *found_node;
         struct genbind_node *ident_node;
 
+        /* identifiers are interned so can be compared by pointer */
+        ident = intern_lookup(ident);
         if (ident == NULL) {
                 return NULL;
         }
@@ -255,7 +461,7 @@ genbind_node_find_type_ident(struct genbind_node *node,
 
                 while (ident_node != NULL) {
                         /* check for matching text */
-                        if (strcmp(ident_node->r.text, ident) == 0) {
+                        if (ident_node->r.text == ident) {
                                 return found_node;
                         }
 
@@ -274,33 +480,80 @@ genbind_node_find_type_ident(struct genbind_node *node,
 
 
 
+/* exported interface documented in nsgenbind-ast.h */
+int genbind_index_add(struct genbind_node *node)
+{
+        struct genbind_ast_state *ast = &genb_context->genbind;
+        struct genbind_node *ident_node;
+
+        ident_node = genbind_node_find_type(genbind_node_getnode(node),
+                                            NULL,
+                                            GENBIND_NODE_TYPE_IDENT);
+        if (ident_node == NULL) {
+                return -1;
+        }
+
+        if (ast->index == NULL) {
+                ast->index = nameindex_new();
+        }
+
+        if ((ast->index == NULL) ||
+            (nameindex_add(ast->index,
+                           node->type,
+                           ident_node->r.text,
+                           node) != 0)) {
+                fprintf(stderr, "Error: binding index allocation failed\n");
+                genb_context_nomem();
+                return -1;
+        }
+
+        return 0;
+}
+
 /* exported interface documented in nsgenbind-ast.h */
 struct genbind_node *
-genbind_node_find_method(struct genbind_node *node,
-                         struct genbind_node *prev,
-                         enum genbind_method_type methodtype)
+genbind_index_find(enum genbind_node_type type, const char *ident)
 {
-        struct genbind_node *res_node;
+        return nameindex_find(genb_context->genbind.index,
+                              type,
+                              intern_lookup(ident));
+}
 
-        res_node = genbind_node_find_type(
-                genbind_node_getnode(node),
-                prev, GENBIND_NODE_TYPE_METHOD);
-        while (res_node != NULL) {
-                struct genbind_node *type_node;
-                enum genbind_method_type *type;
 
-                type_node = genbind_node_find_type(
-                        genbind_node_getnode(res_node),
-                        NULL, GENBIND_NODE_TYPE_METHOD_TYPE);
+/**
+ * check if a method node is of a given method type
+ */
+static bool
+genbind_method_is_type(struct genbind_node *method_node,
+                       enum genbind_method_type methodtype)
+{
+        enum genbind_method_type *type;
 
-                type = (enum genbind_method_type *)genbind_node_getint(type_node);
-                if (*type == methodtype) {
-                        break;
-                }
+        type = (enum genbind_method_type *)genbind_node_getint(
+                genbind_node_find_type(
+                        genbind_node_getnode(method_node),
+                        NULL, GENBIND_NODE_TYPE_METHOD_TYPE));
+
+        return (*type == methodtype);
+}
 
-                res_node = genbind_node_find_type(
-                        genbind_node_getnode(node),
-                        res_node, GENBIND_NODE_TYPE_METHOD);
+/* exported interface documented in nsgenbind-ast.h */
+struct genbind_node *
+genbind_node_find_method(struct genbind_node *node,
+                         struct genbind_node *prev,
+                         enum genbind_method_type methodtype)
+{
+        struct genbind_node *cur;
+        struct genbind_node *res_node = NULL;
+
+        /* single pass keeping the match nearest prev (or the list tail) */
+        for (cur = genbind_node_getnode(node);
+             (cur != NULL) && (cur != prev);
+             cur = cur->l) {
+                if ((cur->type == GENBIND_NODE_TYPE_METHOD) &&
+                    genbind_method_is_type(cur, methodtype)) {
+                        res_node = cur;
+                }
         }
 
         return res_node;
@@ -314,24 +567,33 @@ genbind_node_find_method_ident(struct genbind_node *node,
                                enum genbind_method_type nodetype,
                                const char *ident)
 {
-        struct genbind_node *res_node;
+        struct genbind_node *cur;
+        struct genbind_node *res_node = NULL;
         char *method_ident;
 
-        res_node = genbind_node_find_method(node, prev, nodetype);
-        while (res_node != NULL) {
-              method_ident = genbind_node_gettext(
-                      genbind_node_find_type(
-                              genbind_node_getnode(res_node),
-                              NULL,
-                              GENBIND_NODE_TYPE_IDENT));
+        /* identifiers are interned so can be compared by pointer */
+        ident = intern_lookup(ident);
+        if (ident == NULL) {
+                return NULL;
+        }
+
+        for (cur = genbind_node_getnode(node);
+             (cur != NULL) && (cur != prev);
+             cur = cur->l) {
+                if (cur->type != GENBIND_NODE_TYPE_METHOD) {
+                        continue;
+                }
 
-              if ((ident != NULL) &&
-                  (method_ident != NULL) &&
-                  strcmp(ident, method_ident) == 0) {
-                      break;
-              }
+                method_ident = genbind_node_gettext(
+                        genbind_node_find_type(
+                                genbind_node_getnode(cur),
+                                NULL,
+                                GENBIND_NODE_TYPE_IDENT));
 
-              res_node = genbind_node_find_method(node, res_node, nodetype);
+                if ((method_ident == ident) &&
+                    genbind_method_is_type(cur, nodetype)) {
+                        res_node = cur;
+                }
         }
         return res_node;
 }
@@ -402,6 +664,18 @@ int *genbind_node_getint(struct genbind_node *node)
         return NULL;
 }
 
+/* exported interface documented in nsgenbind-ast.h */
+enum genbind_node_type genbind_node_gettype(struct genbind_node *node)
+{
+        return node->type;
+}
+
+/* exported interface documented in nsgenbind-ast.h */
+struct genbind_node *genbind_node_next(struct genbind_node *node)
+{
+        return node->l;
+}
+
 static const char *genbind_node_type_to_str(enum genbind_node_type type)
 {
         switch(type) {
@@ -514,12 +788,12 @@ int genbind_dump_ast(struct genbind_node *node)
         return 0;
 }
 
-FILE *genbindopen(const char *filename)
+/* exported interface documented in nsgenbind-ast.h */
+FILE *genbindopen(const char *filename, char **basepath)
 {
         FILE *genfile;
         char *fullname;
         int fulllen;
-        static char *prevfilepath = NULL;
 
         /* try filename raw */
         genfile = fopen(filename, "r");
@@ -527,23 +801,24 @@ FILE *genbindopen(const char *filename)
                 if (options->verbose) {
                         printf("Opened Genbind file %s\n", filename);
                 }
-                if (prevfilepath == NULL) {
+                depfile_add_input(filename, DEPFILE_INPUT_BINDING);
+                if (*basepath == NULL) {
                         fullname = strrchr(filename, '/');
                         if (fullname == NULL) {
                                 fulllen = strlen(filename);
                         } else {
                                 fulllen = fullname - filename;
                         }
-                        prevfilepath = strndup(filename,fulllen);
+                        *basepath = strndup(filename,fulllen);
                 }
                 return genfile;
         }
 
         /* try based on previous filename */
-        if (prevfilepath != NULL) {
-                fulllen = strlen(prevfilepath) + strlen(filename) + 2;
+        if (*basepath != NULL) {
+                fulllen = strlen(*basepath) + strlen(filename) + 2;
                 fullname = malloc(fulllen);
-                snprintf(fullname, fulllen, "%s/%s", prevfilepath, filename);
+                snprintf(fullname, fulllen, "%s/%s", *basepath, filename);
                 if (options->verbose) {
                         printf("Attempting to open Genbind file %s\n", fullname);
                 }
@@ -552,6 +827,7 @@ FILE *genbindopen(const char *filename)
                         if (options->verbose) {
                                 printf("Opened Genbind file %s\n", fullname);
                         }
+                        depfile_add_input(fullname, DEPFILE_INPUT_BINDING);
                         free(fullname);
                         return genfile;
                 }
@@ -564,14 +840,11 @@ FILE *genbindopen(const char *filename)
                 fullname = malloc(fulllen);
                 snprintf(fullname, fulllen, "%s/%s", options->idlpath, filename);
                 genfile = fopen(fullname, "r");
-                if ((genfile != NULL) && options->verbose) {
-                        printf("Opend Genbind file %s\n", fullname);
-#if 0
-                        if (options->depfilehandle != NULL) {
-                                fprintf(options->depfilehandle, " \\\n\t%s",
-                                        fullname);
+                if (genfile != NULL) {
+                        if (options->verbose) {
+                                printf("Opend Genbind file %s\n", fullname);
                         }
-#endif
+                        depfile_add_input(fullname, DEPFILE_INPUT_BINDING);
                 }
 
                 free(fullname);
@@ -583,36 +856,72 @@ FILE *genbindopen(const char *filename)
 
 int genbind_parsefile(char *infilename, struct genbind_node **ast)
 {
+        struct genbind_parse_ctx ctx = { NULL, NULL, NULL, NULL, false };
         FILE *infile;
+        struct genb_mapped *input;
+        void *scanner;
         int ret;
 
+        /* the class index only describes the most recently parsed binding */
+        nameindex_free(genb_context->genbind.index);
+        genb_context->genbind.index = NULL;
+
         /* open input file */
-        infile = genbindopen(infilename);
+        infile = genbindopen(infilename, &ctx.basepath);
         if (!infile) {
                 fprintf(stderr, "Error opening %s: %s\n",
                         infilename,
                         strerror(errno));
+                free(ctx.basepath);
+                return 3;
+        }
+
+        input = genb_mapfile(infile);
+        fclose(infile);
+        if (input == NULL) {
+                fprintf(stderr, "Error reading %s: %s\n",
+                        infilename,
+                        strerror(errno));
+                free(ctx.basepath);
+                return 3;
+        }
+
+        if (nsgenbind_lex_init_extra(&ctx, &scanner) != 0) {
+                fprintf(stderr, "Error: unable to create binding scanner\n");
+                genb_unmapfile(input);
+                free(ctx.basepath);
                 return 3;
         }
 
         /* if debugging enabled enable parser tracing and send to file */
         if (options->debug) {
                 nsgenbind_debug = 1;
-                nsgenbind__flex_debug = 1;
+                nsgenbind_set_debug(1, scanner);
                 genbind_parsetracef = genb_fopen("binding-trace", "w");
         } else {
                 genbind_parsetracef = NULL;
         }
 
-        /* set flex to read from file */
-        nsgenbind_restart(infile);
+        /* set flex to scan the mapped file in place */
+        nsgenbind_scan_begin(input, scanner);
 
         /* process binding */
-        ret = nsgenbind_parse(infilename, ast);
+        ret = nsgenbind_parse(scanner, &ctx, infilename, ast);
+        if (ctx.failed) {
+                /* the scanner stopped at an unreadable include */
+                ret = 3;
+        }
+
+        nsgenbind_scan_end(scanner);
+        nsgenbind_lex_destroy(scanner);
+        genb_unmapfile(input);
+        free(ctx.basepath);
+        free(ctx.errtxt);
 
         /* close tracefile if open */
         if (genbind_parsetracef != NULL) {
                 fclose(genbind_parsetracef);
+                genbind_parsetracef = NULL;
         }
 
         return ret;
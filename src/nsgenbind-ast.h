@@ -9,6 +9,14 @@
 #ifndef nsgenbind_nsgenbind_ast_h
 #define nsgenbind_nsgenbind_ast_h
 
+#include <stdbool.h>
+#include <stdint.h>
+
+struct genb_mapped;
+struct YYLTYPE;
+struct arena;
+struct nameindex;
+
 enum genbind_node_type {
         GENBIND_NODE_TYPE_ROOT = 0,
         GENBIND_NODE_TYPE_IDENT, /**< generic identifier string */
@@ -65,10 +73,84 @@ int genbind_fprintf(FILE *stream, const char *format, ...);
 
 int genbind_cmp_node_type(struct genbind_node *node, void *ctx);
 
-FILE *genbindopen(const char *filename);
+/**
+ * open a binding file
+ *
+ * The file is opened as named, then relative to the directory of the
+ * binding being parsed and finally on the IDL path.
+ *
+ * \param filename The name of the file to open.
+ * \param basepath The directory of the binding being parsed, set from
+ *                 filename if it is NULL and the file is opened as named.
+ * \return The opened file or NULL on error.
+ */
+FILE *genbindopen(const char *filename, char **basepath);
+
+/**
+ * state of a single binding file parse
+ *
+ * The scanner and parser are reentrant and keep everything they need
+ * here so parses of different files share no lexer or parser state.
+ */
+struct genbind_parse_ctx {
+        char *basepath; /**< directory of the binding used to locate includes */
+        struct genb_mapped *includes; /**< mapped include files, innermost first */
+        struct YYLTYPE *locations; /**< locations within including files */
+        char *errtxt; /**< text of the last syntax error */
+        bool failed; /**< an include file could not be read */
+};
+
+/**
+ * binding AST held by a generator context
+ */
+struct genbind_ast_state {
+        struct arena *arena; /**< arena all AST nodes and text are allocated from */
+        unsigned int nodec; /**< number of AST nodes allocated */
+        struct nameindex *index; /**< index of classes by name */
+};
 
 int genbind_parsefile(char *infilename, struct genbind_node **ast);
 
+/**
+ * allocate zeroed memory for the AST
+ *
+ * The memory is released by genbind_ast_free() and may not be freed
+ * individually.
+ *
+ * \return The memory or NULL on allocation failure which is recorded in
+ *         the generator context.
+ */
+void *genbind_alloc(size_t size);
+
+/**
+ * duplicate a string into AST memory
+ */
+char *genbind_strdup(const char *s);
+
+/**
+ * duplicate at most n characters of a string into AST memory
+ */
+char *genbind_strndup(const char *s, size_t n);
+
+/**
+ * release all AST nodes and text
+ */
+void genbind_ast_free(void);
+
+/**
+ * get AST memory statistics
+ *
+ * \param nodec Updated with the number of nodes allocated.
+ * \param used Updated with the number of bytes allocated for the AST.
+ * \param allocated Updated with the number of bytes reserved for the AST.
+ */
+int genbind_ast_stats(unsigned int *nodec, size_t *used, size_t *allocated);
+
+/**
+ * concatenate two strings
+ *
+ * \return A new string in AST memory containing a followed by b.
+ */
 char *genbind_strapp(char *a, char *b);
 
 /**
@@ -131,6 +213,56 @@ genbind_node_find_type(struct genbind_node *node,
                        struct genbind_node *prev,
                        enum genbind_node_type nodetype);
 
+/**
+ * update a content hash with a node and all its children
+ *
+ * The siblings of the node are not included.
+ *
+ * @param node The node to hash.
+ * @param hash The hash to update.
+ * @return The updated hash.
+ */
+uint64_t genbind_node_hash(struct genbind_node *node, uint64_t hash);
+
+/** number of nodes an iterator holds without allocating */
+#define GENBIND_NODE_ITER_INLINE 32
+
+/**
+ * cursor over the nodes of a list
+ *
+ * Nodes are returned in the same order as successive calls to
+ * genbind_node_find_type() would return them but the list is only
+ * walked once.
+ */
+struct genbind_node_iter {
+        struct genbind_node **nodev; /**< list nodes in list order */
+        int nodec; /**< number of nodes not yet returned */
+        struct genbind_node *inlinev[GENBIND_NODE_ITER_INLINE];
+};
+
+/**
+ * initialise a cursor over a list of nodes
+ *
+ * @param it The cursor to initialise.
+ * @param node The first node of the list to iterate.
+ */
+void genbind_node_iter_init(struct genbind_node_iter *it, struct genbind_node *node);
+
+/**
+ * get the next node of a type from a cursor
+ *
+ * @param it The cursor to advance.
+ * @param nodetype The type of node to return.
+ * @return The next node of the given type or NULL when there are no more.
+ */
+struct genbind_node *
+genbind_node_iter_next(struct genbind_node_iter *it, enum genbind_node_type nodetype);
+
+/**
+ * release resources held by a cursor
+ */
+void genbind_node_iter_fini(struct genbind_node_iter *it);
+
 /**
  * count how many nodes of a specified type.
  *
@@ -164,6 +296,29 @@ genbind_node_find_type_ident(struct genbind_node *node,
                              enum genbind_node_type nodetype,
                              const char *ident);
 
+/**
+ * add a node to the binding index
+ *
+ * The node is indexed by its type and identifier replacing any previously
+ * indexed node with the same type and identifier so the most recently
+ * added node is found.
+ *
+ * @param node The node to index, usually of type GENBIND_NODE_TYPE_CLASS
+ * @return 0 on success or -1 if the node has no identifier or on
+ *         allocation failure
+ */
+int genbind_index_add(struct genbind_node *node);
+
+/**
+ * find a node in the binding index
+ *
+ * @param type The type of node to find
+ * @param ident The identifier of the node
+ * @return The node or NULL if not found
+ */
+struct genbind_node *
+genbind_index_find(enum genbind_node_type type, const char *ident);
+
 
 /**
  * Find a method node of a given method type
@@ -235,4 +390,18 @@ char *genbind_node_gettext(struct genbind_node *node);
  */
 int *genbind_node_getint(struct genbind_node *node);
 
+/** get a nodes type
+ *
+ * @param node The node to get the type of
+ * @return The type of the node
+ */
+enum genbind_node_type genbind_node_gettype(struct genbind_node *node);
+
+/** get the next sibling of a node
+ *
+ * @param node The node to get the sibling of
+ * @return The next node in the list or NULL at the end of the list.
+ */
+struct genbind_node *genbind_node_next(struct genbind_node *node);
+
 #endif
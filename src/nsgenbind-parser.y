@@ -20,6 +20,9 @@
 
 %code requires {
 
+/* parse state passed to the parser and scanner */
+struct genbind_parse_ctx;
+
 #ifndef YYLTYPE
 /* Bison <3.0 */
 #define YYLTYPE YYLTYPE
@@ -78,6 +81,7 @@ typedef struct YYLTYPE {
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #define YYFPRINTF genbind_fprintf
@@ -87,33 +91,35 @@ typedef struct YYLTYPE {
                   (Loc).last_line,  (Loc).last_column)
 
 #include "utils.h"
-#include "nsgenbind-lexer.h"
 #include "webidl-ast.h"
 #include "nsgenbind-ast.h"
-
-static char *errtxt;
+#include "nsgenbind-lexer.h"
+#include "intern.h"
 
 static void nsgenbind_error(YYLTYPE *locp,
+                            void *scanner,
+                            struct genbind_parse_ctx *ctx,
                             char *filename,
                             struct genbind_node **genbind_ast,
                             const char *str)
 {
         int errlen;
 
+        UNUSED(scanner);
         UNUSED(genbind_ast);
         UNUSED(filename);
 
+        free(ctx->errtxt);
         errlen = snprintf(NULL, 0, "%s:%d:%s",
                           locp->filename, locp->first_line, str);
-        errtxt = malloc(errlen + 1);
-        snprintf(errtxt, errlen + 1, "%s:%d:%s",
+        ctx->errtxt = malloc(errlen + 1);
+        snprintf(ctx->errtxt, errlen + 1, "%s:%d:%s",
                           locp->filename, locp->first_line, str);
 
 }
 
 static struct genbind_node *
-add_method(struct genbind_node **genbind_ast,
-           long methodtype,
+add_method(long methodtype,
            struct genbind_node *declarator,
            char *cdata,
            long lineno,
@@ -149,7 +155,7 @@ add_method(struct genbind_node **genbind_ast,
                                 genbind_new_number_node(GENBIND_NODE_TYPE_LINE,
                                                         cdata_node,
                                                         lineno),
-                                         strdup(filename));
+                                         genbind_strdup(filename));
 
         /* generate method node */
         method_node = genbind_new_node(GENBIND_NODE_TYPE_METHOD,
@@ -158,16 +164,14 @@ add_method(struct genbind_node **genbind_ast,
                                                   location_node,
                                                   methodtype));
 
-        class_node = genbind_node_find_type_ident(*genbind_ast,
-                                                  NULL,
-                                                  GENBIND_NODE_TYPE_CLASS,
-                                                  class_name);
+        class_node = genbind_index_find(GENBIND_NODE_TYPE_CLASS, class_name);
         if (class_node == NULL) {
                 /* no existing class so manufacture one and attach method */
                 res_node = genbind_new_node(GENBIND_NODE_TYPE_CLASS, NULL,
                                       genbind_new_node(GENBIND_NODE_TYPE_IDENT,
                                                        method_node,
                                                        class_name));
+                genbind_index_add(res_node);
         } else {
                 /* update the existing class */
 
@@ -181,6 +185,9 @@ add_method(struct genbind_node **genbind_ast,
 
 }
 
+%lex-param { void *scanner }
+%parse-param { void *scanner }
+%parse-param { struct genbind_parse_ctx *ctx }
 %parse-param { char *filename }
 %parse-param { struct genbind_node **genbind_ast }
 
@@ -272,8 +279,9 @@ Statements:
         |
         error ';'
         {
-                fprintf(stderr, "%s\n", errtxt);
-                free(errtxt);
+                fprintf(stderr, "%s\n", ctx->errtxt);
+                free(ctx->errtxt);
+                ctx->errtxt = NULL;
                 YYABORT ;
         }
         ;
@@ -337,7 +345,7 @@ CTypeSpecifier:
                 $$ = genbind_new_node(GENBIND_NODE_TYPE_NAME,
                                       genbind_new_node(GENBIND_NODE_TYPE_NAME,
                                                        NULL,
-                                                       strdup("unsigned")),
+                                                       intern_string("unsigned")),
                                       $2);
         }
         |
@@ -346,7 +354,7 @@ CTypeSpecifier:
                 $$ = genbind_new_node(GENBIND_NODE_TYPE_NAME,
                                       genbind_new_node(GENBIND_NODE_TYPE_NAME,
                                                        NULL,
-                                                       strdup("struct")),
+                                                       intern_string("struct")),
                                       $2);
         }
         |
@@ -355,7 +363,7 @@ CTypeSpecifier:
                 $$ = genbind_new_node(GENBIND_NODE_TYPE_NAME,
                                       genbind_new_node(GENBIND_NODE_TYPE_NAME,
                                                        NULL,
-                                                       strdup("union")),
+                                                       intern_string("union")),
                                       $2);
         }
         |
@@ -370,7 +378,7 @@ CType:
         |
         CTypeSpecifier '*'
         {
-                $$ = genbind_new_node(GENBIND_NODE_TYPE_NAME, $1, strdup("*"));
+                $$ = genbind_new_node(GENBIND_NODE_TYPE_NAME, $1, intern_string("*"));
         }
 
  /* type and identifier of a variable */
@@ -417,12 +425,12 @@ ParameterList:
 Method:
         MethodType MethodDeclarator CBlock
         {
-                $$ = add_method(genbind_ast, $1, $2, $3, @1.first_line, @1.filename);
+                $$ = add_method($1, $2, $3, @1.first_line, @1.filename);
         }
         |
         MethodType MethodDeclarator ';'
         {
-                $$ = add_method(genbind_ast, $1, $2, NULL, @1.first_line, @1.filename);
+                $$ = add_method($1, $2, NULL, @1.first_line, @1.filename);
         }
         ;
 
@@ -490,12 +498,12 @@ MethodName:
         |
         TOK_METHOD
         {
-                $$ = strdup("method");
+                $$ = intern_string("method");
         }
         |
         TOK_TYPE
         {
-                $$ = strdup("type");
+                $$ = intern_string("type");
         }
         ;
 
@@ -547,6 +555,7 @@ Class:
         {
                 $$ = genbind_new_node(GENBIND_NODE_TYPE_CLASS, NULL,
                         genbind_new_node(GENBIND_NODE_TYPE_IDENT, $4, $2));
+                genbind_index_add($$);
         }
         ;
 
@@ -14,241 +14,344 @@
 #include <getopt.h>
 #include <errno.h>
 
-#include "options.h"
-#include "nsgenbind-ast.h"
-#include "webidl-ast.h"
-#include "ir.h"
-#include "output.h"
-#include "jsapi-libdom.h"
-#include "duk-libdom.h"
-
-struct options *options;
-
-enum bindingtype_e {
-    BINDINGTYPE_UNKNOWN,
-    BINDINGTYPE_JSAPI_LIBDOM,
-    BINDINGTYPE_DUK_LIBDOM,
+#include "nsgenbind.h"
+#include "utils.h"
+#include "stats.h"
+#include "watch.h"
+
+/** largest number of concurrent jobs accepted */
+#define MAX_JOBS 256
+
+/** long option values beyond any short option character */
+enum long_opt {
+        OPT_STATS = 256,
+        OPT_WATCH,
+        OPT_WRITE_IR,
+        OPT_READ_IR,
+        OPT_PROTOTYPE_TABLES,
+        OPT_LAZY_PROTOTYPES,
+        OPT_PRIVATE_LITERAL,
+        OPT_PROTOTYPE_HANDLES,
+        OPT_CLASS_IDS,
+        OPT_BATCH,
 };
 
-static struct options* process_cmdline(int argc, char **argv)
+static const struct option long_options[] = {
+        { "stats", optional_argument, NULL, OPT_STATS },
+        { "watch", no_argument, NULL, OPT_WATCH },
+        { "write-ir", no_argument, NULL, OPT_WRITE_IR },
+        { "read-ir", no_argument, NULL, OPT_READ_IR },
+        { "prototype-tables", no_argument, NULL, OPT_PROTOTYPE_TABLES },
+        { "lazy-prototypes", no_argument, NULL, OPT_LAZY_PROTOTYPES },
+        { "private-literal", no_argument, NULL, OPT_PRIVATE_LITERAL },
+        { "prototype-handles", no_argument, NULL, OPT_PROTOTYPE_HANDLES },
+        { "class-ids", no_argument, NULL, OPT_CLASS_IDS },
+        { "batch", no_argument, NULL, OPT_BATCH },
+        { NULL, 0, NULL, 0 },
+};
+
+/**
+ * process the command line into a generator configuration
+ *
+ * \param argc The number of arguments.
+ * \param argv The arguments.
+ * \param config Updated with the configuration.
+ * \param bindingv_out Updated with the bindings to generate.
+ * \param bindingc_out Updated with the number of bindings.
+ * \return 0 on success else -1 and an error message is printed.
+ */
+static int
+process_cmdline(int argc,
+                char **argv,
+                struct nsgenbind_config *config,
+                struct nsgenbind_binding **bindingv_out,
+                unsigned int *bindingc_out)
 {
         int opt;
+        unsigned int idx;
+        struct nsgenbind_binding *bindingv;
+        unsigned int bindingc;
+        bool batch = false;
+        long jobs;
+        char *end;
 
-        options = calloc(1,sizeof(struct options));
-        if (options == NULL) {
-                fprintf(stderr, "Allocation error\n");
-                return NULL;
-        }
+        memset(config, 0, sizeof(struct nsgenbind_config));
 
-        while ((opt = getopt(argc, argv, "vngDW::I:")) != -1) {
+        while ((opt = getopt_long(argc, argv, "vngDW::I:j:M:C:",
+                                  long_options, NULL)) != -1) {
                 switch (opt) {
                 case 'I':
-                        options->idlpath = strdup(optarg);
+                        config->idlpath = optarg;
+                        break;
+
+                case 'j':
+                        jobs = strtol(optarg, &end, 10);
+                        if ((end == optarg) || (*end != 0) ||
+                            (jobs < 1) || (jobs > MAX_JOBS)) {
+                                fprintf(stderr,
+                                        "Error: jobs must be a number from 1 to %d\n",
+                                        MAX_JOBS);
+                                return -1;
+                        }
+                        config->jobs = jobs;
+                        break;
+
+                case 'M':
+                        config->depfilename = optarg;
+                        break;
+
+                case 'C':
+                        config->cachedir = optarg;
+                        break;
+
+                case OPT_STATS:
+                        config->stats = true;
+                        if (optarg != NULL) {
+                                config->statsfilename = optarg;
+                        }
+                        break;
+
+                case OPT_WATCH:
+                        config->watch = true;
+                        break;
+
+                case OPT_WRITE_IR:
+                        config->write_ir = true;
+                        break;
+
+                case OPT_READ_IR:
+                        config->read_ir = true;
+                        break;
+
+                case OPT_PROTOTYPE_TABLES:
+                        config->prototype_tables = true;
+                        break;
+
+                case OPT_LAZY_PROTOTYPES:
+                        config->lazy_prototypes = true;
+                        break;
+
+                case OPT_PRIVATE_LITERAL:
+                        config->private_literal = true;
+                        break;
+
+                case OPT_PROTOTYPE_HANDLES:
+                        config->prototype_handles = true;
+                        break;
+
+                case OPT_CLASS_IDS:
+                        config->class_ids = true;
+                        break;
+
+                case OPT_BATCH:
+                        batch = true;
                         break;
 
                 case 'v':
-                        options->verbose = true;
+                        config->verbose = true;
                         break;
 
                 case 'n':
-                        options->dryrun = true;
+                        config->dryrun = true;
                         break;
 
                 case 'D':
-                        options->debug = true;
+                        config->debug = true;
                         break;
 
                 case 'g':
-                        options->dbglog = true;
+                        config->dbglog = true;
                         break;
 
                 case 'W':
                         if ((optarg == NULL) ||
                             (strcmp(optarg, "all") == 0)) {
                                 /* all warnings */
-                                options->warnings |= WARNING_ALL;
+                                config->warnings |= NSGENBIND_WARNING_ALL;
                         } else if (strcmp(optarg, "unimplemented") == 0) {
-                                options->warnings |= WARNING_UNIMPLEMENTED;
+                                config->warnings |= NSGENBIND_WARNING_UNIMPLEMENTED;
                         } else if (strcmp(optarg, "duplicated") == 0) {
-                                options->warnings |= WARNING_DUPLICATED;
+                                config->warnings |= NSGENBIND_WARNING_DUPLICATED;
                         } else if (strcmp(optarg, "generated") == 0) {
-                                options->warnings |= WARNING_GENERATED;
+                                config->warnings |= NSGENBIND_WARNING_GENERATED;
                         } else {
                                 fprintf(stderr,
                                         "Unknown warning option \"%s\" valid options are: all, unimplemented,\n"
                                         "                                                 duplicated, generated\n",
                                         optarg);
-                                free(options);
-                                return NULL;
+                                return -1;
 
                         }
                         break;
 
                 default: /* '?' */
                         fprintf(stderr,
-                             "Usage: %s [-v] [-g] [-D] [-W] [-I idlpath] inputfile outputdir\n",
-                                argv[0]);
-                        free(options);
-                        return NULL;
+                             "Usage: %s [-v] [-g] [-D] [-W] [-I idlpath] [-j jobs] [-M depfile] [-C cachedir] [--stats[=file]] [--watch] [--write-ir] [--read-ir] [--prototype-tables] [--lazy-prototypes] [--private-literal] [--prototype-handles] [--class-ids] inputfile outputdir\n"
+                             "       %s [options] --batch inputfile:outputdir [inputfile:outputdir...]\n",
+                                argv[0], argv[0]);
+                        return -1;
                 }
         }
 
-        if (optind > (argc - 2)) {
+        if (optind >= argc) {
                 fprintf(stderr,
                        "Error: expected input filename and output directory\n");
-                free(options);
-                return NULL;
+                return -1;
         }
 
-        options->infilename = strdup(argv[optind]);
-
-        options->outdirname = strdup(argv[optind + 1]);
-
-        return options;
-
-}
-
-static int webidl_file_cb(struct genbind_node *node, void *ctx)
-{
-	struct webidl_node **webidl_ast = ctx;
-	char *filename;
-
-	filename = genbind_node_gettext(node);
+        if (!batch) {
+                /* single binding as input filename and output directory */
+                if (optind != (argc - 2)) {
+                        fprintf(stderr,
+                                "Error: expected input filename and output directory\n");
+                        return -1;
+                }
+                bindingc = 1;
+                bindingv = calloc(1, sizeof(struct nsgenbind_binding));
+                if (bindingv == NULL) {
+                        fprintf(stderr, "Allocation error\n");
+                        return -1;
+                }
+                bindingv[0].infilename = argv[optind];
+                bindingv[0].outdirname = argv[optind + 1];
+        } else {
+                /* one or more binding:outdir pairs, the output directory
+                 * follows the last colon so binding filenames may
+                 * contain colons
+                 */
+                bindingc = argc - optind;
+                bindingv = calloc(bindingc, sizeof(struct nsgenbind_binding));
+                if (bindingv == NULL) {
+                        fprintf(stderr, "Allocation error\n");
+                        return -1;
+                }
+                for (idx = 0; idx < bindingc; idx++) {
+                        char *sep;
 
-        if (options->verbose) {
-                printf("Opening IDL file \"%s\"\n", filename);
+                        sep = strrchr(argv[optind + idx], ':');
+                        if ((sep == NULL) ||
+                            (sep == argv[optind + idx]) ||
+                            (sep[1] == 0)) {
+                                fprintf(stderr,
+                                        "Error: expected binding:outdir not \"%s\"\n",
+                                        argv[optind + idx]);
+                                free(bindingv);
+                                return -1;
+                        }
+                        /* the binding name is terminated in place */
+                        *sep = 0;
+                        bindingv[idx].infilename = argv[optind + idx];
+                        bindingv[idx].outdirname = sep + 1;
+                }
         }
 
-	return webidl_parsefile(filename, webidl_ast);
+        *bindingv_out = bindingv;
+        *bindingc_out = bindingc;
+
+        return 0;
 }
 
-static int genbind_load_idl(struct genbind_node *genbind,
-                            struct webidl_node **webidl_out)
+static int
+watch_input_cb(const char *fname, enum nsgenbind_input_type type, void *pw)
 {
-        int res;
-        struct genbind_node *binding_node;
-
-        binding_node = genbind_node_find_type(genbind, NULL,
-                                              GENBIND_NODE_TYPE_BINDING);
-
-	/* walk AST and load any web IDL files required */
-	res = genbind_node_foreach_type(
-                genbind_node_getnode(binding_node),
-                GENBIND_NODE_TYPE_WEBIDL,
-                webidl_file_cb,
-                webidl_out);
-	if (res != 0) {
-		fprintf(stderr, "Error: failed reading Web IDL\n");
-		return -1;
-	}
-
-        /* implements are implemented as mixins so intercalate them */
-        res = webidl_intercalate_implements(*webidl_out);
-	if (res != 0) {
-		fprintf(stderr, "Error: Failed to intercalate implements\n");
-		return -1;
-	}
-
-        return 0;
+        UNUSED(pw);
+        return watch_add(fname, type);
 }
 
 /**
- * get the type of binding
+ * regenerate the bindings whenever their inputs change
+ *
+ * The Web IDL is kept loaded unless an IDL file changed, the previous
+ * generation failed or the interned binding strings have grown enough
+ * that generation reloads it. Bindings are always parsed again which is
+ * cheap and the manifest in each output directory limits regeneration
+ * to the entries whose inputs changed.
+ *
+ * \param ctx The generator context.
+ * \param bindingc The number of bindings.
+ * \param bindingv The bindings to generate.
+ * \param res The result of the initial generation.
+ * \return The program exit code if watching fails, otherwise never returns.
  */
-static enum bindingtype_e genbind_get_type(struct genbind_node *node)
+static int
+watch_bindings(struct nsgenbind_ctx *ctx,
+               unsigned int bindingc,
+               const struct nsgenbind_binding *bindingv,
+               int res)
 {
-        struct genbind_node *binding_node;
-        const char *binding_type;
-
-        binding_node = genbind_node_find_type(node,
-                                              NULL,
-                                              GENBIND_NODE_TYPE_BINDING);
-        if (binding_node == NULL) {
-            /* binding entry is missing which is invalid */
-            return BINDINGTYPE_UNKNOWN;
-        }
+        unsigned int idx;
+        bool idl;
+        struct stats_time start;
+        struct stats_time end;
 
-        binding_type = genbind_node_gettext(
-                genbind_node_find_type(
-                        genbind_node_getnode(binding_node),
-                        NULL,
-                        GENBIND_NODE_TYPE_NAME));
-        if (binding_type == NULL) {
-                fprintf(stderr, "Error: missing binding type\n");
-                return BINDINGTYPE_UNKNOWN;
+        if (watch_init() != 0) {
+                return 10;
         }
 
-        if (strcmp(binding_type, "jsapi_libdom") == 0) {
-                return BINDINGTYPE_JSAPI_LIBDOM;
-        }
+        for (;;) {
+                /* watch every input read so far */
+                for (idx = 0; idx < bindingc; idx++) {
+                        if (watch_add(bindingv[idx].infilename,
+                                      NSGENBIND_INPUT_BINDING) != 0) {
+                                return 10;
+                        }
+                }
+                if (nsgenbind_foreach_input(ctx, watch_input_cb, NULL) != 0) {
+                        return 10;
+                }
 
-        if (strcmp(binding_type, "duk_libdom") == 0) {
-                return BINDINGTYPE_DUK_LIBDOM;
-        }
+                if (watch_wait(&idl) != 0) {
+                        return 10;
+                }
+                stats_time_start(&start);
+
+                /* anything left after a failure may be incomplete */
+                if ((res != 0) || idl) {
+                        nsgenbind_reset(ctx);
+                }
 
-        fprintf(stderr, "Error: unsupported binding type \"%s\"\n", binding_type);
+                res = nsgenbind_generate(ctx, bindingc, bindingv);
 
-        return BINDINGTYPE_UNKNOWN;
+                stats_time_start(&end);
+                if (res == 0) {
+                        printf("Generated in %.1fms\n",
+                               ((double)(end.wall.tv_sec - start.wall.tv_sec) * 1000.0) +
+                               ((double)(end.wall.tv_nsec - start.wall.tv_nsec) / 1000000.0));
+                } else {
+                        printf("Generation failed with code %d\n", res);
+                }
+                fflush(stdout);
+        }
 }
 
 int main(int argc, char **argv)
 {
         int res;
-        struct genbind_node *genbind_root = NULL;
-        struct webidl_node *webidl_root = NULL;
-        struct ir *ir = NULL;
-        enum bindingtype_e bindingtype;
+        struct nsgenbind_config config;
+        struct nsgenbind_binding *bindingv;
+        unsigned int bindingc;
+        struct nsgenbind_ctx *ctx;
 
-        options = process_cmdline(argc, argv);
-        if (options == NULL) {
-                return 1; /* bad commandline */
-        }
-
-        /* parse binding */
-        res = genbind_parsefile(options->infilename, &genbind_root);
+        res = process_cmdline(argc, argv, &config, &bindingv, &bindingc);
         if (res != 0) {
-                fprintf(stderr, "Error: parse failed with code %d\n", res);
-                return res;
-        }
-
-        /* dump the binding AST */
-        genbind_dump_ast(genbind_root);
-
-        /* get type of binding */
-        bindingtype = genbind_get_type(genbind_root);
-        if (bindingtype == BINDINGTYPE_UNKNOWN) {
-                return 3;
+                return 1; /* bad commandline */
         }
 
-        /* load the IDL files specified in the binding */
-        res = genbind_load_idl(genbind_root, &webidl_root);
+        res = nsgenbind_create(&config, &ctx);
         if (res != 0) {
-                return 4;
+                free(bindingv);
+                return 1;
         }
 
-	/* debug dump of web idl AST */
-        webidl_dump_ast(webidl_root);
+        res = nsgenbind_generate(ctx, bindingc, bindingv);
 
-        /* generate intermediate representation */
-        res = ir_new(genbind_root, webidl_root, &ir);
-        if (res != 0) {
-                return 5;
+        if (config.watch) {
+                res = watch_bindings(ctx, bindingc, bindingv, res);
+                watch_free();
         }
 
-        /* dump the intermediate representation */
-        ir_dump(ir);
-        ir_dumpdot(ir);
-
-        /* generate binding */
-        switch (bindingtype) {
-        case BINDINGTYPE_DUK_LIBDOM:
-                res = duk_libdom_output(ir);
-                break;
-
-        default:
-                fprintf(stderr, "Unable to generate binding of this type\n");
-                res = 7;
-        }
+        nsgenbind_destroy(ctx);
+        free(bindingv);
 
         return res;
 }
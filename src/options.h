@@ -9,34 +9,67 @@
 #ifndef nsgenbind_options_h
 #define nsgenbind_options_h
 
-/** global options */
-struct options {
+#include "nsgenbind.h"
+
+/** binding source and the directory its output is generated in */
+struct options_binding {
 	char *infilename; /**< binding source */
 	char *outdirname; /**< output directory */
+};
+
+/** generator options */
+struct options {
+	char *infilename; /**< binding source being processed */
+	char *outdirname; /**< output directory being generated */
+	struct options_binding *bindingv; /**< bindings to generate */
+	unsigned int bindingc; /**< number of bindings to generate */
 	char *idlpath; /**< path to IDL files */
+	char *depfilename; /**< dependency file to write or NULL */
+	char *cachedir; /**< parsed IDL cache directory or NULL */
+	char *statsfilename; /**< statistics file or NULL for stderr */
 
 	bool verbose; /**< verbose processing */
 	bool debug; /**< debug enabled */
 	bool dbglog; /**< embed debug logging in output */
         bool dryrun; /**< output is not generated */
+	bool stats; /**< report processing statistics */
+	bool watch; /**< regenerate when inputs change */
+	bool write_ir; /**< save intermediate representation with output */
+	bool read_ir; /**< inputs are saved intermediate representations */
+	bool prototype_tables; /**< populate prototypes from static tables */
+	bool lazy_prototypes; /**< create prototypes on first use */
+	bool private_literal; /**< access private pointers by literal key */
+	bool prototype_handles; /**< get prototypes from cached heap pointers */
+	bool class_ids; /**< identify instances by class identifier */
+
+	unsigned int jobs; /**< number of concurrent parse and output jobs */
 
 	unsigned int warnings; /**< warning flags */
 };
 
-extern struct options *options;
+/**
+ * options of the calling thread's generator context
+ *
+ * The options are set from the generator context configuration before
+ * any processing starts and must be treated as read only afterwards as
+ * they are accessed concurrently by output generation jobs. The only exception is the
+ * binding being processed which is changed between bindings while no
+ * output generation jobs are running.
+ */
+extern __thread struct options *options;
 
 enum opt_warnings {
-	WARNING_UNIMPLEMENTED = 1,
-	WARNING_DUPLICATED = 2,
-	WARNING_WEBIDL = 4,
-	WARNING_GENERATED = 8,
+	WARNING_UNIMPLEMENTED = NSGENBIND_WARNING_UNIMPLEMENTED,
+	WARNING_DUPLICATED = NSGENBIND_WARNING_DUPLICATED,
+	WARNING_WEBIDL = NSGENBIND_WARNING_WEBIDL,
+	WARNING_GENERATED = NSGENBIND_WARNING_GENERATED,
 };
 
-#define WARNING_ALL (WARNING_UNIMPLEMENTED | WARNING_DUPLICATED | WARNING_WEBIDL)
+#define WARNING_ALL NSGENBIND_WARNING_ALL
 
 #define WARN(flags, msg, args...) do {			\
 		if ((options->warnings & flags) != 0) {			\
-			fprintf(stderr, "%s: warning: "msg"\n", __func__, ## args); \
+			genb_diagf("%s: warning: "msg"\n", __func__, ## args); \
 		}							\
 	} while(0)
 
@@ -8,18 +8,77 @@
 
 #include <stdio.h>
 #include <stdarg.h>
+#include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "utils.h"
 #include "output.h"
 
+/**
+ * allocation increment for output data
+ */
+#define OUTPUT_DATA_CHUNK (64*1024)
+
 struct opctx {
     char *filename;
-    FILE *outf;
+    char *data; /**< output file content */
+    size_t datalen; /**< length of output content */
+    size_t dataalloc; /**< allocated size of data */
     unsigned int lineno;
+    bool failed; /**< output was lost as the content could not grow */
 };
 
+/**
+ * ensure there is space in the output content for additional data
+ *
+ * \param opctx The output context.
+ * \param len The length of the additional data.
+ * \return 0 on success else -1 on allocation failure.
+ */
+static int output_reserve(struct opctx *opctx, size_t len)
+{
+        size_t nalloc;
+        char *ndata;
+
+        if ((opctx->datalen + len) <= opctx->dataalloc) {
+                return 0;
+        }
+
+        nalloc = opctx->dataalloc * 2;
+        if (nalloc < (opctx->datalen + len + OUTPUT_DATA_CHUNK)) {
+                nalloc = opctx->datalen + len + OUTPUT_DATA_CHUNK;
+        }
+        ndata = realloc(opctx->data, nalloc);
+        if (ndata == NULL) {
+                opctx->failed = true;
+                return -1;
+        }
+        opctx->data = ndata;
+        opctx->dataalloc = nalloc;
+
+        return 0;
+}
+
+/**
+ * count the newlines in a block of output
+ *
+ * uses memchr which the C library provides optimised word at a time or
+ * vector implementations of.
+ */
+static unsigned int output_count_lines(const char *data, size_t len)
+{
+        const char *end = data + len;
+        unsigned int lines = 0;
+
+        while ((data = memchr(data, '\n', end - data)) != NULL) {
+                lines++;
+                data++;
+        }
+
+        return lines;
+}
+
 int output_open(const char *filename, struct opctx **opctx_out)
 {
         struct opctx *opctx;
@@ -35,15 +94,18 @@ int output_open(const char *filename, struct opctx **opctx_out)
                 return -1;
         }
 
-        /* open output file */
-        opctx->outf = genb_fopen_tmp(opctx->filename);
-        if (opctx->outf == NULL) {
+        /* output is accumulated and written to the file on close */
+        opctx->datalen = 0;
+        opctx->dataalloc = OUTPUT_DATA_CHUNK;
+        opctx->data = malloc(opctx->dataalloc);
+        if (opctx->data == NULL) {
                 free(opctx->filename);
                 free(opctx);
                 return -1;
         }
 
         opctx->lineno = 2;
+        opctx->failed = false;
         *opctx_out = opctx;
 
         return 0;
@@ -52,35 +114,61 @@ int output_open(const char *filename, struct opctx **opctx_out)
 int output_close(struct opctx *opctx)
 {
         int res;
-        res = genb_fclose_tmp(opctx->outf, opctx->filename);
+
+        if (opctx->failed) {
+                /* never replace a file with truncated content */
+                fprintf(stderr, "Error: unable to generate %s\n",
+                        opctx->filename);
+                res = -1;
+        } else {
+                res = genb_fupdate(opctx->filename,
+                                   opctx->data,
+                                   opctx->datalen);
+        }
+        free(opctx->data);
         free(opctx->filename);
         free(opctx);
         return res;
 }
 
-/**
- * buffer to hold formatted output so newlines can be counted
- */
-static char output_buffer[128*1024];
-
 int outputf(struct opctx *opctx, const char *fmt, ...)
 {
         va_list ap;
         int res;
-        int idx;
+        size_t avail;
 
+        avail = opctx->dataalloc - opctx->datalen;
+
+        /* format directly into the output content */
         va_start(ap, fmt);
-        res = vsnprintf(output_buffer, sizeof(output_buffer), fmt, ap);
+        res = vsnprintf(opctx->data + opctx->datalen, avail, fmt, ap);
         va_end(ap);
+        if (res < 0) {
+                opctx->failed = true;
+                return res;
+        }
 
-        /* account for newlines in output */
-        for (idx = 0; idx < res; idx++) {
-                if (output_buffer[idx] == '\n') {
-                        opctx->lineno++;
+        if ((size_t)res >= avail) {
+                /* insufficient space, extend the content and retry */
+                if (output_reserve(opctx, res + 1) != 0) {
+                        return -1;
+                }
+
+                va_start(ap, fmt);
+                res = vsnprintf(opctx->data + opctx->datalen,
+                                opctx->dataalloc - opctx->datalen,
+                                fmt, ap);
+                va_end(ap);
+                if (res < 0) {
+                        opctx->failed = true;
+                        return res;
                 }
         }
 
-        fwrite(output_buffer, 1, res, opctx->outf);
+        /* account for newlines in output */
+        opctx->lineno += output_count_lines(opctx->data + opctx->datalen, res);
+
+        opctx->datalen += res;
 
         return res;
 }
@@ -90,17 +178,18 @@ int outputc(struct opctx *opctx, int c)
         if (c == '\n') {
                 opctx->lineno++;
         }
-        fputc(c, opctx->outf);
+
+        if (output_reserve(opctx, 1) != 0) {
+                return -1;
+        }
+        opctx->data[opctx->datalen++] = c;
 
         return 0;
 }
 
 int output_line(struct opctx *opctx)
 {
-        int res;
-        res = fprintf(opctx->outf,
-                      "#line %d \"%s\"\n",
-                      opctx->lineno, opctx->filename);
-        opctx->lineno++;
-        return res;
+        return outputf(opctx,
+                       "#line %d \"%s\"\n",
+                       opctx->lineno, opctx->filename);
 }
@@ -24,6 +24,11 @@ int output_open(const char *filename, struct opctx **opctx_out);
 
 /**
  * close output file and free context
+ *
+ * The file is not written if any output to the context failed.
+ *
+ * \param opctx The output context.
+ * \return 0 on success else -1 if the output failed or could not be written.
  */
 int output_close(struct opctx *opctx);
 
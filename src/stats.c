@@ -0,0 +1,208 @@
+/* processing statistics implementation
+ *
+ * This file is part of nsgenbind.
+ * Licensed under the MIT License,
+ *                http://www.opensource.org/licenses/mit-license.php
+ * Copyright 2026 agent <agent@local>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+#include "options.h"
+#include "context.h"
+#include "stats.h"
+
+/** names of output counters in the order they are reported */
+static const char *counter_names[STATS_COUNTER_COUNT] = {
+        "files_written",
+        "bytes_written",
+        "files_unchanged",
+        "bytes_unchanged",
+        "files_skipped",
+};
+
+static double timespec_diff(struct timespec *end, struct timespec *start)
+{
+        return (double)(end->tv_sec - start->tv_sec) +
+                ((double)(end->tv_nsec - start->tv_nsec) / 1000000000.0);
+}
+
+static struct stats_entry *stats_list_add(struct stats_list *list, const char *name)
+{
+        struct stats_entry *entryv;
+
+        if (list->entryc == list->alloc) {
+                entryv = realloc(list->entryv,
+                                 (list->alloc + 16) *
+                                 sizeof(struct stats_entry));
+                if (entryv == NULL) {
+                        return NULL;
+                }
+                list->entryv = entryv;
+                list->alloc += 16;
+        }
+
+        entryv = list->entryv + list->entryc++;
+        memset(entryv, 0, sizeof(struct stats_entry));
+        entryv->name = name;
+
+        return entryv;
+}
+
+/* exported interface documented in stats.h */
+int stats_init(struct stats_state *stats)
+{
+        memset(stats, 0, sizeof(struct stats_state));
+
+        if (pthread_mutex_init(&stats->lock, NULL) != 0) {
+                return -1;
+        }
+        return 0;
+}
+
+/* exported interface documented in stats.h */
+void stats_fini(struct stats_state *stats)
+{
+        free(stats->phases.entryv);
+        free(stats->counts.entryv);
+        pthread_mutex_destroy(&stats->lock);
+}
+
+/* exported interface documented in stats.h */
+void stats_time_start(struct stats_time *start)
+{
+        clock_gettime(CLOCK_MONOTONIC, &start->wall);
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &start->cpu);
+}
+
+/* exported interface documented in stats.h */
+void stats_phase(const char *name, struct stats_time *start)
+{
+        struct stats_time end;
+        struct stats_entry *entry;
+
+        if (!options->stats) {
+                return;
+        }
+
+        stats_time_start(&end);
+
+        entry = stats_list_add(&genb_context->stats.phases, name);
+        if (entry != NULL) {
+                entry->wall = timespec_diff(&end.wall, &start->wall);
+                entry->cpu = timespec_diff(&end.cpu, &start->cpu);
+        }
+}
+
+/* exported interface documented in stats.h */
+void stats_count(const char *name, uint64_t value)
+{
+        struct stats_entry *entry;
+
+        if (!options->stats) {
+                return;
+        }
+
+        entry = stats_list_add(&genb_context->stats.counts, name);
+        if (entry != NULL) {
+                entry->value = value;
+        }
+}
+
+/* exported interface documented in stats.h */
+void stats_add(enum stats_counter counter, uint64_t value)
+{
+        struct stats_state *stats = &genb_context->stats;
+
+        pthread_mutex_lock(&stats->lock);
+        stats->counters[counter] += value;
+        pthread_mutex_unlock(&stats->lock);
+}
+
+/* exported interface documented in stats.h */
+int stats_write(const char *fname)
+{
+        struct stats_state *stats = &genb_context->stats;
+        FILE *statsf;
+        struct rusage usage;
+        unsigned int idx;
+        int res = 0;
+
+        if (fname == NULL) {
+                statsf = stderr;
+        } else {
+                statsf = fopen(fname, "w");
+                if (statsf == NULL) {
+                        fprintf(stderr, "Error: unable to open %s (%s)\n",
+                                fname, strerror(errno));
+                        return -1;
+                }
+        }
+
+        fprintf(statsf, "{\n  \"phases\": [");
+        for (idx = 0; idx < stats->phases.entryc; idx++) {
+                fprintf(statsf,
+                        "%s\n    { \"name\": \"%s\", \"wall\": %.6f, \"cpu\": %.6f }",
+                        (idx == 0) ? "" : ",",
+                        stats->phases.entryv[idx].name,
+                        stats->phases.entryv[idx].wall,
+                        stats->phases.entryv[idx].cpu);
+        }
+        fprintf(statsf, "\n  ],\n  \"counts\": {");
+        for (idx = 0; idx < stats->counts.entryc; idx++) {
+                fprintf(statsf,
+                        "%s\n    \"%s\": %" PRIu64,
+                        (idx == 0) ? "" : ",",
+                        stats->counts.entryv[idx].name,
+                        stats->counts.entryv[idx].value);
+        }
+        fprintf(statsf, "\n  },\n  \"output\": {");
+        for (idx = 0; idx < STATS_COUNTER_COUNT; idx++) {
+                fprintf(statsf,
+                        "%s\n    \"%s\": %" PRIu64,
+                        (idx == 0) ? "" : ",",
+                        counter_names[idx],
+                        stats->counters[idx]);
+        }
+        fprintf(statsf, "\n  }");
+
+        /* linux reports the maximum resident set size in kilobytes */
+        if (getrusage(RUSAGE_SELF, &usage) == 0) {
+                fprintf(statsf, ",\n  \"peak_rss_kb\": %ld", usage.ru_maxrss);
+        }
+        fprintf(statsf, "\n}\n");
+
+        if (fname != NULL) {
+                if (fclose(statsf) != 0) {
+                        fprintf(stderr, "Error: unable to write %s (%s)\n",
+                                fname, strerror(errno));
+                        res = -1;
+                }
+        } else {
+                fflush(statsf);
+        }
+
+        return res;
+}
+
+/* exported interface documented in stats.h */
+void stats_free(void)
+{
+        struct stats_state *stats = &genb_context->stats;
+
+        free(stats->phases.entryv);
+        memset(&stats->phases, 0, sizeof(stats->phases));
+        free(stats->counts.entryv);
+        memset(&stats->counts, 0, sizeof(stats->counts));
+        memset(stats->counters, 0, sizeof(stats->counters));
+}
@@ -0,0 +1,129 @@
+/* processing statistics
+ *
+ * This file is part of nsgenbind.
+ * Licensed under the MIT License,
+ *                http://www.opensource.org/licenses/mit-license.php
+ * Copyright 2026 agent <agent@local>
+ */
+
+#ifndef nsgenbind_stats_h
+#define nsgenbind_stats_h
+
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+
+/**
+ * counters updated while output is generated
+ */
+enum stats_counter {
+        STATS_FILES_WRITTEN, /**< files written */
+        STATS_BYTES_WRITTEN, /**< bytes written */
+        STATS_FILES_UNCHANGED, /**< files generated with unchanged content */
+        STATS_BYTES_UNCHANGED, /**< bytes generated with unchanged content */
+        STATS_FILES_SKIPPED, /**< files not generated as inputs unchanged */
+        STATS_COUNTER_COUNT,
+};
+
+/**
+ * recorded phase or count
+ */
+struct stats_entry {
+        const char *name; /**< name of phase or count */
+        double wall; /**< phase wall clock seconds */
+        double cpu; /**< phase cpu seconds */
+        uint64_t value; /**< count value */
+};
+
+/**
+ * list of recorded entries
+ */
+struct stats_list {
+        struct stats_entry *entryv; /**< entries in the order recorded */
+        unsigned int entryc; /**< number of entries */
+        unsigned int alloc; /**< allocated size of entryv */
+};
+
+/**
+ * statistics recorded by a generator context
+ */
+struct stats_state {
+        struct stats_list phases; /**< phase timings */
+        struct stats_list counts; /**< named counts */
+        uint64_t counters[STATS_COUNTER_COUNT]; /**< output counters */
+        pthread_mutex_t lock; /**< serialises counter updates from concurrent output jobs */
+};
+
+/**
+ * start time of a phase
+ */
+struct stats_time {
+        struct timespec wall; /**< monotonic wall clock time */
+        struct timespec cpu; /**< process cpu time */
+};
+
+/**
+ * initialise empty statistics
+ *
+ * \param stats The statistics to initialise.
+ * \return 0 on success else -1.
+ */
+int stats_init(struct stats_state *stats);
+
+/**
+ * release recorded statistics
+ *
+ * \param stats The statistics to finalise.
+ */
+void stats_fini(struct stats_state *stats);
+
+/**
+ * note the start time of a phase
+ *
+ * \param start Updated with the current time.
+ */
+void stats_time_start(struct stats_time *start);
+
+/**
+ * record the time taken by a phase
+ *
+ * Nothing is recorded unless statistics were requested. Phases are
+ * reported in the order they are recorded.
+ *
+ * \param name The name of the phase which must remain valid.
+ * \param start The time the phase started.
+ */
+void stats_phase(const char *name, struct stats_time *start);
+
+/**
+ * record a named count
+ *
+ * \param name The name of the count which must remain valid.
+ * \param value The value of the count.
+ */
+void stats_count(const char *name, uint64_t value);
+
+/**
+ * add to a counter
+ *
+ * May be called concurrently from output generation jobs.
+ *
+ * \param counter The counter to add to.
+ * \param value The amount to add.
+ */
+void stats_add(enum stats_counter counter, uint64_t value);
+
+/**
+ * write the recorded statistics as a JSON object
+ *
+ * \param fname The file to write to or NULL for standard error.
+ * \return 0 on success else -1 and an error message is printed.
+ */
+int stats_write(const char *fname);
+
+/**
+ * release the recorded statistics and reset the counters
+ */
+void stats_free(void);
+
+#endif
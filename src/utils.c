@@ -7,15 +7,21 @@
  */
 
 #include <stdio.h>
+#include <stdarg.h>
 #include <string.h>
 #include <stdbool.h>
 #include <errno.h>
 #include <stdlib.h>
 #include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
 #include <unistd.h>
 
 #include "options.h"
 #include "utils.h"
+#include "depfile.h"
+#include "stats.h"
 
 /* exported function documented in utils.h */
 char *genb_fpath(const char *fname)
@@ -30,16 +36,23 @@ char *genb_fpath(const char *fname)
         return fpath;
 }
 
-static char *genb_fpath_tmp(const char *fname)
+/* exported function documented in utils.h */
+char *genb_fpath_tmp(const char *fpath)
 {
-        char *fpath;
-        int fpathl;
+        static unsigned int tmpcount;
+        char *tpath;
+        int tpathl;
 
-        fpathl = strlen(options->outdirname) + strlen(fname) + 3;
-        fpath = malloc(fpathl);
-        snprintf(fpath, fpathl, "%s/%s.%d", options->outdirname, fname, getpid());
+        tpathl = strlen(fpath) + 24;
+        tpath = malloc(tpathl);
+        if (tpath == NULL) {
+                return NULL;
+        }
+        /* threads of one process may write the same file concurrently */
+        snprintf(tpath, tpathl, "%s.%d.%u", fpath, getpid(),
+                 __atomic_fetch_add(&tmpcount, 1, __ATOMIC_RELAXED));
 
-        return fpath;
+        return tpath;
 }
 
 /* exported function documented in utils.h */
@@ -56,7 +69,7 @@ FILE *genb_fopen(const char *fname, const char *mode)
 
         filef = fopen(fpath, mode);
         if (filef == NULL) {
-                fprintf(stderr, "Error: unable to open file %s (%s)\n",
+                genb_diagf("Error: unable to open file %s (%s)\n",
                         fpath, strerror(errno));
                 free(fpath);
                 return NULL;
@@ -66,90 +79,296 @@ FILE *genb_fopen(const char *fname, const char *mode)
         return filef;
 }
 
-/* exported function documented in utils.h */
-FILE *genb_fopen_tmp(const char *fname)
+/**
+ * compare the contents of a file with a memory buffer
+ *
+ * \param fpath The path of the file to compare.
+ * \param data The data to compare with.
+ * \param datalen The length of the data.
+ * \return true if the file exists and has identical content else false.
+ */
+static bool genb_fmatch(const char *fpath, const char *data, size_t datalen)
 {
-        char *fpath;
-        FILE *filef;
-
-        if (options->dryrun) {
-                fpath = strdup("/dev/null");
-        } else {
-                fpath = genb_fpath_tmp(fname);
+        int fd;
+        struct stat st;
+        void *map;
+        bool match = false;
+
+        fd = open(fpath, O_RDONLY);
+        if (fd == -1) {
+                return false;
         }
 
-        filef = fopen(fpath, "w+");
-        if (filef == NULL) {
-                fprintf(stderr, "Error: unable to open file %s (%s)\n",
-                        fpath, strerror(errno));
-                free(fpath);
-                return NULL;
+        if ((fstat(fd, &st) == 0) &&
+            (S_ISREG(st.st_mode)) &&
+            ((size_t)st.st_size == datalen)) {
+                if (datalen == 0) {
+                        match = true;
+                } else {
+                        map = mmap(NULL, datalen, PROT_READ, MAP_PRIVATE, fd, 0);
+                        if (map != MAP_FAILED) {
+                                match = (memcmp(map, data, datalen) == 0);
+                                munmap(map, datalen);
+                        }
+                }
         }
-        free(fpath);
 
-        return filef;
+        close(fd);
+
+        return match;
 }
 
-int genb_fclose_tmp(FILE *filef_tmp, const char *fname)
+/* exported function documented in utils.h */
+int genb_fupdate(const char *fname, const char *data, size_t datalen)
 {
         char *fpath;
         char *tpath;
         FILE *filef;
-        char tbuf[1024];
-        char fbuf[1024];
-        size_t trd;
-        size_t frd;
+        size_t wr;
+        int res = 0;
 
         if (options->dryrun) {
-                fclose(filef_tmp);
                 return 0;
         }
 
         fpath = genb_fpath(fname);
-        tpath = genb_fpath_tmp(fname);
 
-        filef = fopen(fpath, "r");
-        if (filef == NULL) {
-                /* unable to open target file for comparison */
+        if (depfile_add_output(fpath) != 0) {
+                genb_diagf("Error: unable to record output %s\n", fpath);
+                free(fpath);
+                return -1;
+        }
 
-                fclose(filef_tmp); /*  close tmpfile */
+        if (genb_fmatch(fpath, data, datalen)) {
+                /* target already has this content, leave it untouched */
+                stats_add(STATS_FILES_UNCHANGED, 1);
+                stats_add(STATS_BYTES_UNCHANGED, datalen);
+                free(fpath);
+                return 0;
+        }
+
+        /* write to a temporary file and rename it over the target */
+        tpath = genb_fpath_tmp(fpath);
+        if (tpath == NULL) {
+                free(fpath);
+                return -1;
+        }
+        filef = fopen(tpath, "w");
+        if (filef == NULL) {
+                genb_diagf("Error: unable to open file %s (%s)\n",
+                           tpath, strerror(errno));
+                free(tpath);
+                free(fpath);
+                return -1;
+        }
 
-                remove(fpath);
-                rename(tpath, fpath);
+        wr = fwrite(data, 1, datalen, filef);
+        if ((fclose(filef) != 0) || (wr != datalen)) {
+                genb_diagf("Error: unable to write file %s (%s)\n",
+                           tpath, strerror(errno));
+                remove(tpath);
+                res = -1;
+        } else if (rename(tpath, fpath) != 0) {
+                genb_diagf("Error: unable to rename %s to %s (%s)\n",
+                           tpath, fpath, strerror(errno));
+                remove(tpath);
+                res = -1;
         } else {
-                rewind(filef_tmp);
+                stats_add(STATS_FILES_WRITTEN, 1);
+                stats_add(STATS_BYTES_WRITTEN, datalen);
+        }
 
-                frd = fread(fbuf, 1, 1024, filef);
-                while (frd != 0) {
-                        trd = fread(tbuf, 1, frd, filef_tmp);
-                        if ((trd != frd) ||
-                            (memcmp(tbuf, fbuf, trd) != 0)) {
-                                /* file doesnt match */
-                                fclose(filef_tmp);
-                                fclose(filef);
+        free(tpath);
+        free(fpath);
 
-                                remove(fpath);
-                                rename(tpath, fpath);
+        return res;
+}
 
-                                goto close_done;
+/* exported function documented in utils.h */
+struct genb_mapped *genb_mapfile(FILE *filef)
+{
+        struct genb_mapped *mapped;
+        struct stat st;
+        long pagesize;
+        void *base;
+        char *ndata;
+        size_t alloc = 0;
+        size_t rd;
+        int fd;
+
+        mapped = calloc(1, sizeof(struct genb_mapped));
+        if (mapped == NULL) {
+                return NULL;
+        }
+
+        fd = fileno(filef);
+        if ((fstat(fd, &st) == 0) &&
+            (S_ISREG(st.st_mode)) &&
+            (st.st_size > 0)) {
+                pagesize = sysconf(_SC_PAGESIZE);
+                mapped->maplen = ((size_t)st.st_size + 2 + pagesize - 1) &
+                        ~((size_t)pagesize - 1);
+
+                /* reserve zeroed pages for the content and terminators
+                 * then map the file over the start of them
+                 */
+                base = mmap(NULL, mapped->maplen,
+                            PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS,
+                            -1, 0);
+                if (base != MAP_FAILED) {
+                        if (mmap(base, st.st_size,
+                                 PROT_READ | PROT_WRITE,
+                                 MAP_PRIVATE | MAP_FIXED,
+                                 fd, 0) != MAP_FAILED) {
+                                mapped->data = base;
+                                mapped->size = st.st_size;
+                                return mapped;
                         }
+                        munmap(base, mapped->maplen);
+                }
+                mapped->maplen = 0;
+        }
 
-                        frd = fread(fbuf, 1, 1024, filef);
+        /* not a regular file or unable to map it so read it instead */
+        do {
+                if ((mapped->size + 2) >= alloc) {
+                        alloc += 64 * 1024;
+                        ndata = realloc(mapped->data, alloc);
+                        if (ndata == NULL) {
+                                free(mapped->data);
+                                free(mapped);
+                                return NULL;
+                        }
+                        mapped->data = ndata;
                 }
+                rd = fread(mapped->data + mapped->size,
+                           1,
+                           alloc - mapped->size - 2,
+                           filef);
+                mapped->size += rd;
+        } while (rd > 0);
+
+        if (ferror(filef)) {
+                free(mapped->data);
+                free(mapped);
+                return NULL;
+        }
 
-                /* was the same kill temporary file */
-                fclose(filef_tmp);
-                fclose(filef);
-                remove(tpath);
+        mapped->data[mapped->size] = 0;
+        mapped->data[mapped->size + 1] = 0;
+
+        return mapped;
+}
+
+/* exported function documented in utils.h */
+void genb_unmapfile(struct genb_mapped *mapped)
+{
+        if (mapped == NULL) {
+                return;
+        }
+        if (mapped->maplen != 0) {
+                munmap(mapped->data, mapped->maplen);
+        } else {
+                free(mapped->data);
         }
+        free(mapped);
+}
 
-close_done:
-        free(fpath);
-        free(tpath);
+/* exported function documented in utils.h */
+uint64_t genb_hash(uint64_t hash, const void *data, size_t len)
+{
+        const unsigned char *byte = data;
 
-        return 0;
+        while (len > 0) {
+                hash ^= *byte++;
+                hash *= 1099511628211ULL;
+                len--;
+        }
+        return hash;
 }
 
+/* exported function documented in utils.h */
+bool genb_hash_generator(uint64_t *hash)
+{
+        struct stat exest;
+
+        if (stat("/proc/self/exe", &exest) != 0) {
+                return false;
+        }
+        *hash = genb_hash(*hash, &exest.st_size, sizeof(exest.st_size));
+        *hash = genb_hash(*hash, &exest.st_mtime, sizeof(exest.st_mtime));
+
+        return true;
+}
+
+/**
+ * diagnostic capture buffer of the current thread
+ */
+static __thread struct genb_diag *diag_capture;
+
+/* exported function documented in utils.h */
+int genb_diagf(const char *fmt, ...)
+{
+        va_list ap;
+        int res;
+        struct genb_diag *diag = diag_capture;
+
+        if (diag == NULL) {
+                va_start(ap, fmt);
+                res = vfprintf(stderr, fmt, ap);
+                va_end(ap);
+                return res;
+        }
+
+        va_start(ap, fmt);
+        res = vsnprintf(NULL, 0, fmt, ap);
+        va_end(ap);
+        if (res < 0) {
+                return res;
+        }
+
+        if ((diag->len + res + 1) > diag->alloc) {
+                size_t nalloc;
+                char *ndata;
+
+                nalloc = diag->alloc + res + 1024;
+                ndata = realloc(diag->data, nalloc);
+                if (ndata == NULL) {
+                        return -1;
+                }
+                diag->data = ndata;
+                diag->alloc = nalloc;
+        }
+
+        va_start(ap, fmt);
+        res = vsnprintf(diag->data + diag->len, diag->alloc - diag->len, fmt, ap);
+        va_end(ap);
+
+        diag->len += res;
+
+        return res;
+}
+
+/* exported function documented in utils.h */
+void genb_diag_capture(struct genb_diag *diag)
+{
+        diag_capture = diag;
+}
+
+/* exported function documented in utils.h */
+int genb_diag_flush(struct genb_diag *diag)
+{
+        if (diag->len > 0) {
+                fwrite(diag->data, 1, diag->len, stderr);
+        }
+        free(diag->data);
+        diag->data = NULL;
+        diag->len = 0;
+        diag->alloc = 0;
+
+        return 0;
+}
 
 #ifdef NEED_STRNDUP
 
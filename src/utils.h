@@ -9,6 +9,9 @@
 #ifndef nsgenbind_utils_h
 #define nsgenbind_utils_h
 
+#include <stdbool.h>
+#include <stdint.h>
+
 /**
  * get a pathname with the output prefix prepended
  *
@@ -23,18 +26,118 @@ char *genb_fpath(const char *fname);
 FILE *genb_fopen(const char *fname, const char *mode);
 
 /**
- * Open file allowing for output path prefix
+ * Generate a temporary file path next to a file
+ *
+ * Every call returns a different path within the process so concurrent
+ * writers of the same file never share a temporary file.
+ *
+ * \param fpath The path of the file.
+ * \return The temporary path which the caller must free or NULL on
+ *         allocation failure.
+ */
+char *genb_fpath_tmp(const char *fpath);
+
+/**
+ * Update file allowing for output path prefix
+ *
+ * The data is compared with the existing content of the file and the
+ * file is only written if it differs. The write is made to a temporary
+ * file which is then renamed over the target so the update is atomic.
+ *
+ * \param fname leaf filename.
+ * \param data The content for the file.
+ * \param datalen The length of the content.
+ * \return 0 on success else -1 and a diagnostic is reported.
+ */
+int genb_fupdate(const char *fname, const char *data, size_t datalen);
+
+/**
+ * file content in memory ready to be scanned in place
+ */
+struct genb_mapped {
+        char *data; /**< file content followed by two NUL bytes */
+        size_t size; /**< size of the file content */
+        size_t maplen; /**< length of the mapping or 0 if data was read */
+        struct genb_mapped *next; /**< next entry when used as a stack */
+};
+
+/**
+ * map the content of an open file into memory
+ *
+ * Regular files are mapped copy on write so the content may be modified
+ * in place, anything else is read into an allocated buffer. The content
+ * is always followed by two NUL bytes as flex requires of a buffer
+ * passed to yy_scan_buffer(). The file may be closed once mapped.
+ *
+ * \param filef The file to map.
+ * \return The mapped content which must be released with
+ *         genb_unmapfile() or NULL on error.
+ */
+struct genb_mapped *genb_mapfile(FILE *filef);
+
+/**
+ * release file content mapped by genb_mapfile()
+ */
+void genb_unmapfile(struct genb_mapped *mapped);
+
+/** initial value of a content hash */
+#define GENB_HASH_INIT 14695981039346656037ULL
+
+/**
+ * update a content hash with some data
+ *
+ * The hash is 64 bit FNV-1a which is stable between runs and hosts of
+ * the same byte order so it may be stored.
+ *
+ * \param hash The hash to update.
+ * \param data The data to add to the hash.
+ * \param len The length of the data.
+ * \return The updated hash.
+ */
+uint64_t genb_hash(uint64_t hash, const void *data, size_t len);
+
+/**
+ * update a content hash with the identity of the generator
+ *
+ * The size and modification time of the running executable identify the
+ * generator so anything stored by a different build is not reused.
+ *
+ * \param hash The hash to update.
+ * \return true on success else false if the generator cannot be identified.
+ */
+bool genb_hash_generator(uint64_t *hash);
+
+/**
+ * diagnostic message buffer
+ *
+ * Holds messages generated while a capture is active on a thread so
+ * they can be emitted later in a deterministic order.
+ */
+struct genb_diag {
+        char *data; /**< captured message text */
+        size_t len; /**< length of captured text */
+        size_t alloc; /**< allocated size of data */
+};
+
+/**
+ * output a diagnostic message
+ *
+ * The message is written to stderr unless the calling thread has an
+ * active capture buffer in which case it is appended to that.
+ */
+int genb_diagf(const char *fmt, ...) __attribute__ ((format (printf, 1, 2)));
+
+/**
+ * set the diagnostic capture buffer for the calling thread
  *
- * file is opened for reading/writing with a temporary suffix allowing for the
- * matching close call to check the output is different before touching the
- * target file.
+ * \param diag The buffer to capture into or NULL to write to stderr.
  */
-FILE *genb_fopen_tmp(const char *fname);
+void genb_diag_capture(struct genb_diag *diag);
 
 /**
- * Close file opened with genb_fopen
+ * write captured diagnostics to stderr and release the buffer contents
  */
-int genb_fclose_tmp(FILE *filef, const char *fname);
+int genb_diag_flush(struct genb_diag *diag);
 
 #if defined(__APPLE__) || defined(_WIN32)
 #define NEED_STRNDUP 1
@@ -0,0 +1,260 @@
+/* input file change notification implementation
+ *
+ * This file is part of nsgenbind.
+ * Licensed under the MIT License,
+ *                http://www.opensource.org/licenses/mit-license.php
+ * Copyright 2026 agent <agent@local>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "options.h"
+#include "utils.h"
+#include "watch.h"
+
+#ifdef __linux__
+
+#include <poll.h>
+#include <sys/inotify.h>
+
+/** time in milliseconds without changes before a change is reported */
+#define WATCH_SETTLE_MS 20
+
+/** directory events which indicate a file has new content */
+#define WATCH_EVENTS (IN_CLOSE_WRITE | IN_MOVED_TO)
+
+/**
+ * watched file
+ */
+struct watch_file {
+        int wd; /**< watch descriptor of the containing directory */
+        char *name; /**< file name within the directory */
+        char *path; /**< path of the file as given */
+        enum nsgenbind_input_type type; /**< kind of input file */
+};
+
+static int watch_fd = -1;
+static struct watch_file *filev;
+static unsigned int filec;
+
+/* exported interface documented in watch.h */
+int watch_init(void)
+{
+        watch_fd = inotify_init1(IN_CLOEXEC);
+        if (watch_fd == -1) {
+                fprintf(stderr, "Error: unable to watch inputs (%s)\n",
+                        strerror(errno));
+                return -1;
+        }
+        return 0;
+}
+
+/* exported interface documented in watch.h */
+int watch_add(const char *fname, enum nsgenbind_input_type type)
+{
+        const char *name;
+        char *dir;
+        struct watch_file *newv;
+        unsigned int idx;
+        int wd;
+
+        for (idx = 0; idx < filec; idx++) {
+                if (strcmp(filev[idx].path, fname) == 0) {
+                        return 0;
+                }
+        }
+
+        name = strrchr(fname, '/');
+        if (name == NULL) {
+                dir = strdup(".");
+                name = fname;
+        } else if (name == fname) {
+                dir = strdup("/");
+                name++;
+        } else {
+                dir = strndup(fname, name - fname);
+                name++;
+        }
+        if (dir == NULL) {
+                fprintf(stderr, "Allocation error\n");
+                return -1;
+        }
+
+        /* the same descriptor is returned for a directory already watched */
+        wd = inotify_add_watch(watch_fd, dir, WATCH_EVENTS);
+        if (wd == -1) {
+                fprintf(stderr, "Error: unable to watch %s (%s)\n",
+                        dir, strerror(errno));
+                free(dir);
+                return -1;
+        }
+        free(dir);
+
+        newv = realloc(filev, (filec + 1) * sizeof(struct watch_file));
+        if (newv == NULL) {
+                fprintf(stderr, "Allocation error\n");
+                return -1;
+        }
+        filev = newv;
+        filev[filec].wd = wd;
+        filev[filec].name = strdup(name);
+        filev[filec].path = strdup(fname);
+        filev[filec].type = type;
+        if ((filev[filec].name == NULL) || (filev[filec].path == NULL)) {
+                free(filev[filec].name);
+                free(filev[filec].path);
+                fprintf(stderr, "Allocation error\n");
+                return -1;
+        }
+        filec++;
+
+        if (options->verbose) {
+                printf("Watching %s\n", fname);
+        }
+
+        return 0;
+}
+
+/**
+ * find the watched file an event refers to
+ */
+static struct watch_file *watch_find(struct inotify_event *event)
+{
+        unsigned int idx;
+
+        if (event->len == 0) {
+                return NULL;
+        }
+
+        for (idx = 0; idx < filec; idx++) {
+                if ((filev[idx].wd == event->wd) &&
+                    (strcmp(filev[idx].name, event->name) == 0)) {
+                        return filev + idx;
+                }
+        }
+        return NULL;
+}
+
+/* exported interface documented in watch.h */
+int watch_wait(bool *idl_out)
+{
+        char buf[4096]
+                __attribute__ ((aligned(__alignof__(struct inotify_event))));
+        struct inotify_event *event;
+        struct watch_file *file;
+        struct pollfd pfd;
+        bool changed = false;
+        ssize_t len;
+        char *ptr;
+        int res;
+
+        *idl_out = false;
+
+        for (;;) {
+                pfd.fd = watch_fd;
+                pfd.events = POLLIN;
+                res = poll(&pfd, 1, changed ? WATCH_SETTLE_MS : -1);
+                if (res == -1) {
+                        if (errno == EINTR) {
+                                continue;
+                        }
+                        fprintf(stderr, "Error: waiting for changes (%s)\n",
+                                strerror(errno));
+                        return -1;
+                }
+                if (res == 0) {
+                        /* changes have settled */
+                        return 0;
+                }
+
+                len = read(watch_fd, buf, sizeof(buf));
+                if (len == -1) {
+                        if (errno == EINTR) {
+                                continue;
+                        }
+                        fprintf(stderr, "Error: reading changes (%s)\n",
+                                strerror(errno));
+                        return -1;
+                }
+
+                for (ptr = buf; ptr < (buf + len);
+                     ptr += sizeof(struct inotify_event) + event->len) {
+                        event = (struct inotify_event *)ptr;
+
+                        if ((event->mask & IN_Q_OVERFLOW) != 0) {
+                                /* events were lost so assume everything */
+                                changed = true;
+                                *idl_out = true;
+                                continue;
+                        }
+
+                        file = watch_find(event);
+                        if (file == NULL) {
+                                continue;
+                        }
+
+                        if (options->verbose) {
+                                printf("Changed %s\n", file->path);
+                        }
+                        changed = true;
+                        if (file->type == NSGENBIND_INPUT_IDL) {
+                                *idl_out = true;
+                        }
+                }
+        }
+}
+
+/* exported interface documented in watch.h */
+void watch_free(void)
+{
+        unsigned int idx;
+
+        for (idx = 0; idx < filec; idx++) {
+                free(filev[idx].name);
+                free(filev[idx].path);
+        }
+        free(filev);
+        filev = NULL;
+        filec = 0;
+
+        if (watch_fd != -1) {
+                close(watch_fd);
+                watch_fd = -1;
+        }
+}
+
+#else
+
+/* exported interface documented in watch.h */
+int watch_init(void)
+{
+        fprintf(stderr, "Error: --watch is not supported on this host\n");
+        return -1;
+}
+
+/* exported interface documented in watch.h */
+int watch_add(const char *fname, enum nsgenbind_input_type type)
+{
+        UNUSED(fname);
+        UNUSED(type);
+        return -1;
+}
+
+/* exported interface documented in watch.h */
+int watch_wait(bool *idl_out)
+{
+        UNUSED(idl_out);
+        return -1;
+}
+
+/* exported interface documented in watch.h */
+void watch_free(void)
+{
+}
+
+#endif
@@ -0,0 +1,55 @@
+/* input file change notification
+ *
+ * This file is part of nsgenbind.
+ * Licensed under the MIT License,
+ *                http://www.opensource.org/licenses/mit-license.php
+ * Copyright 2026 agent <agent@local>
+ */
+
+#ifndef nsgenbind_watch_h
+#define nsgenbind_watch_h
+
+#include <stdbool.h>
+
+#include "nsgenbind.h"
+
+/**
+ * start watching for input file changes
+ *
+ * Watching uses inotify so is only available on Linux hosts.
+ *
+ * \return 0 on success else -1 and an error message is printed.
+ */
+int watch_init(void);
+
+/**
+ * watch an input file
+ *
+ * The directory containing the file is watched so files replaced by
+ * editors, or not yet created, are still noticed. Files already watched
+ * are ignored.
+ *
+ * \param fname The path of the file.
+ * \param type The kind of input file.
+ * \return 0 on success else -1 and an error message is printed.
+ */
+int watch_add(const char *fname, enum nsgenbind_input_type type);
+
+/**
+ * wait for watched files to change
+ *
+ * Blocks until at least one watched file has been written and no
+ * further changes have been seen for a short time so a series of writes
+ * is reported as a single change.
+ *
+ * \param idl_out Updated with true if a Web IDL file changed.
+ * \return 0 on success else -1 and an error message is printed.
+ */
+int watch_wait(bool *idl_out);
+
+/**
+ * stop watching and release the watched files
+ */
+void watch_free(void);
+
+#endif
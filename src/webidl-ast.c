@@ -12,20 +12,72 @@
 #include <string.h>
 #include <errno.h>
 #include <stdarg.h>
+#include <pthread.h>
 
 #include "utils.h"
+#include "arena.h"
+#include "intern.h"
+#include "nameindex.h"
+#include "depfile.h"
+#include "webidl-cache.h"
 #include "webidl-ast.h"
 #include "options.h"
+#include "context.h"
 
 /**
  * standard IO handle for parse trace logging.
+ *
+ * The bison trace output has no access to the parse so the handle is
+ * per thread.
+ */
+static __thread FILE *webidl_parsetracef;
+
+/**
+ * IDL file being loaded
+ *
+ * Each file is parsed into its own arena so files may be parsed
+ * concurrently. The arenas are moved into the shared arena as the
+ * definitions are merged.
+ */
+struct webidl_load {
+	const char *filename; /**< name of the file as given */
+	char *path; /**< path the file was opened with */
+	struct genb_mapped *input; /**< mapped file content */
+	uint64_t hash; /**< hash of the content when caching */
+	bool cached; /**< definitions were loaded from the cache */
+	struct webidl_node *defs; /**< definitions, most recent first */
+	int res; /**< result of parsing */
+	struct arena *arena; /**< arena the definitions are allocated from */
+	unsigned int nodec; /**< number of nodes allocated */
+	struct genb_diag diag; /**< diagnostics from parsing */
+};
+
+/**
+ * IDL file parse jobs
+ */
+struct webidl_load_jobs {
+	struct webidl_load *loadv; /**< files in the order they are merged */
+	unsigned int loadc; /**< number of files */
+	pthread_mutex_t lock; /**< protects next */
+	unsigned int next; /**< index of next file to be parsed */
+	struct genb_context *context; /**< context the files are loaded in */
+};
+
+/**
+ * file being parsed by the calling thread or NULL when allocating from
+ * the shared arena
  */
-static FILE *webidl_parsetracef;
+static __thread struct webidl_load *webidl_thread_load;
 
 extern int webidl_debug;
-extern int webidl__flex_debug;
-extern void webidl_restart(FILE*);
-extern int webidl_parse(struct webidl_node **webidl_ast);
+extern int webidl_lex_init_extra(struct webidl_parse_ctx *ctx, void **scanner);
+extern int webidl_lex_destroy(void *scanner);
+extern void webidl_set_debug(int debug, void *scanner);
+extern void webidl_scan_begin(struct genb_mapped *input, void *scanner);
+extern void webidl_scan_end(void *scanner);
+extern int webidl_parse(void *scanner,
+			struct webidl_parse_ctx *ctx,
+			struct webidl_node **webidl_ast);
 
 struct webidl_node {
 	enum webidl_node_type type; /* the type of the node */
@@ -119,6 +171,102 @@ webidl_node_add(struct webidl_node *node, struct webidl_node *list)
 }
 
 
+/**
+ * get the arena the Web IDL AST is allocated from
+ *
+ * Files loaded on a parse thread are allocated from the thread arena.
+ *
+ * \return The arena or NULL on allocation failure.
+ */
+static struct arena *webidl_get_arena(void)
+{
+        struct arena **arena = &genb_context->webidl.arena;
+
+        if (webidl_thread_load != NULL) {
+                arena = &webidl_thread_load->arena;
+        }
+
+        if (*arena == NULL) {
+                *arena = arena_new(0);
+        }
+        return *arena;
+}
+
+/**
+ * check a Web IDL AST allocation succeeded
+ *
+ * Failure is recorded in the generator context.
+ */
+static void *webidl_alloc_check(void *res)
+{
+        if (res == NULL) {
+                fprintf(stderr, "Error: Web IDL AST allocation failed\n");
+                genb_context_nomem();
+        }
+        return res;
+}
+
+/* exported interface documented in webidl-ast.h */
+void *webidl_alloc(size_t size)
+{
+        struct arena *arena = webidl_get_arena();
+
+        if (arena == NULL) {
+                return webidl_alloc_check(NULL);
+        }
+        return webidl_alloc_check(arena_alloc(arena, size));
+}
+
+/* exported interface documented in webidl-ast.h */
+char *webidl_strdup(const char *s)
+{
+        struct arena *arena = webidl_get_arena();
+
+        if (arena == NULL) {
+                return webidl_alloc_check(NULL);
+        }
+        return webidl_alloc_check(arena_strdup(arena, s));
+}
+
+/* exported interface documented in webidl-ast.h */
+char *webidl_strndup(const char *s, size_t n)
+{
+        struct arena *arena = webidl_get_arena();
+
+        if (arena == NULL) {
+                return webidl_alloc_check(NULL);
+        }
+        return webidl_alloc_check(arena_strndup(arena, s, n));
+}
+
+/* exported interface documented in webidl-ast.h */
+void webidl_ast_free(void)
+{
+        struct webidl_ast_state *ast = &genb_context->webidl;
+
+        nameindex_free(ast->index);
+        ast->index = NULL;
+        arena_free(ast->arena);
+        ast->arena = NULL;
+        ast->nodec = 0;
+}
+
+/* exported interface documented in webidl-ast.h */
+int webidl_ast_stats(unsigned int *nodec, size_t *used, size_t *allocated)
+{
+        struct webidl_ast_state *ast = &genb_context->webidl;
+        struct arena_stats stats = { 0, 0, 0 };
+
+        if (ast->arena != NULL) {
+                arena_get_stats(ast->arena, &stats);
+        }
+        *nodec = ast->nodec;
+        *used = stats.used;
+        *allocated = stats.allocated;
+
+        return 0;
+}
+
 struct webidl_node *
 /* exported interface documented in webidl-ast.h */
 webidl_node_new(enum webidl_node_type type,
@@ -126,7 +274,15 @@ webidl_node_new(enum webidl_node_type type,
 		void *r)
 {
 	struct webidl_node *nn;
-	nn = calloc(1, sizeof(struct webidl_node));
+	nn = webidl_alloc(sizeof(struct webidl_node));
+	if (nn == NULL) {
+		return l;
+	}
+	if (webidl_thread_load != NULL) {
+		webidl_thread_load->nodec++;
+	} else {
+		genb_context->webidl.nodec++;
+	}
 	nn->type = type;
 	nn->l = l;
 	nn->r.value = r;
@@ -140,36 +296,167 @@ webidl_new_number_node(enum webidl_node_type type,
                        int number)
 {
 	struct webidl_node *nn;
-	nn = calloc(1, sizeof(struct webidl_node));
+	nn = webidl_alloc(sizeof(struct webidl_node));
+	if (nn == NULL) {
+		return l;
+	}
+	if (webidl_thread_load != NULL) {
+		webidl_thread_load->nodec++;
+	} else {
+		genb_context->webidl.nodec++;
+	}
 	nn->type = type;
 	nn->l = l;
 	nn->r.number = number;
 	return nn;
 }
 
+/* exported interface documented in webidl-ast.h */
+struct webidl_node *
+webidl_new_float_node(enum webidl_node_type type,
+		      struct webidl_node *l,
+		      float value)
+{
+	float *flt;
+
+	flt = webidl_alloc(sizeof(float));
+	if (flt == NULL) {
+		return l;
+	}
+	*flt = value;
+	return webidl_node_new(type, l, flt);
+}
+
+
+/* exported interface defined in webidl-ast.h */
+uint64_t webidl_node_hash(struct webidl_node *node, uint64_t hash)
+{
+	struct webidl_node *child;
+	char *text;
+	int *number;
+	float *flt;
 
+	if (node == NULL) {
+		return hash;
+	}
+
+	hash = genb_hash(hash, &node->type, sizeof(node->type));
+
+	text = webidl_node_gettext(node);
+	if (text != NULL) {
+		/* include the terminator so adjacent text is distinct */
+		return genb_hash(hash, text, strlen(text) + 1);
+	}
+
+	number = webidl_node_getint(node);
+	if (number != NULL) {
+		return genb_hash(hash, number, sizeof(*number));
+	}
+
+	flt = webidl_node_getfloat(node);
+	if (flt != NULL) {
+		return genb_hash(hash, flt, sizeof(*flt));
+	}
+
+	for (child = webidl_node_getnode(node);
+	     child != NULL;
+	     child = child->l) {
+		hash = webidl_node_hash(child, hash);
+	}
+
+	/* mark the end of the children */
+	return genb_hash(hash, "", 1);
+}
+
+/* exported interface defined in webidl-ast.h */
+void webidl_node_iter_init(struct webidl_node_iter *it, struct webidl_node *node)
+{
+	struct webidl_node *cur;
+	int nodec = 0;
+
+	for (cur = node; cur != NULL; cur = cur->l) {
+		nodec++;
+	}
+
+	it->nodev = it->inlinev;
+	if (nodec > WEBIDL_NODE_ITER_INLINE) {
+		it->nodev = malloc(nodec * sizeof(struct webidl_node *));
+		if (it->nodev == NULL) {
+			/* iterate nothing, the phase fails once complete */
+			fprintf(stderr, "Error: node iterator allocation failed\n");
+			genb_context_nomem();
+			it->nodev = it->inlinev;
+			it->nodec = 0;
+			return;
+		}
+	}
+
+	it->nodec = 0;
+	for (cur = node; cur != NULL; cur = cur->l) {
+		it->nodev[it->nodec++] = cur;
+	}
+}
+
+/* exported interface defined in webidl-ast.h */
+struct webidl_node *
+webidl_node_iter_next(struct webidl_node_iter *it, enum webidl_node_type type)
+{
+	struct webidl_node *node;
+
+	/* searches return the node nearest the list tail first */
+	while (it->nodec > 0) {
+		node = it->nodev[--it->nodec];
+		if (node->type == type) {
+			return node;
+		}
+	}
+	return NULL;
+}
+
+/* exported interface defined in webidl-ast.h */
+struct webidl_node *webidl_node_iter_next_any(struct webidl_node_iter *it)
+{
+	if (it->nodec > 0) {
+		return it->nodev[--it->nodec];
+	}
+	return NULL;
+}
+
+/* exported interface defined in webidl-ast.h */
+void webidl_node_iter_fini(struct webidl_node_iter *it)
+{
+	if (it->nodev != it->inlinev) {
+		free(it->nodev);
+	}
+	it->nodev = it->inlinev;
+	it->nodec = 0;
+}
+
+/* exported interface defined in webidl-ast.h */
 int
 webidl_node_for_each_type(struct webidl_node *node,
 			   enum webidl_node_type type,
 			   webidl_callback_t *cb,
 			   void *ctx)
 {
-	int ret;
+	struct webidl_node_iter it;
+	struct webidl_node *cur;
+	int ret = 0;
 
 	if (node == NULL) {
 		return -1;
 	}
-	if (node->l != NULL) {
-		ret = webidl_node_for_each_type(node->l, type, cb, ctx);
+
+	webidl_node_iter_init(&it, node);
+	while ((cur = webidl_node_iter_next(&it, type)) != NULL) {
+		ret = cb(cur, ctx);
 		if (ret != 0) {
-			return ret;
+			break;
 		}
 	}
-	if (node->type == type) {
-		return cb(node, ctx);
-	}
+	webidl_node_iter_fini(&it);
 
-	return 0;
+	return ret;
 }
 
 /* exported interface defined in webidl-ast.h */
@@ -180,23 +467,19 @@ int webidl_cmp_node_type(struct webidl_node *node, void *ctx)
 	return 0;
 }
 
-static int webidl_enumerate_node(struct webidl_node *node, void *ctx)
-{
-	UNUSED(node);
-	(*((int *)ctx))++;
-	return 0;
-}
-
 /* exported interface defined in nsgenbind-ast.h */
 int
 webidl_node_enumerate_type(struct webidl_node *node,
 			    enum webidl_node_type type)
 {
 	int count = 0;
-	webidl_node_for_each_type(node,
-				  type,
-				  webidl_enumerate_node,
-				  &count);
+
+	while (node != NULL) {
+		if (node->type == type) {
+			count++;
+		}
+		node = node->l;
+	}
 	return count;
 }
 
@@ -207,24 +490,17 @@ webidl_node_find(struct webidl_node *node,
 		  webidl_callback_t *cb,
 		  void *ctx)
 {
-	struct webidl_node *ret;
-
-	if ((node == NULL) || (node == prev)) {
-		return NULL;
-	}
+	struct webidl_node *ret = NULL;
 
-	if (node->l != prev) {
-		ret = webidl_node_find(node->l, prev, cb, ctx);
-		if (ret != NULL) {
-			return ret;
+	/* the match nearest prev (or the list tail) is the result */
+	while ((node != NULL) && (node != prev)) {
+		if (cb(node, ctx) != 0) {
+			ret = node;
 		}
+		node = node->l;
 	}
 
-	if (cb(node, ctx) != 0) {
-		return node;
-	}
-
-	return NULL;
+	return ret;
 }
 
 
@@ -250,6 +526,12 @@ webidl_node_find_type_ident(struct webidl_node *root_node,
 	struct webidl_node *node;
 	struct webidl_node *ident_node;
 
+	/* identifiers are interned so can be compared by pointer */
+	ident = intern_lookup(ident);
+	if (ident == NULL) {
+		return NULL;
+	}
+
 	node = webidl_node_find_type(root_node,	NULL, type);
 
 	while (node != NULL) {
@@ -258,7 +540,7 @@ webidl_node_find_type_ident(struct webidl_node *root_node,
 					      NULL,
 					      WEBIDL_NODE_TYPE_IDENT);
 		if (ident_node != NULL) {
-			if (strcmp(ident_node->r.text, ident) == 0)
+			if (ident_node->r.text == ident)
 				break;
 		}
 
@@ -269,6 +551,45 @@ webidl_node_find_type_ident(struct webidl_node *root_node,
 }
 
 
+/* exported interface defined in webidl-ast.h */
+int webidl_index_add(struct nameindex **index, struct webidl_node *node)
+{
+	struct webidl_node *ident_node;
+
+	ident_node = webidl_node_find_type(webidl_node_getnode(node),
+					   NULL,
+					   WEBIDL_NODE_TYPE_IDENT);
+	if (ident_node == NULL) {
+		return -1;
+	}
+
+	if (*index == NULL) {
+		*index = nameindex_new();
+	}
+
+	if ((*index == NULL) ||
+	    (nameindex_add(*index,
+			   node->type,
+			   ident_node->r.text,
+			   node) != 0)) {
+		fprintf(stderr, "Error: Web IDL index allocation failed\n");
+		genb_context_nomem();
+		return -1;
+	}
+
+	return 0;
+}
+
+/* exported interface defined in webidl-ast.h */
+struct webidl_node *
+webidl_index_find(struct nameindex *index,
+		  enum webidl_node_type type,
+		  const char *ident)
+{
+	return nameindex_find(index, type, intern_lookup(ident));
+}
+
+
 /* exported interface defined in webidl-ast.h */
 char *webidl_node_gettext(struct webidl_node *node)
 {
@@ -324,6 +645,12 @@ webidl_node_getfloat(struct webidl_node *node)
 	return NULL;
 }
 
+/* exported interface defined in webidl-ast.h */
+struct webidl_node *webidl_node_next(struct webidl_node *node)
+{
+	return node->l;
+}
+
 /* exported interface defined in webidl-ast.h */
 enum webidl_node_type webidl_node_gettype(struct webidl_node *node)
 {
@@ -589,52 +916,80 @@ int webidl_dump_ast(struct webidl_node *node)
         return 0;
 }
 
-/* exported interface defined in webidl-ast.h */
-static FILE *idlopen(const char *filename)
+/**
+ * open an IDL file searching the IDL path
+ *
+ * \param filename The name of the file to open.
+ * \param path_out Updated with the path the file was opened with which the
+ *                 caller must free.
+ * \return The opened file or NULL on error.
+ */
+static FILE *idlopen(const char *filename, char **path_out)
 {
 	FILE *idlfile;
 	char *fullname;
 	int fulllen;
 
 	if (options->idlpath == NULL) {
-		if (options->verbose) {
-			printf("Opening IDL file %s\n", filename);
+		fullname = strdup(filename);
+	} else {
+		fulllen = strlen(options->idlpath) + strlen(filename) + 2;
+		fullname = malloc(fulllen);
+		if (fullname != NULL) {
+			snprintf(fullname, fulllen, "%s/%s",
+				 options->idlpath, filename);
 		}
-		return fopen(filename, "r");
+	}
+	if (fullname == NULL) {
+		return NULL;
 	}
 
-	fulllen = strlen(options->idlpath) + strlen(filename) + 2;
-	fullname = malloc(fulllen);
-	snprintf(fullname, fulllen, "%s/%s", options->idlpath, filename);
 	if (options->verbose) {
 		printf("Opening IDL file %s\n", fullname);
 	}
 	idlfile = fopen(fullname, "r");
-	free(fullname);
+	if (idlfile == NULL) {
+		free(fullname);
+		return NULL;
+	}
+
+	depfile_add_input(fullname, DEPFILE_INPUT_IDL);
+	*path_out = fullname;
 
 	return idlfile;
 }
 
-/* exported interface defined in webidl-ast.h */
-int webidl_parsefile(char *filename, struct webidl_node **webidl_ast)
+/**
+ * parse an IDL file on its own
+ *
+ * Definitions are indexed separately from those already parsed so the
+ * result depends only on the file content.
+ *
+ * \param input The mapped file content to parse.
+ * \param filename The name of the file used for trace output.
+ * \param defs_out Updated with the list of definitions in the file.
+ * \return 0 on success else the parser error code.
+ */
+static int
+webidl_parse_definitions(struct genb_mapped *input,
+			 const char *filename,
+			 struct webidl_node **defs_out)
 {
-	FILE *idlfile;
-        int ret;
+	struct webidl_parse_ctx ctx = { NULL, NULL, NULL, false };
+	struct webidl_node *defs = NULL;
+	void *scanner;
+	int ret;
 
-	idlfile = idlopen(filename);
-	if (!idlfile) {
-		fprintf(stderr, "Error opening %s: %s\n",
-			filename,
-			strerror(errno));
-		return 2;
+	if (webidl_lex_init_extra(&ctx, &scanner) != 0) {
+		fprintf(stderr, "Error: unable to create Web IDL scanner\n");
+		return -1;
 	}
 
         /* if debugging enabled enable parser tracing and send to file */
         if (options->debug) {
                 char *tracename;
                 int tracenamelen;
-		webidl_debug = 1;
-		webidl__flex_debug = 1;
+		webidl_set_debug(1, scanner);
 
                 tracenamelen = SLEN("webidl--trace") + strlen(filename) + 1;
                 tracename = malloc(tracenamelen);
@@ -645,16 +1000,340 @@ int webidl_parsefile(char *filename, struct webidl_node **webidl_ast)
                 webidl_parsetracef = NULL;
         }
 
-	/* set flex to read from file */
-	webidl_restart(idlfile);
+	/* set flex to scan the mapped file in place */
+	webidl_scan_begin(input, scanner);
+
+	/* parse the file with an index of only its own definitions */
+	ret = webidl_parse(scanner, &ctx, &defs);
+	if (ctx.failed) {
+		/* the scanner stopped at an unreadable include */
+		ret = 2;
+	}
+
+	webidl_scan_end(scanner);
+	webidl_lex_destroy(scanner);
 
-	/* parse the file */
-	ret = webidl_parse(webidl_ast);
+	nameindex_free(ctx.index);
+	free(ctx.errtxt);
 
         /* close tracefile if open */
         if (webidl_parsetracef != NULL) {
                 fclose(webidl_parsetracef);
+                webidl_parsetracef = NULL;
         }
+
+	*defs_out = defs;
+        return ret;
+}
+
+/**
+ * merge the definitions parsed from a file into the AST
+ *
+ * Interfaces and dictionaries which are already defined are extended
+ * with the members of the new definition exactly as if the file had
+ * been parsed directly into the AST. Its identifier and extended
+ * attributes are discarded as the parser would have done.
+ *
+ * \param webidl_ast The AST to merge into.
+ * \param defs The definitions, most recently parsed first.
+ */
+static void
+webidl_merge_definitions(struct webidl_node **webidl_ast,
+			 struct webidl_node *defs)
+{
+	struct webidl_node *ordered = NULL;
+	struct webidl_node *def;
+	struct webidl_node *existing;
+	struct webidl_node *child;
+	struct webidl_node *members;
+	struct webidl_node **members_end;
+
+	/* reverse the definitions into file order */
+	while (defs != NULL) {
+		def = defs;
+		defs = defs->l;
+		def->l = ordered;
+		ordered = def;
+	}
+
+	while (ordered != NULL) {
+		def = ordered;
+		ordered = ordered->l;
+		def->l = NULL;
+
+		existing = NULL;
+		if ((def->type == WEBIDL_NODE_TYPE_INTERFACE) ||
+		    (def->type == WEBIDL_NODE_TYPE_DICTIONARY)) {
+			existing = webidl_index_find(genb_context->webidl.index,
+						     def->type,
+				webidl_node_gettext(
+					webidl_node_find_type(
+						webidl_node_getnode(def),
+						NULL,
+						WEBIDL_NODE_TYPE_IDENT)));
+		}
+
+		if (existing == NULL) {
+			*webidl_ast = webidl_node_prepend(*webidl_ast, def);
+			if ((def->type == WEBIDL_NODE_TYPE_INTERFACE) ||
+			    (def->type == WEBIDL_NODE_TYPE_DICTIONARY)) {
+				webidl_index_add(&genb_context->webidl.index,
+						 def);
+			}
+			continue;
+		}
+
+		/* keep the members in order */
+		members = NULL;
+		members_end = &members;
+		child = def->r.node;
+		while (child != NULL) {
+			def->r.node = child->l;
+			if ((child->type == WEBIDL_NODE_TYPE_IDENT) ||
+			    (child->type == WEBIDL_NODE_TYPE_EXTENDED_ATTRIBUTE)) {
+				child = def->r.node;
+				continue;
+			}
+			child->l = NULL;
+			*members_end = child;
+			members_end = &child->l;
+			child = def->r.node;
+		}
+		webidl_node_add(existing, members);
+	}
+}
+
+/**
+ * open and map an IDL file ready to be parsed
+ *
+ * \param load The file to open.
+ * \return 0 on success else 2 and an error message is printed.
+ */
+static int webidl_load_open(struct webidl_load *load)
+{
+	FILE *idlfile;
+
+	idlfile = idlopen(load->filename, &load->path);
+	if (!idlfile) {
+		fprintf(stderr, "Error opening %s: %s\n",
+			load->filename,
+			strerror(errno));
+		return 2;
+	}
+
+	load->input = genb_mapfile(idlfile);
+	fclose(idlfile);
+	if (load->input == NULL) {
+		fprintf(stderr, "Error reading %s: %s\n",
+			load->path,
+			strerror(errno));
+		return 2;
+	}
+
+	return 0;
+}
+
+/**
+ * get the definitions of an IDL file from the cache or by parsing it
+ *
+ * Everything the definitions use is allocated from the arena of the
+ * file so this may run concurrently for different files.
+ */
+static void webidl_load_parse(struct webidl_load *load)
+{
+	webidl_thread_load = load;
+	genb_diag_capture(&load->diag);
+
+	if (options->cachedir != NULL) {
+		load->hash = genb_hash(GENB_HASH_INIT,
+				       load->input->data,
+				       load->input->size);
+
+		if (webidl_cache_load(load->path,
+				      load->input->size,
+				      load->hash,
+				      &load->defs) == 0) {
+			load->cached = true;
+		}
+	}
+
+	if (!load->cached) {
+		load->res = webidl_parse_definitions(load->input,
+						     load->filename,
+						     &load->defs);
+	}
+
+	genb_diag_capture(NULL);
+	webidl_thread_load = NULL;
+}
+
+/**
+ * IDL parse worker thread
+ *
+ * takes files from the job context until there are none left.
+ */
+static void *webidl_load_worker(void *ctx)
+{
+	struct webidl_load_jobs *jobs = ctx;
+	unsigned int idx;
+
+	genb_context_set(jobs->context);
+
+	for (;;) {
+		pthread_mutex_lock(&jobs->lock);
+		idx = jobs->next++;
+		pthread_mutex_unlock(&jobs->lock);
+
+		if (idx >= jobs->loadc) {
+			break;
+		}
+
+		webidl_load_parse(jobs->loadv + idx);
+	}
+
+	return NULL;
+}
+
+/**
+ * parse the IDL files on a pool of worker threads
+ *
+ * The files are parsed serially if only one job is requested or the
+ * threads cannot be started.
+ */
+static void webidl_load_run(struct webidl_load_jobs *jobs)
+{
+	pthread_t *threadv = NULL;
+	unsigned int nthreads;
+	unsigned int started = 0;
+
+	nthreads = options->jobs;
+	if (nthreads > jobs->loadc) {
+		nthreads = jobs->loadc;
+	}
+
+	pthread_mutex_init(&jobs->lock, NULL);
+	jobs->next = 0;
+	jobs->context = genb_context;
+
+	if (nthreads > 1) {
+		threadv = calloc(nthreads, sizeof(pthread_t));
+		if (threadv != NULL) {
+			for (started = 0; started < nthreads; started++) {
+				if (pthread_create(threadv + started,
+						   NULL,
+						   webidl_load_worker,
+						   jobs) != 0) {
+					break;
+				}
+			}
+		}
+	}
+
+	if (started == 0) {
+		/* parse serially */
+		webidl_load_worker(jobs);
+	}
+
+	while (started > 0) {
+		started--;
+		pthread_join(threadv[started], NULL);
+	}
+
+	free(threadv);
+	pthread_mutex_destroy(&jobs->lock);
+}
+
+/* exported interface defined in webidl-ast.h */
+int webidl_parsefiles(char **filev,
+		      unsigned int filec,
+		      struct webidl_node **webidl_ast)
+{
+	struct webidl_load_jobs jobs;
+	struct webidl_load *load;
+	unsigned int idx;
+	int ret = 0;
+
+	/* an empty AST starts a new set of definitions, any indexed
+	 * definitions belong to a previously loaded AST
+	 */
+	if (*webidl_ast == NULL) {
+		nameindex_free(genb_context->webidl.index);
+		genb_context->webidl.index = NULL;
+	}
+
+	jobs.loadc = filec;
+	jobs.loadv = calloc(filec + 1, sizeof(struct webidl_load));
+	if (jobs.loadv == NULL) {
+		fprintf(stderr, "Error: Web IDL load allocation failed\n");
+		return -1;
+	}
+
+	/* files are opened in order so inputs are recorded in order */
+	for (idx = 0; idx < filec; idx++) {
+		jobs.loadv[idx].filename = filev[idx];
+		ret = webidl_load_open(jobs.loadv + idx);
+		if (ret != 0) {
+			break;
+		}
+	}
+
+	if (ret == 0) {
+		/* the parser trace flag is shared by every parse */
+		if (options->debug) {
+			webidl_debug = 1;
+		}
+		webidl_load_run(&jobs);
+
+		if (genb_context_failed()) {
+			ret = -1;
+		}
+	}
+
+	/* merge the definitions in order up to the first failure */
+	for (idx = 0; idx < filec; idx++) {
+		load = jobs.loadv + idx;
+
+		if (ret == 0) {
+			genb_diag_flush(&load->diag);
+			ret = load->res;
+
+			if (load->cached && options->verbose) {
+				printf("Loaded cached IDL for %s\n", load->path);
+			}
+
+			if ((ret == 0) &&
+			    (!load->cached) &&
+			    (options->cachedir != NULL)) {
+				/* failing to update the cache only costs time */
+				webidl_cache_save(load->path,
+						  load->input->size,
+						  load->hash,
+						  load->defs);
+			}
+
+			/* the definitions now belong to the shared arena */
+			if (genb_context->webidl.arena == NULL) {
+				genb_context->webidl.arena = load->arena;
+			} else {
+				arena_merge(genb_context->webidl.arena,
+					    load->arena);
+			}
+			genb_context->webidl.nodec += load->nodec;
+
+			webidl_merge_definitions(webidl_ast, load->defs);
+		} else {
+			/* discard files after a failure */
+			free(load->diag.data);
+			arena_free(load->arena);
+		}
+
+		if (load->input != NULL) {
+			genb_unmapfile(load->input);
+		}
+		free(load->path);
+	}
+	free(jobs.loadv);
+
         return ret;
 }
 
@@ -742,8 +1421,8 @@ intercalate_implements(struct webidl_node *interface_node, void *ctx)
 		WEBIDL_NODE_TYPE_INTERFACE_IMPLEMENTS);
 	while (implements_node != NULL) {
 
-		implements_interface_node = webidl_node_find_type_ident(
-			webidl_ast,
+		implements_interface_node = webidl_index_find(
+			genb_context->webidl.index,
 			WEBIDL_NODE_TYPE_INTERFACE,
 			webidl_node_gettext(implements_node));
 
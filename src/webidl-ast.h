@@ -9,6 +9,13 @@
 #ifndef nsgenbind_webidl_ast_h
 #define nsgenbind_webidl_ast_h
 
+#include <stdbool.h>
+#include <stdint.h>
+
+struct arena;
+struct nameindex;
+struct genb_mapped;
+
 enum webidl_node_type {
 	/* generic node types which define structure or attributes */
 	WEBIDL_NODE_TYPE_ROOT = 0,
@@ -92,6 +99,41 @@ typedef int (webidl_callback_t)(struct webidl_node *node, void *ctx);
 
 int webidl_cmp_node_type(struct webidl_node *node, void *ctx);
 
+/**
+ * allocate zeroed memory for the AST
+ *
+ * The memory is released by webidl_ast_free() and may not be freed
+ * individually.
+ *
+ * \return The memory or NULL on allocation failure which is recorded in
+ *         the generator context.
+ */
+void *webidl_alloc(size_t size);
+
+/**
+ * duplicate a string into AST memory
+ */
+char *webidl_strdup(const char *s);
+
+/**
+ * duplicate at most n characters of a string into AST memory
+ */
+char *webidl_strndup(const char *s, size_t n);
+
+/**
+ * release all AST nodes and text
+ */
+void webidl_ast_free(void);
+
+/**
+ * get AST memory statistics
+ *
+ * \param nodec Updated with the number of nodes allocated.
+ * \param used Updated with the number of bytes allocated for the AST.
+ * \param allocated Updated with the number of bytes reserved for the AST.
+ */
+int webidl_ast_stats(unsigned int *nodec, size_t *used, size_t *allocated);
+
 /**
  * create a new node with a pointer value
  */
@@ -102,6 +144,11 @@ struct webidl_node *webidl_node_new(enum webidl_node_type, struct webidl_node *l
  */
 struct webidl_node *webidl_new_number_node(enum webidl_node_type type, struct webidl_node *l, int number);
 
+/**
+ * create a new node with a floating point value
+ */
+struct webidl_node *webidl_new_float_node(enum webidl_node_type type, struct webidl_node *l, float value);
+
 
 struct webidl_node *webidl_node_prepend(struct webidl_node *list, struct webidl_node *node);
 struct webidl_node *webidl_node_append(struct webidl_node *list, struct webidl_node *node);
@@ -116,6 +163,14 @@ float *webidl_node_getfloat(struct webidl_node *node);
 
 enum webidl_node_type webidl_node_gettype(struct webidl_node *node);
 
+/**
+ * get the next sibling of a node
+ *
+ * \param node The node to get the sibling of.
+ * \return The next node in the list or NULL at the end of the list.
+ */
+struct webidl_node *webidl_node_next(struct webidl_node *node);
+
 /* node searches */
 
 /**
@@ -148,12 +203,130 @@ webidl_node_find_type_ident(struct webidl_node *root_node,
 			    enum webidl_node_type type, 
 			    const char *ident);
 
+/**
+ * update a content hash with a node and all its children
+ *
+ * The siblings of the node are not included.
+ *
+ * \param node The node to hash.
+ * \param hash The hash to update.
+ * \return The updated hash.
+ */
+uint64_t webidl_node_hash(struct webidl_node *node, uint64_t hash);
+
+/** number of nodes an iterator holds without allocating */
+#define WEBIDL_NODE_ITER_INLINE 32
+
+/**
+ * cursor over the nodes of a list
+ *
+ * Nodes are returned in the same order as successive calls to
+ * webidl_node_find_type() would return them but the list is only
+ * walked once.
+ */
+struct webidl_node_iter {
+        struct webidl_node **nodev; /**< list nodes in list order */
+        int nodec; /**< number of nodes not yet returned */
+        struct webidl_node *inlinev[WEBIDL_NODE_ITER_INLINE];
+};
+
+/**
+ * initialise a cursor over a list of nodes
+ *
+ * \param it The cursor to initialise.
+ * \param node The first node of the list to iterate.
+ */
+void webidl_node_iter_init(struct webidl_node_iter *it, struct webidl_node *node);
 
+/**
+ * get the next node of a type from a cursor
+ *
+ * \param it The cursor to advance.
+ * \param type The type of node to return.
+ * \return The next node of the given type or NULL when there are no more.
+ */
+struct webidl_node *
+webidl_node_iter_next(struct webidl_node_iter *it, enum webidl_node_type type);
 
 /**
- * parse web idl file into Abstract Syntax Tree
+ * get the next node of any type from a cursor
+ *
+ * \param it The cursor to advance.
+ * \return The next node or NULL when there are no more.
+ */
+struct webidl_node *webidl_node_iter_next_any(struct webidl_node_iter *it);
+
+/**
+ * release resources held by a cursor
+ */
+void webidl_node_iter_fini(struct webidl_node_iter *it);
+
+
+/**
+ * add a top level definition to a definition index
+ *
+ * The definition is indexed by its type and identifier replacing any
+ * previous definition with the same type and identifier.
+ *
+ * \param index The index to add to which is created if NULL.
+ * \param node The definition node.
+ * \return 0 on success else -1 if the node has no identifier or on
+ *         allocation failure.
+ */
+int webidl_index_add(struct nameindex **index, struct webidl_node *node);
+
+/**
+ * find a top level definition from a definition index
+ *
+ * \param index The index to search which may be NULL.
+ * \param type The type of definition.
+ * \param ident The identifier of the definition.
+ * \return The definition node or NULL if not found.
+ */
+struct webidl_node *
+webidl_index_find(struct nameindex *index,
+		  enum webidl_node_type type,
+		  const char *ident);
+
+/**
+ * state of a single Web IDL file parse
+ *
+ * The scanner and parser are reentrant and keep everything they need
+ * here so parses of different files share no lexer or parser state.
+ */
+struct webidl_parse_ctx {
+	struct nameindex *index; /**< definitions parsed from the file */
+	struct genb_mapped *includes; /**< mapped include files, innermost first */
+	char *errtxt; /**< text of the last syntax error */
+	bool failed; /**< an include file could not be read */
+};
+
+/**
+ * Web IDL AST held by a generator context
+ */
+struct webidl_ast_state {
+	struct arena *arena; /**< arena all AST nodes and text are allocated from */
+	unsigned int nodec; /**< number of AST nodes allocated */
+	struct nameindex *index; /**< index of top level definitions by type and name */
+};
+
+/**
+ * parse web idl files into Abstract Syntax Tree
+ *
+ * Each file is parsed on its own, concurrently when several jobs are
+ * requested, and the definitions merged into the AST in the order the
+ * files are given. Partial interfaces and dictionaries extend earlier
+ * definitions exactly as they would if parsed into the AST directly.
+ *
+ * \param filev The names of the files to parse.
+ * \param filec The number of files.
+ * \param webidl_ast The AST to add the definitions to.
+ * \return 0 on success else the error code of the first file which
+ *         failed, the definitions of the files before it are merged.
  */
-int webidl_parsefile(char *filename, struct webidl_node **webidl_ast);
+int webidl_parsefiles(char **filev,
+		      unsigned int filec,
+		      struct webidl_node **webidl_ast);
 
 /**
  * dump AST to file
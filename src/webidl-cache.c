@@ -0,0 +1,494 @@
+/* parsed Web IDL cache implementation
+ *
+ * This file is part of nsgenbind.
+ * Licensed under the MIT License,
+ *                http://www.opensource.org/licenses/mit-license.php
+ * Copyright 2026 agent <agent@local>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "options.h"
+#include "utils.h"
+#include "intern.h"
+#include "webidl-ast.h"
+#include "webidl-cache.h"
+
+/** identifies a cache file */
+#define CACHE_MAGIC "NSGBIDL"
+
+/** cache format version, changed whenever the AST layout changes */
+#define CACHE_VERSION 2
+
+/** text length used to store a NULL text payload */
+#define CACHE_NULL_TEXT UINT32_MAX
+
+/**
+ * kind of payload a cached node carries
+ */
+enum cache_payload {
+        CACHE_PAYLOAD_NONE, /**< no payload */
+        CACHE_PAYLOAD_TEXT, /**< length and characters */
+        CACHE_PAYLOAD_INT, /**< integer */
+        CACHE_PAYLOAD_FLOAT, /**< floating point number */
+        CACHE_PAYLOAD_LIST, /**< list of child nodes */
+};
+
+/**
+ * growable buffer a cache file is built in
+ */
+struct cache_wbuf {
+        char *data;
+        size_t len;
+        size_t alloc;
+        bool err; /**< an allocation failed */
+};
+
+/**
+ * bounds checked reader over a mapped cache file
+ */
+struct cache_rbuf {
+        const char *data;
+        size_t len;
+        size_t pos;
+        bool err; /**< a read went past the end of the data */
+};
+
+/**
+ * get the path of the cache file for an IDL file path
+ *
+ * \return The path which the caller must free or NULL on allocation failure.
+ */
+static char *cache_fpath(const char *path)
+{
+        char *fpath;
+        int fpathl;
+
+        fpathl = strlen(options->cachedir) + 24;
+        fpath = malloc(fpathl);
+        if (fpath != NULL) {
+                snprintf(fpath, fpathl, "%s/%016" PRIx64 ".idlc",
+                         options->cachedir,
+                         genb_hash(GENB_HASH_INIT, path, strlen(path)));
+        }
+        return fpath;
+}
+
+static void cache_write(struct cache_wbuf *wbuf, const void *data, size_t len)
+{
+        char *ndata;
+        size_t nalloc;
+
+        if (wbuf->err) {
+                return;
+        }
+
+        if ((wbuf->len + len) > wbuf->alloc) {
+                nalloc = wbuf->alloc + len + (64 * 1024);
+                ndata = realloc(wbuf->data, nalloc);
+                if (ndata == NULL) {
+                        wbuf->err = true;
+                        return;
+                }
+                wbuf->data = ndata;
+                wbuf->alloc = nalloc;
+        }
+        memcpy(wbuf->data + wbuf->len, data, len);
+        wbuf->len += len;
+}
+
+static void cache_write_u32(struct cache_wbuf *wbuf, uint32_t value)
+{
+        cache_write(wbuf, &value, sizeof(value));
+}
+
+static void cache_write_text(struct cache_wbuf *wbuf, const char *text)
+{
+        uint32_t len;
+
+        if (text == NULL) {
+                cache_write_u32(wbuf, CACHE_NULL_TEXT);
+                return;
+        }
+        len = strlen(text);
+        cache_write_u32(wbuf, len);
+        cache_write(wbuf, text, len);
+}
+
+/**
+ * write a list of nodes
+ *
+ * The nodes are written from the tail of the list so the reader can
+ * rebuild the list by prepending.
+ */
+static void cache_write_list(struct cache_wbuf *wbuf, struct webidl_node *list)
+{
+        struct webidl_node **nodev;
+        struct webidl_node *node;
+        struct webidl_node *child;
+        uint32_t nodec = 0;
+        uint32_t idx;
+        uint8_t payload;
+        char *text;
+        int *number;
+        float *flt;
+
+        for (node = list; node != NULL; node = webidl_node_next(node)) {
+                nodec++;
+        }
+        cache_write_u32(wbuf, nodec);
+        if (nodec == 0) {
+                return;
+        }
+
+        nodev = malloc(nodec * sizeof(struct webidl_node *));
+        if (nodev == NULL) {
+                wbuf->err = true;
+                return;
+        }
+        idx = 0;
+        for (node = list; node != NULL; node = webidl_node_next(node)) {
+                nodev[idx++] = node;
+        }
+
+        while (idx > 0) {
+                node = nodev[--idx];
+
+                cache_write_u32(wbuf, webidl_node_gettype(node));
+
+                text = webidl_node_gettext(node);
+                number = webidl_node_getint(node);
+                flt = webidl_node_getfloat(node);
+                child = webidl_node_getnode(node);
+
+                if (text != NULL) {
+                        payload = CACHE_PAYLOAD_TEXT;
+                        cache_write(wbuf, &payload, sizeof(payload));
+                        cache_write_text(wbuf, text);
+                } else if (number != NULL) {
+                        payload = CACHE_PAYLOAD_INT;
+                        cache_write(wbuf, &payload, sizeof(payload));
+                        cache_write(wbuf, number, sizeof(*number));
+                } else if (flt != NULL) {
+                        payload = CACHE_PAYLOAD_FLOAT;
+                        cache_write(wbuf, &payload, sizeof(payload));
+                        cache_write(wbuf, flt, sizeof(*flt));
+                } else if (child != NULL) {
+                        payload = CACHE_PAYLOAD_LIST;
+                        cache_write(wbuf, &payload, sizeof(payload));
+                        cache_write_list(wbuf, child);
+                } else {
+                        payload = CACHE_PAYLOAD_NONE;
+                        cache_write(wbuf, &payload, sizeof(payload));
+                }
+        }
+
+        free(nodev);
+}
+
+static const void *cache_read(struct cache_rbuf *rbuf, size_t len)
+{
+        const void *res;
+
+        if (rbuf->err || ((rbuf->len - rbuf->pos) < len)) {
+                rbuf->err = true;
+                return NULL;
+        }
+        res = rbuf->data + rbuf->pos;
+        rbuf->pos += len;
+        return res;
+}
+
+static uint32_t cache_read_u32(struct cache_rbuf *rbuf)
+{
+        const void *data;
+        uint32_t value = 0;
+
+        data = cache_read(rbuf, sizeof(value));
+        if (data != NULL) {
+                memcpy(&value, data, sizeof(value));
+        }
+        return value;
+}
+
+static uint64_t cache_read_u64(struct cache_rbuf *rbuf)
+{
+        const void *data;
+        uint64_t value = 0;
+
+        data = cache_read(rbuf, sizeof(value));
+        if (data != NULL) {
+                memcpy(&value, data, sizeof(value));
+        }
+        return value;
+}
+
+/**
+ * read a text payload
+ *
+ * \param rbuf The reader.
+ * \param text_out Updated with the interned text or NULL.
+ * \return 0 on success else -1 if the data is malformed.
+ */
+static int cache_read_text(struct cache_rbuf *rbuf, char **text_out)
+{
+        uint32_t len;
+        const char *data;
+
+        len = cache_read_u32(rbuf);
+        if (rbuf->err) {
+                return -1;
+        }
+        if (len == CACHE_NULL_TEXT) {
+                *text_out = NULL;
+                return 0;
+        }
+
+        data = cache_read(rbuf, len);
+        if (data == NULL) {
+                return -1;
+        }
+        *text_out = intern_nstring(data, len);
+        return 0;
+}
+
+/**
+ * read a list of nodes
+ *
+ * \param rbuf The reader.
+ * \param list_out Updated with the list.
+ * \return 0 on success else -1 if the data is malformed.
+ */
+static int cache_read_list(struct cache_rbuf *rbuf, struct webidl_node **list_out)
+{
+        struct webidl_node *list = NULL;
+        struct webidl_node *child;
+        uint32_t nodec;
+        uint32_t type;
+        const uint8_t *payload;
+        const void *data;
+        char *text;
+        int number;
+        float flt;
+
+        nodec = cache_read_u32(rbuf);
+        while ((nodec > 0) && (!rbuf->err)) {
+                nodec--;
+
+                type = cache_read_u32(rbuf);
+                payload = cache_read(rbuf, sizeof(*payload));
+                if ((payload == NULL) ||
+                    (type > WEBIDL_NODE_TYPE_EXTENDED_ATTRIBUTE)) {
+                        return -1;
+                }
+
+                switch (*payload) {
+                case CACHE_PAYLOAD_NONE:
+                        list = webidl_node_new(type, list, NULL);
+                        break;
+
+                case CACHE_PAYLOAD_TEXT:
+                        if (cache_read_text(rbuf, &text) != 0) {
+                                return -1;
+                        }
+                        list = webidl_node_new(type, list, text);
+                        break;
+
+                case CACHE_PAYLOAD_INT:
+                        data = cache_read(rbuf, sizeof(number));
+                        if (data == NULL) {
+                                return -1;
+                        }
+                        memcpy(&number, data, sizeof(number));
+                        list = webidl_new_number_node(type, list, number);
+                        break;
+
+                case CACHE_PAYLOAD_FLOAT:
+                        data = cache_read(rbuf, sizeof(flt));
+                        if (data == NULL) {
+                                return -1;
+                        }
+                        memcpy(&flt, data, sizeof(flt));
+                        list = webidl_new_float_node(type, list, flt);
+                        break;
+
+                case CACHE_PAYLOAD_LIST:
+                        if (cache_read_list(rbuf, &child) != 0) {
+                                return -1;
+                        }
+                        list = webidl_node_new(type, list, child);
+                        break;
+
+                default:
+                        return -1;
+                }
+        }
+
+        if (rbuf->err) {
+                return -1;
+        }
+
+        *list_out = list;
+        return 0;
+}
+
+/* exported interface documented in webidl-cache.h */
+int
+webidl_cache_load(const char *path,
+                  size_t size,
+                  uint64_t hash,
+                  struct webidl_node **defs_out)
+{
+        char *fpath;
+        int fd;
+        struct stat st;
+        void *map;
+        struct cache_rbuf rbuf;
+        const char *magic;
+        char *cpath;
+        uint64_t generator = GENB_HASH_INIT;
+        int res = -1;
+
+        /* entries stored by a different generator build are not used */
+        if (!genb_hash_generator(&generator)) {
+                return -1;
+        }
+
+        fpath = cache_fpath(path);
+        if (fpath == NULL) {
+                return -1;
+        }
+        fd = open(fpath, O_RDONLY);
+        free(fpath);
+        if (fd == -1) {
+                return -1;
+        }
+
+        if ((fstat(fd, &st) != 0) ||
+            (!S_ISREG(st.st_mode)) ||
+            (st.st_size == 0)) {
+                close(fd);
+                return -1;
+        }
+
+        map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (map == MAP_FAILED) {
+                return -1;
+        }
+
+        rbuf.data = map;
+        rbuf.len = st.st_size;
+        rbuf.pos = 0;
+        rbuf.err = false;
+
+        magic = cache_read(&rbuf, sizeof(CACHE_MAGIC));
+        if ((magic != NULL) &&
+            (memcmp(magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) == 0) &&
+            (cache_read_u32(&rbuf) == CACHE_VERSION) &&
+            (cache_read_u64(&rbuf) == generator) &&
+            (cache_read_u64(&rbuf) == size) &&
+            (cache_read_u64(&rbuf) == hash) &&
+            (cache_read_text(&rbuf, &cpath) == 0) &&
+            (cpath != NULL) &&
+            (strcmp(cpath, path) == 0)) {
+                res = cache_read_list(&rbuf, defs_out);
+        }
+
+        munmap(map, st.st_size);
+
+        return res;
+}
+
+/* exported interface documented in webidl-cache.h */
+int
+webidl_cache_save(const char *path,
+                  size_t size,
+                  uint64_t hash,
+                  struct webidl_node *defs)
+{
+        struct cache_wbuf wbuf = { NULL, 0, 0, false };
+        uint64_t generator = GENB_HASH_INIT;
+        uint64_t value;
+        char *fpath;
+        char *tpath;
+        FILE *cachef;
+        size_t wr;
+        int res = 0;
+
+        if (!genb_hash_generator(&generator)) {
+                return -1;
+        }
+
+        cache_write(&wbuf, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+        cache_write_u32(&wbuf, CACHE_VERSION);
+        cache_write(&wbuf, &generator, sizeof(generator));
+        value = size;
+        cache_write(&wbuf, &value, sizeof(value));
+        cache_write(&wbuf, &hash, sizeof(hash));
+        cache_write_text(&wbuf, path);
+        cache_write_list(&wbuf, defs);
+        if (wbuf.err) {
+                free(wbuf.data);
+                return -1;
+        }
+
+        if ((mkdir(options->cachedir, 0777) != 0) && (errno != EEXIST)) {
+                fprintf(stderr, "Error: unable to create cache %s (%s)\n",
+                        options->cachedir, strerror(errno));
+                free(wbuf.data);
+                return -1;
+        }
+
+        fpath = cache_fpath(path);
+        if (fpath == NULL) {
+                free(wbuf.data);
+                return -1;
+        }
+        tpath = genb_fpath_tmp(fpath);
+        if (tpath == NULL) {
+                free(fpath);
+                free(wbuf.data);
+                return -1;
+        }
+
+        /* write to a temporary file and rename it so readers never
+         * see a partial cache file
+         */
+        cachef = fopen(tpath, "w");
+        if (cachef == NULL) {
+                fprintf(stderr, "Error: unable to open file %s (%s)\n",
+                        tpath, strerror(errno));
+                res = -1;
+        } else {
+                wr = fwrite(wbuf.data, 1, wbuf.len, cachef);
+                if ((fclose(cachef) != 0) || (wr != wbuf.len)) {
+                        fprintf(stderr, "Error: unable to write file %s (%s)\n",
+                                tpath, strerror(errno));
+                        remove(tpath);
+                        res = -1;
+                } else if (rename(tpath, fpath) != 0) {
+                        fprintf(stderr, "Error: unable to rename %s to %s (%s)\n",
+                                tpath, fpath, strerror(errno));
+                        remove(tpath);
+                        res = -1;
+                }
+        }
+
+        free(tpath);
+        free(fpath);
+        free(wbuf.data);
+
+        return res;
+}
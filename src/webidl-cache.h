@@ -0,0 +1,41 @@
+/* parsed Web IDL cache
+ *
+ * This file is part of nsgenbind.
+ * Licensed under the MIT License,
+ *                http://www.opensource.org/licenses/mit-license.php
+ * Copyright 2026 agent <agent@local>
+ */
+
+#ifndef nsgenbind_webidl_cache_h
+#define nsgenbind_webidl_cache_h
+
+#include <stdint.h>
+
+struct webidl_node;
+
+/**
+ * load the definitions parsed from an IDL file from the cache
+ *
+ * The cache entry is only used if it was stored by the same generator
+ * for the same path and the file content has the same size and hash.
+ *
+ * \param path The path the IDL file was opened with.
+ * \param size The size of the IDL file.
+ * \param hash The hash of the IDL file content.
+ * \param defs_out Updated with the cached definitions list.
+ * \return 0 on success else -1 if there is no usable cache entry.
+ */
+int webidl_cache_load(const char *path, size_t size, uint64_t hash, struct webidl_node **defs_out);
+
+/**
+ * store the definitions parsed from an IDL file in the cache
+ *
+ * \param path The path the IDL file was opened with.
+ * \param size The size of the IDL file.
+ * \param hash The hash of the IDL file content.
+ * \param defs The definitions parsed from the file.
+ * \return 0 on success else -1 if the cache could not be written.
+ */
+int webidl_cache_save(const char *path, size_t size, uint64_t hash, struct webidl_node *defs);
+
+#endif
@@ -15,6 +15,7 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
 #include <stdint.h>
@@ -27,29 +28,42 @@
                  (Loc).last_line,  (Loc).last_column)
 
 #include "utils.h"
+#include "webidl-ast.h"
 #include "webidl-parser.h"
 #include "webidl-lexer.h"
 
-#include "webidl-ast.h"
-
-static char *errtxt;
+#include "intern.h"
 
 static void
-webidl_error(YYLTYPE *locp, struct webidl_node **winbind_ast, const char *str)
+webidl_error(YYLTYPE *locp,
+             void *scanner,
+             struct webidl_parse_ctx *ctx,
+             struct webidl_node **winbind_ast,
+             const char *str)
 {
     UNUSED(locp);
+    UNUSED(scanner);
     UNUSED(winbind_ast);
-    errtxt = strdup(str);
+    free(ctx->errtxt);
+    ctx->errtxt = strdup(str);
 }
 
 %}
 
+%code requires {
+/* parse state passed to the parser and scanner */
+struct webidl_parse_ctx;
+}
+
 %locations
  /* bison prior to 2.4 cannot cope with %define api.pure so we use the
   *  deprecated directive 
   */
 %pure-parser
 %error-verbose
+%lex-param { void *scanner }
+%parse-param { void *scanner }
+%parse-param { struct webidl_parse_ctx *ctx }
 %parse-param { struct webidl_node **webidl_ast }
 
 %union
@@ -239,8 +253,9 @@ Definitions:
         |
         error
         {
-            fprintf(stderr, "%d: %s\n", yylloc.first_line, errtxt);
-            free(errtxt);
+            genb_diagf("%d: %s\n", yylloc.first_line, ctx->errtxt);
+            free(ctx->errtxt);
+            ctx->errtxt = NULL;
             YYABORT ;
         }
         ;
@@ -297,9 +312,7 @@ Interface:
                 members = webidl_node_new(WEBIDL_NODE_TYPE_LIST, members, $5);
 
 
-                interface_node = webidl_node_find_type_ident(*webidl_ast,
-                                                     WEBIDL_NODE_TYPE_INTERFACE,
-                                                             $2);
+                interface_node = webidl_index_find(ctx->index, WEBIDL_NODE_TYPE_INTERFACE, $2);
 
                 if (interface_node == NULL) {
                         /* no existing interface - create one with ident */
@@ -310,6 +323,7 @@ Interface:
                         $$ = webidl_node_new(WEBIDL_NODE_TYPE_INTERFACE,
                                              NULL,
                                              members);
+                        webidl_index_add(&ctx->index, $$);
                 } else {
                         /* update the existing interface */
 
@@ -344,9 +358,7 @@ PartialInterface:
             struct webidl_node *members;
             struct webidl_node *interface_node;
 
-            interface_node = webidl_node_find_type_ident(*webidl_ast,
-                                                     WEBIDL_NODE_TYPE_INTERFACE,
-                                                     $2);
+            interface_node = webidl_index_find(ctx->index, WEBIDL_NODE_TYPE_INTERFACE, $2);
 
             members = webidl_node_new(WEBIDL_NODE_TYPE_LIST, NULL, $4);
 
@@ -356,6 +368,7 @@ PartialInterface:
                 members = webidl_node_new(WEBIDL_NODE_TYPE_IDENT, members, $2);
 
                 $$ = webidl_node_new(WEBIDL_NODE_TYPE_INTERFACE, NULL, members);
+                webidl_index_add(&ctx->index, $$);
             } else {
                 /* update the existing interface */
 
@@ -450,10 +463,7 @@ Dictionary:
 
                 members = webidl_node_new(WEBIDL_NODE_TYPE_LIST, members, $5);
 
-                dictionary_node = webidl_node_find_type_ident(
-                                         *webidl_ast,
-                                         WEBIDL_NODE_TYPE_DICTIONARY,
-                                         $2);
+                dictionary_node = webidl_index_find(ctx->index, WEBIDL_NODE_TYPE_DICTIONARY, $2);
 
                 if (dictionary_node == NULL) {
                         /* no existing interface - create one with ident */
@@ -464,6 +474,7 @@ Dictionary:
                         $$ = webidl_node_new(WEBIDL_NODE_TYPE_DICTIONARY,
                                              NULL,
                                              members);
+                        webidl_index_add(&ctx->index, $$);
                 } else {
                         /* update the existing interface */
 
@@ -539,10 +550,7 @@ PartialDictionary:
                 struct webidl_node *members;
                 struct webidl_node *dictionary_node;
 
-                dictionary_node = webidl_node_find_type_ident(
-                                         *webidl_ast,
-                                         WEBIDL_NODE_TYPE_DICTIONARY,
-                                         $2);
+                dictionary_node = webidl_index_find(ctx->index, WEBIDL_NODE_TYPE_DICTIONARY, $2);
 
                 members = webidl_node_new(WEBIDL_NODE_TYPE_LIST, NULL, $4);
 
@@ -556,6 +564,7 @@ PartialDictionary:
                         $$ = webidl_node_new(WEBIDL_NODE_TYPE_DICTIONARY,
                                              NULL,
                                              members);
+                        webidl_index_add(&ctx->index, $$);
                 } else {
                         /* update the existing dictionary */
 
@@ -674,9 +683,7 @@ ImplementsStatement:
             struct webidl_node *interface_node;
 
 
-            interface_node = webidl_node_find_type_ident(*webidl_ast,
-                                                     WEBIDL_NODE_TYPE_INTERFACE,
-                                                     $1);
+            interface_node = webidl_index_find(ctx->index, WEBIDL_NODE_TYPE_INTERFACE, $1);
 
             implements = webidl_node_new(WEBIDL_NODE_TYPE_INTERFACE_IMPLEMENTS, NULL, $3);
 
@@ -686,6 +693,7 @@ ImplementsStatement:
                 implements = webidl_node_new(WEBIDL_NODE_TYPE_IDENT, implements, $1);
 
                 $$ = webidl_node_new(WEBIDL_NODE_TYPE_INTERFACE, NULL, implements);
+                webidl_index_add(&ctx->index, $$);
             } else {
                 /* update the existing interface */
 
@@ -755,42 +763,31 @@ BooleanLiteral:
 FloatLiteral:
         TOK_FLOAT_LITERAL
         {
-                float *value;
-                value = malloc(sizeof(float));
-                *value = strtof($1, NULL);
-                $$ = webidl_node_new(WEBIDL_NODE_TYPE_LITERAL_FLOAT,
-                                     NULL,
-                                     value);
+                /* the text is NULL if interning it failed */
+                $$ = webidl_new_float_node(WEBIDL_NODE_TYPE_LITERAL_FLOAT,
+                                           NULL,
+                                           ($1 == NULL) ? 0 : strtof($1, NULL));
         }
         |
         '-' TOK_INFINITY
         {
-                float *value;
-                value = malloc(sizeof(float));
-                *value = -INFINITY;
-                $$ = webidl_node_new(WEBIDL_NODE_TYPE_LITERAL_FLOAT,
-                                     NULL,
-                                     value);
+                $$ = webidl_new_float_node(WEBIDL_NODE_TYPE_LITERAL_FLOAT,
+                                           NULL,
+                                           -INFINITY);
         }
         |
         TOK_INFINITY
         {
-                float *value;
-                value = malloc(sizeof(float));
-                *value = INFINITY;
-                $$ = webidl_node_new(WEBIDL_NODE_TYPE_LITERAL_FLOAT,
-                                     NULL,
-                                     value);
+                $$ = webidl_new_float_node(WEBIDL_NODE_TYPE_LITERAL_FLOAT,
+                                           NULL,
+                                           INFINITY);
         }
         |
         TOK_NAN
         {
-                float *value;
-                value = malloc(sizeof(float));
-                *value = NAN;
-                $$ = webidl_node_new(WEBIDL_NODE_TYPE_LITERAL_FLOAT,
-                                     NULL,
-                                     value);
+                $$ = webidl_new_float_node(WEBIDL_NODE_TYPE_LITERAL_FLOAT,
+                                           NULL,
+                                           NAN);
         }
         ;
 
@@ -925,7 +922,7 @@ AttributeName:
 AttributeNameKeyword:
         TOK_REQUIRED
         {
-                $$ = strdup("required");
+                $$ = intern_string("required");
         }
 
 /* [33]
@@ -1242,7 +1239,7 @@ ExtendedAttribute:
                 /* Constructor */
                 $$ = webidl_node_new(WEBIDL_NODE_TYPE_IDENT,
                                      NULL,
-                                     strdup("Constructor"));
+                                     intern_string("Constructor"));
         }
         |
         TOK_CONSTRUCTOR '(' ArgumentList ')'
@@ -1251,7 +1248,7 @@ ExtendedAttribute:
                 $$ = webidl_node_new(WEBIDL_NODE_TYPE_OPERATION,
                                      webidl_node_new(WEBIDL_NODE_TYPE_IDENT,
                                                      NULL,
-                                                     strdup("Constructor")),
+                                                     intern_string("Constructor")),
                                      webidl_node_new(WEBIDL_NODE_TYPE_LIST,
                                                      NULL,
                                                      $3));
@@ -1263,7 +1260,7 @@ ExtendedAttribute:
                 $$ = webidl_node_new(WEBIDL_NODE_TYPE_OPERATION,
                                      webidl_node_new(WEBIDL_NODE_TYPE_IDENT,
                                                      NULL,
-                                                     strdup("NamedConstructor")),
+                                                     intern_string("NamedConstructor")),
                                      webidl_node_new(WEBIDL_NODE_TYPE_LIST,
                                                      webidl_node_new(WEBIDL_NODE_TYPE_IDENT,
                                                                      NULL,
@@ -1343,8 +1340,10 @@ Other:
         TOK_INT_LITERAL
         {
                 /* @todo loosing base info here might break the attribute */
-                $$ = calloc(1, 32);
-                snprintf($$, 32, "%ld", $1);
+                char intstr[32];
+
+                snprintf(intstr, sizeof(intstr), "%ld", $1);
+                $$ = intern_string(intstr);
         }
         |
         TOK_FLOAT_LITERAL
@@ -1369,152 +1368,152 @@ Other:
         |
         '-'
         {
-                $$ = strdup("-");
+                $$ = intern_string("-");
         }
         |
         '.'
         {
-                $$ = strdup(".");
+                $$ = intern_string(".");
         }
         |
         TOK_ELLIPSIS
         {
-                $$ = strdup("...");
+                $$ = intern_string("...");
         }
         |
         ':'
         {
-                $$ = strdup(":");
+                $$ = intern_string(":");
         }
         |
         ';'
         {
-                $$ = strdup(";");
+                $$ = intern_string(";");
         }
         |
         '<'
         {
-                $$ = strdup("<");
+                $$ = intern_string("<");
         }
         |
         '='
         {
-                $$ = strdup("=");
+                $$ = intern_string("=");
         }
         |
         '>'
         {
-                $$ = strdup(">");
+                $$ = intern_string(">");
         }
         |
         '?'
         {
-                $$ = strdup("?");
+                $$ = intern_string("?");
         }
         |
         TOK_DATE
         {
-                $$ = strdup("Date");
+                $$ = intern_string("Date");
         }
         |
         TOK_STRING
         {
-                $$ = strdup("DOMString");
+                $$ = intern_string("DOMString");
         }
         |
         TOK_INFINITY
         {
-                $$ = strdup("Infinity");
+                $$ = intern_string("Infinity");
         }
         |
         TOK_NAN
         {
-                $$ = strdup("NaN");
+                $$ = intern_string("NaN");
         }
         |
         TOK_ANY
         {
-                $$ = strdup("any");
+                $$ = intern_string("any");
         }
         |
         TOK_BOOLEAN
         {
-                $$ = strdup("boolean");
+                $$ = intern_string("boolean");
         }
         |
         TOK_BYTE
         {
-                $$ = strdup("byte");
+                $$ = intern_string("byte");
         }
         |
         TOK_DOUBLE
         {
-                $$ = strdup("double");
+                $$ = intern_string("double");
         }
         |
         TOK_FALSE
         {
-                $$ = strdup("false");
+                $$ = intern_string("false");
         }
         |
         TOK_FLOAT
         {
-            $$ = strdup("float");
+            $$ = intern_string("float");
         }
         |
         TOK_LONG
         {
-            $$ = strdup("long");
+            $$ = intern_string("long");
         }
         |
         TOK_NULL_LITERAL
         {
-            $$ = strdup("null");
+            $$ = intern_string("null");
         }
         |
         TOK_OBJECT
         {
-            $$ = strdup("object");
+            $$ = intern_string("object");
         }
         |
         TOK_OCTET
         {
-            $$ = strdup("octet");
+            $$ = intern_string("octet");
         }
         |
         TOK_OR
         {
-            $$ = strdup("or");
+            $$ = intern_string("or");
         }
         |
         TOK_OPTIONAL
         {
-            $$ = strdup("optional");
+            $$ = intern_string("optional");
         }
         |
         TOK_SEQUENCE
         {
-            $$ = strdup("sequence");
+            $$ = intern_string("sequence");
         }
         |
         TOK_SHORT
         {
-            $$ = strdup("short");
+            $$ = intern_string("short");
         }
         |
         TOK_TRUE
         {
-            $$ = strdup("true");
+            $$ = intern_string("true");
         }
         |
         TOK_UNSIGNED
         {
-            $$ = strdup("unsigned");
+            $$ = intern_string("unsigned");
         }
         |
         TOK_VOID
         {
-            $$ = strdup("void");
+            $$ = intern_string("void");
         }
         |
         ArgumentNameKeyword
@@ -1529,112 +1528,112 @@ Other:
 ArgumentNameKeyword:
         TOK_ATTRIBUTE
         {
-            $$ = strdup("attribute");
+            $$ = intern_string("attribute");
         }
         |
         TOK_CALLBACK
         {
-            $$ = strdup("callback");
+            $$ = intern_string("callback");
         }
         |
         TOK_CONST
         {
-            $$ = strdup("const");
+            $$ = intern_string("const");
         }
         |
         TOK_CREATOR
         {
-            $$ = strdup("creator");
+            $$ = intern_string("creator");
         }
         |
         TOK_DELETER
         {
-            $$ = strdup("deleter");
+            $$ = intern_string("deleter");
         }
         |
         TOK_DICTIONARY
         {
-            $$ = strdup("dictionary");
+            $$ = intern_string("dictionary");
         }
         |
         TOK_ENUM
         {
-            $$ = strdup("enum");
+            $$ = intern_string("enum");
         }
         |
         TOK_EXCEPTION
         {
-            $$ = strdup("exception");
+            $$ = intern_string("exception");
         }
         |
         TOK_GETTER
         {
-            $$ = strdup("getter");
+            $$ = intern_string("getter");
         }
         |
         TOK_IMPLEMENTS
         {
-            $$ = strdup("implements");
+            $$ = intern_string("implements");
         }
         |
         TOK_INHERIT
         {
-            $$ = strdup("inherit");
+            $$ = intern_string("inherit");
         }
         |
         TOK_INTERFACE
         {
-            $$ = strdup("interface");
+            $$ = intern_string("interface");
         }
         |
         TOK_ITERABLE
         {
-            $$ = strdup("iterable");
+            $$ = intern_string("iterable");
         }
         |
         TOK_LEGACYCALLER
         {
-            $$ = strdup("legacycaller");
+            $$ = intern_string("legacycaller");
         }
         |
         TOK_LEGACYITERABLE
         {
-            $$ = strdup("legacyiterable");
+            $$ = intern_string("legacyiterable");
         }
         |
         TOK_PARTIAL
         {
-            $$ = strdup("partial");
+            $$ = intern_string("partial");
         }
         |
         TOK_REQUIRED
         {
-            $$ = strdup("required");
+            $$ = intern_string("required");
         }
         |
         TOK_SETTER
         {
-            $$ = strdup("setter");
+            $$ = intern_string("setter");
         }
         |
         TOK_STATIC
         {
-            $$ = strdup("static");
+            $$ = intern_string("static");
         }
         |
         TOK_STRINGIFIER
         {
-            $$ = strdup("stringifier");
+            $$ = intern_string("stringifier");
         }
         |
         TOK_TYPEDEF
         {
-            $$ = strdup("typedef");
+            $$ = intern_string("typedef");
         }
         |
         TOK_UNRESTRICTED
         {
-            $$ = strdup("unrestricted");
+            $$ = intern_string("unrestricted");
         }
         ;
 
@@ -1647,7 +1646,7 @@ OtherOrComma:
         |
         ','
         {
-            $$ = strdup(",");
+            $$ = intern_string(",");
         }
         ;
 
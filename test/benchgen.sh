@@ -0,0 +1,109 @@
+#!/bin/sh
+#
+# generate a synthetic Web IDL and binding set for benchmarking
+#
+# usage: benchgen.sh scale outdir
+#
+# scale is the number of interfaces generated. The set contains:
+#  - interfaces in inheritance chains of BENCH_DEPTH (default 64)
+#  - one mixin for every ten interfaces, every interface implements
+#    two of them and one interface implements every mixin
+#  - a partial interface adding a member to every interface
+#  - one dictionary for every ten interfaces in inheritance chains
+#  - a binding class for every other interface with methods, getters
+#    and setters and a cdata block of BENCH_CDATA_KB (default 256) KiB
+
+SCALE=$1
+OUTDIR=$2
+
+DEPTH=${BENCH_DEPTH:-64}
+CDATA_KB=${BENCH_CDATA_KB:-256}
+
+if [ -z "${SCALE}" -o -z "${OUTDIR}" ]; then
+  echo "usage: $0 scale outdir" >&2
+  exit 1
+fi
+
+mkdir -p ${OUTDIR}/idl
+
+awk -v scale=${SCALE} -v depth=${DEPTH} -v outdir=${OUTDIR} '
+BEGIN {
+  idl = outdir "/idl/bench.idl"
+  partial = outdir "/idl/bench-partial.idl"
+  mixinc = int(scale / 10)
+  if (mixinc < 1) mixinc = 1
+
+  for (m = 0; m < mixinc; m++) {
+    printf("[NoInterfaceObject]\ninterface BenchMixin%d {\n", m) > idl
+    for (a = 0; a < 4; a++) {
+      printf("  attribute DOMString mixin%dAttr%d;\n", m, a) > idl
+    }
+    printf("  void mixin%dOp(long value, optional DOMString name);\n};\n\n", m) > idl
+  }
+
+  for (i = 0; i < scale; i++) {
+    if ((i % depth) == 0) {
+      printf("interface Bench%d {\n", i) > idl
+    } else {
+      printf("interface Bench%d : Bench%d {\n", i, i - 1) > idl
+    }
+    printf("  const unsigned short BENCH%d_CONST = %d;\n", i, i % 65536) > idl
+    printf("  attribute long bench%dValue;\n", i) > idl
+    printf("  readonly attribute DOMString bench%dName;\n", i) > idl
+    printf("  attribute Bench%d? bench%dNext;\n", i, i) > idl
+    printf("  void bench%dOp(long a);\n", i) > idl
+    printf("  void bench%dOp(DOMString a, optional long b);\n", i) > idl
+    printf("  DOMString bench%dQuery(DOMString key, long... rest);\n", i) > idl
+    printf("};\n\n") > idl
+
+    printf("Bench%d implements BenchMixin%d;\n", i, i % mixinc) > idl
+    printf("Bench%d implements BenchMixin%d;\n\n", i, (i * 7 + 3) % mixinc) > idl
+
+    printf("partial interface Bench%d {\n", i) > partial
+    printf("  attribute boolean bench%dPartial;\n};\n\n", i) > partial
+  }
+
+  printf("interface BenchWide {\n  attribute long wide;\n};\n\n") > idl
+  for (m = 0; m < mixinc; m++) {
+    printf("BenchWide implements BenchMixin%d;\n", m) > idl
+  }
+  printf("\n") > idl
+
+  for (d = 0; d < mixinc; d++) {
+    if ((d % depth) == 0) {
+      printf("dictionary BenchInit%d {\n", d) > idl
+    } else {
+      printf("dictionary BenchInit%d : BenchInit%d {\n", d, d - 1) > idl
+    }
+    printf("  long init%dValue = %d;\n", d, d) > idl
+    printf("  DOMString init%dName;\n", d) > idl
+    printf("  boolean init%dFlag = false;\n};\n\n", d) > idl
+  }
+}'
+
+awk -v scale=${SCALE} -v cdatakb=${CDATA_KB} '
+BEGIN {
+  printf("/* synthetic benchmark binding */\n\n")
+  printf("binding duk_libdom {\n")
+  printf("\twebidl \"bench.idl\";\n")
+  printf("\twebidl \"bench-partial.idl\";\n\n")
+  printf("\tpreface %%{\n/* benchmark preface */\n%%};\n")
+  printf("\tprologue %%{\n/* benchmark prologue */\n%%};\n")
+  printf("};\n\n")
+
+  for (i = 0; i < scale; i += 2) {
+    printf("class Bench%d {\n\tprivate int value%d;\n};\n\n", i, i)
+    printf("method Bench%d::bench%dOp()\n%%{\n\treturn 0;\n%%}\n\n", i, i)
+    printf("getter Bench%d::bench%dValue()\n%%{\n", i, i)
+    printf("\tduk_push_int(ctx, priv->value%d);\n\treturn 1;\n%%}\n\n", i)
+    printf("setter Bench%d::bench%dValue()\n%%{\n", i, i)
+    printf("\tpriv->value%d = duk_to_int(ctx, 0);\n\treturn 0;\n%%}\n\n", i)
+  }
+
+  printf("class BenchWide {\n\tprologue %%{\n/* large cdata start */\n")
+  lines = cdatakb * 16
+  for (l = 0; l < lines; l++) {
+    printf("static const int bench_cdata_%06d = %d; /* padding */\n", l, l)
+  }
+  printf("/* large cdata end */\n%%};\n};\n")
+}' > ${OUTDIR}/bench.bnd
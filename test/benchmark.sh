@@ -0,0 +1,108 @@
+#!/bin/sh
+#
+# benchmark nsgenbind on synthetic IDL sets and compare with a baseline
+#
+# usage: benchmark.sh builddir testsrcdir
+#
+# environment:
+#  BENCH_SCALES        interface counts to run (default "250 1000 4000")
+#  BENCH_TOLERANCE     allowed slowdown factor against baseline (default 3)
+#  BENCH_RSS_TOLERANCE allowed peak memory factor (default 1.5)
+#  BENCH_SCALING       allowed growth in time per interface from the
+#                      smallest to the largest scale (default 3)
+#  BENCH_UPDATE        when set the baseline is replaced by the results
+
+BUILDDIR=$1
+TESTSRCDIR=$2
+
+SCALES=${BENCH_SCALES:-"250 1000 4000"}
+TOLERANCE=${BENCH_TOLERANCE:-3}
+RSS_TOLERANCE=${BENCH_RSS_TOLERANCE:-1.5}
+SCALING=${BENCH_SCALING:-3}
+
+# genbind tool
+NSGENBIND=${BUILDDIR}/nsgenbind
+
+BASELINE=${TESTSRCDIR}/data/benchmark/baseline
+
+# benchmark output
+BENCHOUTDIR=${BUILDDIR}/test/benchmark
+RESULTS=${BENCHOUTDIR}/results
+
+mkdir -p ${BENCHOUTDIR}
+
+echo "# scale wall_seconds cpu_seconds interfaces_per_second peak_rss_kb" >${RESULTS}
+
+RESULT=0
+
+for SCALE in ${SCALES}; do
+  SETDIR=${BENCHOUTDIR}/${SCALE}
+
+  echo -n "    BENCH: ${SCALE} interfaces......"
+
+  rm -rf ${SETDIR}
+  sh ${TESTSRCDIR}/benchgen.sh ${SCALE} ${SETDIR}
+  mkdir -p ${SETDIR}/out
+
+  # output is always generated from scratch so nothing is skipped
+  if ! ${NSGENBIND} --stats=${SETDIR}/stats.json -I ${SETDIR}/idl ${SETDIR}/bench.bnd ${SETDIR}/out >${SETDIR}/testres 2>${SETDIR}/testerr; then
+    echo "FAIL"
+    cat ${SETDIR}/testerr
+    RESULT=1
+    continue
+  fi
+
+  awk -v scale=${SCALE} '
+    /"name": "total"/ {
+      gsub(/[",{}]/, "")
+      for (f = 1; f < NF; f++) {
+        if ($f == "wall:") wall = $(f + 1)
+        if ($f == "cpu:") cpu = $(f + 1)
+      }
+    }
+    /"peak_rss_kb"/ { gsub(/[,]/, ""); rss = $2 }
+    END {
+      if (wall <= 0) wall = 0.000001
+      printf("%d %.6f %.6f %.0f %d\n", scale, wall, cpu, scale / wall, rss)
+    }' ${SETDIR}/stats.json >>${RESULTS}
+
+  tail -n 1 ${RESULTS} | awk '{ printf("%.3fs %.0f interfaces/s %dKiB\n", $2, $4, $5) }'
+done
+
+if [ ${RESULT} -ne 0 ]; then
+  exit ${RESULT}
+fi
+
+if [ -n "${BENCH_UPDATE}" ]; then
+  cp ${RESULTS} ${BASELINE}
+  echo "    BENCH: baseline updated"
+  exit 0
+fi
+
+# compare with baseline and check time grows linearly with scale
+awk -v tolerance=${TOLERANCE} -v rsstolerance=${RSS_TOLERANCE} -v scaling=${SCALING} '
+  /^#/ { next }
+  FNR == NR { basewall[$1] = $2; baserss[$1] = $5; next }
+  {
+    if (($1 in basewall) && ($2 > (basewall[$1] * tolerance))) {
+      printf("    BENCH: %d interfaces took %.3fs against baseline %.3fs\n", $1, $2, basewall[$1])
+      fail = 1
+    }
+    if (($1 in baserss) && ($5 > (baserss[$1] * rsstolerance))) {
+      printf("    BENCH: %d interfaces used %dKiB against baseline %dKiB\n", $1, $5, baserss[$1])
+      fail = 1
+    }
+    if ((minscale == 0) || ($1 < minscale)) { minscale = $1; minper = $2 / $1 }
+    if ($1 > maxscale) { maxscale = $1; maxper = $2 / $1 }
+  }
+  END {
+    if ((maxscale > minscale) && (maxper > (minper * scaling))) {
+      printf("    BENCH: time per interface grew %.1f times from %d to %d interfaces\n", maxper / minper, minscale, maxscale)
+      fail = 1
+    }
+    if (fail) {
+      print "    BENCH: FAIL"
+      exit 1
+    }
+    print "    BENCH: PASS"
+  }' ${BASELINE} ${RESULTS}
@@ -0,0 +1,180 @@
+/* private pointer retrieval microbenchmark
+ *
+ * This file is part of nsgenbind.
+ * Licensed under the MIT License,
+ *                http://www.opensource.org/licenses/mit-license.php
+ * Copyright 2026 agent <agent@local>
+ *
+ * Measures the javascript property access throughput of getters which
+ * fetch their private pointer the way generated bindings do. The string
+ * keyed access is generated by default and the literal keyed access with
+ * the --private-literal option.
+ *
+ * The getters are hand written copies of the private pointer access
+ * the generator emits, not generated code, and the key is a copy of
+ * the generated magic string. They must be kept in step with the
+ * generator.
+ *
+ * usage: privbench [iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <duktape.h>
+
+#define PRIVATE_MAGIC ("\xFF\xFFNETSURF_DUKTAPE_" "PRIVATE")
+
+/** private key as referenced by default generated bindings */
+static const char *magic_string_private = "\xFF\xFFNETSURF_DUKTAPE_PRIVATE";
+
+typedef struct {
+        int value;
+} bench_private_t;
+
+/**
+ * getter fetching the private pointer by string key
+ */
+static duk_ret_t bench_string_getter(duk_context *ctx)
+{
+        bench_private_t *priv;
+
+        duk_push_this(ctx);
+        duk_get_prop_string(ctx, -1, magic_string_private);
+        priv = duk_get_pointer(ctx, -1);
+        duk_pop_2(ctx);
+        if (priv == NULL) {
+                return 0;
+        }
+        duk_push_int(ctx, priv->value);
+        return 1;
+}
+
+/**
+ * getter fetching the private pointer by literal key
+ */
+static duk_ret_t bench_literal_getter(duk_context *ctx)
+{
+        bench_private_t *priv;
+
+        duk_push_this(ctx);
+        duk_get_prop_literal(ctx, -1, PRIVATE_MAGIC);
+        priv = duk_get_pointer(ctx, -1);
+        duk_pop_2(ctx);
+        if (priv == NULL) {
+                return 0;
+        }
+        duk_push_int(ctx, priv->value);
+        return 1;
+}
+
+static void
+define_getter(duk_context *ctx, const char *name, duk_c_function getter)
+{
+        duk_push_string(ctx, name);
+        duk_push_c_function(ctx, getter, 0);
+        duk_def_prop(ctx, -3, DUK_DEFPROP_HAVE_GETTER |
+                     DUK_DEFPROP_HAVE_ENUMERABLE | DUK_DEFPROP_ENUMERABLE |
+                     DUK_DEFPROP_HAVE_CONFIGURABLE);
+}
+
+static double elapsed(const struct timespec *start)
+{
+        struct timespec end;
+
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        return (end.tv_sec - start->tv_sec) +
+                ((end.tv_nsec - start->tv_nsec) / 1e9);
+}
+
+/**
+ * time a loop reading one property of the benchmark object
+ *
+ * \return The seconds taken or a negative value on error.
+ */
+static double
+time_property(duk_context *ctx, const char *property, long iterations)
+{
+        struct timespec start;
+        double secs;
+
+        duk_push_sprintf(ctx,
+                         "(function () {"
+                         " var s = 0;"
+                         " for (var i = 0; i < %ld; i++) { s += bench.%s; }"
+                         " return s; })()",
+                         iterations, property);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        if (duk_peval(ctx) != 0) {
+                fprintf(stderr, "Error: %s\n", duk_safe_to_string(ctx, -1));
+                duk_pop(ctx);
+                return -1;
+        }
+        secs = elapsed(&start);
+
+        if (duk_get_number(ctx, -1) != (double)iterations) {
+                fprintf(stderr, "Error: %s returned wrong value\n", property);
+                secs = -1;
+        }
+        duk_pop(ctx);
+
+        return secs;
+}
+
+int main(int argc, char **argv)
+{
+        duk_context *ctx;
+        bench_private_t priv = { 1 };
+        long iterations = 10000000;
+        double plain;
+        double string;
+        double literal;
+
+        if (argc > 1) {
+                iterations = strtol(argv[1], NULL, 10);
+        }
+
+        ctx = duk_create_heap_default();
+        if (ctx == NULL) {
+                fprintf(stderr, "Error: unable to create heap\n");
+                return EXIT_FAILURE;
+        }
+
+        /* prototype with the accessors */
+        duk_push_object(ctx);
+        define_getter(ctx, "viaString", bench_string_getter);
+        define_getter(ctx, "viaLiteral", bench_literal_getter);
+
+        /* instance with private data and a plain value for reference */
+        duk_push_object(ctx);
+        duk_dup(ctx, -2);
+        duk_set_prototype(ctx, -2);
+        duk_push_pointer(ctx, &priv);
+        duk_put_prop_string(ctx, -2, magic_string_private);
+        duk_push_int(ctx, 1);
+        duk_put_prop_string(ctx, -2, "plain");
+        duk_put_global_string(ctx, "bench");
+        duk_pop(ctx);
+
+        plain = time_property(ctx, "plain", iterations);
+        string = time_property(ctx, "viaString", iterations);
+        literal = time_property(ctx, "viaLiteral", iterations);
+
+        duk_destroy_heap(ctx);
+
+        if ((plain < 0) || (string < 0) || (literal < 0)) {
+                return EXIT_FAILURE;
+        }
+
+        printf("# access seconds accesses_per_second\n");
+        printf("plain %.3f %.0f\n", plain, iterations / plain);
+        printf("string %.3f %.0f\n", string, iterations / string);
+        printf("literal %.3f %.0f\n", literal, iterations / literal);
+        printf("# literal keyed getters are %.2fx the string keyed rate\n",
+               string / literal);
+
+        return EXIT_SUCCESS;
+}
@@ -28,11 +28,20 @@ mkdir -p ${TESTOUTDIR}
 
 echo "$*" >${LOGFILE}
 
-for TEST in ${BINDINGTESTS};do
+# run the generator on a binding and check its output
+#
+# $1 binding file
+# $2 test name used for the output directory and report
+# $3 file listing output files and text they must contain
+# $4 extra generator options
+run_binding() {
+  TEST=$1
+  TESTNAME=$2
+  EXPECTFILE=$3
+  FLAGS=$4
 
   outline
 
-  TESTNAME=$(basename ${TEST} .bnd)
   TESTDIR=${TESTOUTDIR}/${TESTNAME}
 
   echo -n "    TEST: ${TESTNAME}......"
@@ -44,12 +53,42 @@ for TEST in ${BINDINGTESTS};do
   # per test errors
   ERRFILE=${TESTDIR}/testerr
 
-  echo  ${NSGENBIND} -v -D -g -I ${IDLDIR} ${TEST} ${TESTOUTDIR}/${TESTNAME} >>${LOGFILE} 2>&1
+  echo  ${NSGENBIND} -v -D -g --write-ir ${FLAGS} -I ${IDLDIR} ${TEST} ${TESTDIR} >>${LOGFILE} 2>&1
 
-  ${NSGENBIND} -v -D -g -I ${IDLDIR} ${TEST} ${TESTOUTDIR}/${TESTNAME} >${RESFILE} 2>${ERRFILE}
+  ${NSGENBIND} -v -D -g --write-ir ${FLAGS} -I ${IDLDIR} ${TEST} ${TESTDIR} >${RESFILE} 2>${ERRFILE}
 
   RESULT=$?
 
+  # check generated output contains expected text
+  if [ ${RESULT} -eq 0 -a -f ${EXPECTFILE} ]; then
+    while read EXPECTOUT EXPECTTEXT; do
+      if ! grep -q "${EXPECTTEXT}" ${TESTDIR}/${EXPECTOUT}; then
+        echo "${EXPECTOUT} does not contain \"${EXPECTTEXT}\"" >>${ERRFILE}
+        RESULT=1
+      fi
+    done < ${EXPECTFILE}
+  fi
+
+  # output generated from the saved intermediate representation must match
+  IRFILE=${TESTDIR}/nsgenbind.ir
+  if [ ${RESULT} -eq 0 -a -f ${IRFILE} ]; then
+    IROUTDIR=${TESTDIR}/ir
+    mkdir -p ${IROUTDIR}
+    if ! ${NSGENBIND} -g --read-ir ${FLAGS} ${IRFILE} ${IROUTDIR} >>${RESFILE} 2>>${ERRFILE}; then
+      RESULT=1
+    else
+      for IROUT in $(ls ${IROUTDIR}); do
+        if [ ${IROUT} = nsgenbind-manifest ]; then
+          continue
+        fi
+        if ! sed "s#${IROUTDIR}#${TESTDIR}#g" ${IROUTDIR}/${IROUT} | cmp -s - ${TESTDIR}/${IROUT}; then
+          echo "${IROUT} differs when generated from ${IRFILE}" >>${ERRFILE}
+          RESULT=1
+        fi
+      done
+    fi
+  fi
+
   echo >> ${LOGFILE}
   cat ${ERRFILE} >> ${LOGFILE}
   echo >> ${LOGFILE}
@@ -60,7 +99,21 @@ for TEST in ${BINDINGTESTS};do
   else
     echo "FAIL"
   fi
-  
+}
 
-done
+for BINDING in ${BINDINGTESTS};do
 
+  BINDINGNAME=$(basename ${BINDING} .bnd)
+
+  run_binding ${BINDING} ${BINDINGNAME} ${BINDINGDIR}/${BINDINGNAME}.expect ""
+
+  # bindings are also generated with the option following the test
+  # name of each expect file named <test>--<option>.expect
+  for FLAGEXPECT in $(ls ${BINDINGDIR}/${BINDINGNAME}--*.expect 2>/dev/null); do
+    FLAGTESTNAME=$(basename ${FLAGEXPECT} .expect)
+    FLAG=${FLAGTESTNAME#${BINDINGNAME}}
+
+    run_binding ${BINDING} ${FLAGTESTNAME} ${FLAGEXPECT} ${FLAG}
+  done
+
+done